@@ -5,8 +5,18 @@
 #include "likely/FunctionMinimum.h"
 #include "likely/EngineRegistry.h"
 
+#include "boost/bind.hpp"
+
 namespace local = likely;
 
+namespace likely {
+namespace absengine {
+    // Calculates a gradient using a fused evaluator and ignores the function value.
+    void calculateGradient(FunctionAndGradientPtr fg, Parameters const &pValues, Gradient &gValues) {
+        (*fg)(pValues,gValues);
+    }
+}} // likely::absengine
+
 local::AbsEngine::AbsEngine()
 : _evalCount(0), _gradCount(0)
 { }
@@ -16,8 +26,21 @@ local::AbsEngine::~AbsEngine() { }
 local::FunctionMinimumPtr local::findMinimum(FunctionPtr f, GradientCalculatorPtr gc,
 FitParameters const &parameters, std::string const &methodName,
 double precision, long maxIterations) {
+    // Use a null fused evaluator.
+    FunctionAndGradientPtr fg;
+    return findMinimum(f,gc,fg,parameters,methodName,precision,maxIterations);
+}
+
+local::FunctionMinimumPtr local::findMinimum(FunctionPtr f, GradientCalculatorPtr gc,
+FunctionAndGradientPtr fg, FitParameters const &parameters, std::string const &methodName,
+double precision, long maxIterations) {
+    // Calculate gradients with the fused evaluator if we have no gradient calculator.
+    if(fg && !gc) {
+        gc.reset(new GradientCalculator(boost::bind(absengine::calculateGradient,fg,_1,_2)));
+    }
     // Create a new engine for this function.
     AbsEnginePtr engine = getEngine(methodName,f,gc,parameters);
+    engine->functionAndGradient = fg;
     // Initialize a result object (without any covariance) for the algorithm to update.
     Parameters values;
     getFitParameterValues(parameters,values);
@@ -27,6 +27,8 @@ namespace likely {
     	    FitParameters const &, std::string const &, double, long);
         friend FunctionMinimumPtr findMinimum(FunctionPtr, GradientCalculatorPtr,
     	    FitParameters const &, std::string const &, double, long);
+        friend FunctionMinimumPtr findMinimum(FunctionPtr, GradientCalculatorPtr,
+            FunctionAndGradientPtr, FitParameters const &, std::string const &, double, long);
 
     protected:
         // Subclass API for managing evaluation counts.
@@ -36,6 +38,12 @@ namespace likely {
 		// Declares our dynamic entry point for findMinimum.
 		typedef boost::function<void (FunctionMinimumPtr, double, long)> MinimumFinder;
         MinimumFinder minimumFinder;
+        
+        // An optional fused function and gradient evaluator, set by findMinimum before our
+        // minimumFinder is called. Subclasses should use it, when it is set, wherever they
+        // need the function value and its gradient at the same point. Each fused evaluation
+        // counts as both a function and a gradient evaluation.
+        FunctionAndGradientPtr functionAndGradient;
 
     private:        
         mutable long _evalCount, _gradCount;
@@ -62,7 +70,13 @@ namespace likely {
 	FunctionMinimumPtr findMinimum(FunctionPtr f, GradientCalculatorPtr gc,
 	    FitParameters const &parameters, std::string const &methodName,
         double precision = 1e-3, long maxIterations = 0);
-        
+    // Same as above, but also providing a fused evaluation of the function and its gradient
+    // that engines use wherever they need both at the same point. The gradient calculator
+    // is optional and, if it is not provided, the fused evaluation is used for gradients.
+	FunctionMinimumPtr findMinimum(FunctionPtr f, GradientCalculatorPtr gc,
+	    FunctionAndGradientPtr fg, FitParameters const &parameters,
+	    std::string const &methodName, double precision = 1e-3, long maxIterations = 0);
+
 } // likely
 
 #endif // LIKELY_ABS_ENGINE
@@ -0,0 +1,71 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/AlignedAllocator.h"
+#include "likely/ThreadPool.h"
+
+#include "config.h" // propagates HAVE_MADVISE from configure
+
+#include "boost/bind.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#ifdef HAVE_MADVISE
+#include <sys/mman.h>
+#endif
+
+namespace local = likely;
+
+namespace likely {
+namespace aligned {
+    // The size of a transparent huge page on x86-64 (and most other 64-bit platforms).
+    std::size_t const hugePageSize = 2 << 20;
+    // The minimum allocation size that requests huge pages.
+    std::size_t hugePageThreshold = 4 << 20;
+    // The pool used to first touch huge page allocations, if any.
+    ThreadPoolPtr firstTouchPool;
+    // Zeros the huge pages [first,last) of the specified memory.
+    void touchPages(char *memory, std::size_t byteSize, int first, int last) {
+        std::size_t begin((std::size_t)first*hugePageSize);
+        std::size_t end(std::min((std::size_t)last*hugePageSize,byteSize));
+        std::memset(memory + begin,0,end - begin);
+    }
+}} // likely::aligned
+
+void *local::allocateAlignedMemory(std::size_t byteSize) {
+    bool huge(aligned::hugePageThreshold > 0 && byteSize >= aligned::hugePageThreshold);
+    void *memory(0);
+    if(0 != posix_memalign(&memory, huge ? aligned::hugePageSize : alignedMemoryAlignment,
+        byteSize)) return 0;
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+    // This is only a hint, so ignore any error, e.g., if huge pages are disabled.
+    if(huge) madvise(memory,byteSize,MADV_HUGEPAGE);
+#endif
+    if(huge && aligned::firstTouchPool && !ThreadPool::isWorkerThread()) {
+        std::size_t nPages((byteSize + aligned::hugePageSize - 1)/aligned::hugePageSize);
+        aligned::firstTouchPool->parallelForPartitioned(0,nPages,
+            boost::bind(aligned::touchPages,static_cast<char*>(memory),byteSize,_1,_2));
+    }
+    return memory;
+}
+
+void local::freeAlignedMemory(void *memory) {
+    std::free(memory);
+}
+
+std::size_t local::getHugePageThreshold() {
+    return aligned::hugePageThreshold;
+}
+
+void local::setHugePageThreshold(std::size_t byteSize) {
+    aligned::hugePageThreshold = byteSize;
+}
+
+local::ThreadPoolPtr local::getFirstTouchPool() {
+    return aligned::firstTouchPool;
+}
+
+void local::setFirstTouchPool(ThreadPoolPtr pool) {
+    aligned::firstTouchPool = pool;
+}
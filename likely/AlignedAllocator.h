@@ -0,0 +1,77 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_ALIGNED_ALLOCATOR
+#define LIKELY_ALIGNED_ALLOCATOR
+
+#include "likely/types.h"
+
+#include <vector>
+#include <new>
+#include <limits>
+#include <cstddef>
+
+namespace likely {
+    // The alignment in bytes of all memory returned by allocateAlignedMemory, which is
+    // the cache line size of current CPUs and the width of an AVX-512 register.
+    std::size_t const alignedMemoryAlignment = 64;
+    // Allocates the specified number of bytes aligned to alignedMemoryAlignment, or returns
+    // zero if the allocation fails. Allocations of at least getHugePageThreshold() bytes are
+    // instead aligned to a huge page boundary and the kernel is asked, where supported, to
+    // back them with transparent huge pages, which reduces TLB misses when large matrices
+    // are traversed.
+    // The memory returned can be released with either freeAlignedMemory or free.
+    void *allocateAlignedMemory(std::size_t byteSize);
+    void freeAlignedMemory(void *memory);
+    // Gets/sets the minimum allocation size in bytes that requests huge pages. Use a
+    // threshold of zero to never request huge pages.
+    std::size_t getHugePageThreshold();
+    void setHugePageThreshold(std::size_t byteSize);
+    // Gets/sets the thread pool used to first touch the memory of each allocation that
+    // requests huge pages, or an empty pointer (the default) to leave this to whichever
+    // thread first writes to the memory. The memory is zeroed by the pool's workers, one
+    // partition each with ThreadPool::parallelForPartitioned, so that with pinned workers
+    // its pages are spread over NUMA nodes to match later partitioned processing. This is
+    // skipped for allocations made from within a thread pool task. Should not be changed
+    // while other threads are allocating memory.
+    ThreadPoolPtr getFirstTouchPool();
+    void setFirstTouchPool(ThreadPoolPtr pool);
+
+    // An STL allocator that uses allocateAlignedMemory, for large numeric buffers.
+    template <class T> class AlignedAllocator {
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T const *const_pointer;
+        typedef T &reference;
+        typedef T const &const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        template <class U> struct rebind { typedef AlignedAllocator<U> other; };
+        AlignedAllocator() { }
+        template <class U> AlignedAllocator(AlignedAllocator<U> const &) { }
+        pointer address(reference value) const { return &value; }
+        const_pointer address(const_reference value) const { return &value; }
+        pointer allocate(size_type n, void const * /*hint*/ = 0) {
+            if(n > max_size()) throw std::bad_alloc();
+            void *memory(allocateAlignedMemory(n*sizeof(T)));
+            if(0 == memory) throw std::bad_alloc();
+            return static_cast<pointer>(memory);
+        }
+        void deallocate(pointer memory, size_type /*n*/) { freeAlignedMemory(memory); }
+        size_type max_size() const { return std::numeric_limits<size_type>::max()/sizeof(T); }
+        void construct(pointer memory, const_reference value) { new(memory) T(value); }
+        void destroy(pointer memory) { memory->~T(); }
+    }; // AlignedAllocator
+
+    // All AlignedAllocator objects are interchangeable.
+    template <class T, class U>
+    bool operator==(AlignedAllocator<T> const &, AlignedAllocator<U> const &) { return true; }
+    template <class T, class U>
+    bool operator!=(AlignedAllocator<T> const &, AlignedAllocator<U> const &) { return false; }
+
+    // A vector of doubles whose storage is allocated with AlignedAllocator.
+    typedef std::vector<double,AlignedAllocator<double> > AlignedVector;
+
+} // likely
+
+#endif // LIKELY_ALIGNED_ALLOCATOR
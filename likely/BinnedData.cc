@@ -4,12 +4,16 @@
 #include "likely/RuntimeError.h"
 #include "likely/AbsBinning.h"
 #include "likely/CovarianceMatrix.h"
+#include "likely/ConjugateGradientCovariance.h"
+#include "likely/TextWriter.h"
 
 #include "boost/foreach.hpp"
 #include "boost/format.hpp"
-#include "boost/lexical_cast.hpp"
+#include "boost/bind.hpp"
 
 #include <iostream>
+#include <limits>
+#include <cmath>
 
 namespace local = likely;
 
@@ -40,12 +44,16 @@ void local::BinnedData::dropCovariance(double weight) {
     if(isFinalized()) throw RuntimeError("BinnedData::dropCovariance: object is finalized.");
     unweightData();
     _covariance.reset();
+    _covarianceOperator.reset();
     _weight = weight;
 }
 
 local::BinnedData& local::BinnedData::add(BinnedData const& other, double weight) {
     // All done if the requested weight is zero.
     if(0 == weight) return *this;
+    if(hasCovarianceOperator() || other.hasCovarianceOperator()) {
+        throw RuntimeError("BinnedData::add: cannot add data with a covariance operator.");
+    }
     // Do we have any data yet?
     if(0 == getNBinsWithData()) {
         // If we are empty, then we only require that the other dataset have the same binning.
@@ -115,7 +123,7 @@ void local::BinnedData::_setWeighted(bool weighted, bool flushCache) const {
         else {
 #ifdef PARANOID_DATA_CACHE
             // Save the original state of our cache.
-            std::vector<double> saveCache = _dataCache;
+            AlignedVector saveCache = _dataCache;
 #endif
             // Copy the original data to our cache (unless we are going to flush it below)
             if(!flushCache) _dataCache = _data;
@@ -126,6 +134,11 @@ void local::BinnedData::_setWeighted(bool weighted, bool flushCache) const {
                     // Change data to Cinv.data
                     _covariance->multiplyByInverseCovariance(_data);
                 }
+                else if(hasCovarianceOperator()) {
+                    std::vector<double> data(_data.begin(),_data.end());
+                    _covarianceOperator->multiplyByInverseCovariance(data);
+                    _data.assign(data.begin(),data.end());
+                }
                 else if(_weight != 1) {
                     // Scale data by _weight, which plays the role of Cinv.
                     for(int offset = 0; offset < _data.size(); ++offset) _data[offset] *= _weight;
@@ -136,6 +149,11 @@ void local::BinnedData::_setWeighted(bool weighted, bool flushCache) const {
                     // Change Cinv.data to data = C.Cinv.data
                     _covariance->multiplyByCovariance(_data);
                 }
+                else if(hasCovarianceOperator()) {
+                    std::vector<double> data(_data.begin(),_data.end());
+                    _covarianceOperator->multiplyByCovariance(data);
+                    _data.assign(data.begin(),data.end());
+                }
                 else if(_weight != 1) {
                     // Scale data by 1/_weight, which plays the role of C.
                     for(int offset = 0; offset < _data.size(); ++offset) _data[offset] /= _weight;
@@ -176,34 +194,36 @@ bool local::BinnedData::isCongruent(BinnedData const& other, bool onlyBinning, b
             if(other._index[offset] != _index[offset]) return false;
         }
         if(!ignoreCovariance) {
-            // [3] Both must have or not have an associated covariance matrix.
+            // [3] Both must have or not have an associated covariance matrix, and
+            // both must have or not have an associated covariance operator.
             if(other.hasCovariance() && !hasCovariance()) return false;
             if(!other.hasCovariance() && hasCovariance()) return false;
+            if(other.hasCovarianceOperator() != hasCovarianceOperator()) return false;
         }
     }
     return true;
 }
 
-int local::BinnedData::getIndexAtOffset(int offset) const {
+local::Index local::BinnedData::getIndexAtOffset(int offset) const {
     if(offset < 0 || offset >= _index.size()) {
         throw RuntimeError("BinnedData::getIndexAtOffset: invalid offset.");
     }
     return _index[offset];
 }
 
-int local::BinnedData::getOffsetForIndex(int index) const {
+int local::BinnedData::getOffsetForIndex(Index index) const {
     if(!hasData(index)) {
         throw RuntimeError("BinnedData::getOffsetForIndex: no data at index.");
     }
     return _offset[index];
 }
 
-bool local::BinnedData::hasData(int index) const {
+bool local::BinnedData::hasData(Index index) const {
     _grid.checkIndex(index);
     return !(_offset[index] == EMPTY_BIN);
 }
 
-double local::BinnedData::getData(int index, bool weighted) const {
+double local::BinnedData::getData(Index index, bool weighted) const {
     if(!hasData(index)) {
         throw RuntimeError("BinnedData::getData: bin is empty.");
     }
@@ -211,25 +231,28 @@ double local::BinnedData::getData(int index, bool weighted) const {
     return _data[_offset[index]];
 }
 
-void local::BinnedData::setData(int index, double value, bool weighted) {
+void local::BinnedData::setData(Index index, double value, bool weighted) {
     _setWeighted(weighted,true); // flushes any cached data
     if(hasData(index)) {
         _data[_offset[index]] = value;
     }
     else {
-        if(hasCovariance()) {
+        if(hasCovariance() || hasCovarianceOperator()) {
             throw RuntimeError("BinnedData::setData: cannot add data after covariance.");
         }
         if(isFinalized()) {
             throw RuntimeError("BinnedData::setData: object is finalized.");
         }
+        if(_index.size() >= (std::size_t)std::numeric_limits<int>::max()) {
+            throw RuntimeError("BinnedData::setData: too many bins with data.");
+        }
         _offset[index] = _index.size();
         _index.push_back(index);
         _data.push_back(value);
     }
 }
 
-void local::BinnedData::addData(int index, double offset, bool weighted) {
+void local::BinnedData::addData(Index index, double offset, bool weighted) {
     if(!hasData(index)) {
         throw RuntimeError("BinnedData::addData: bin is empty.");        
     }
@@ -237,7 +260,7 @@ void local::BinnedData::addData(int index, double offset, bool weighted) {
     _data[_offset[index]] += offset;
 }
 
-double local::BinnedData::getCovariance(int index1, int index2) const {
+double local::BinnedData::getCovariance(Index index1, Index index2) const {
     if(!hasCovariance()) {
         throw RuntimeError("BinnedData::getCovariance: has no covariance specified.");
     }
@@ -247,7 +270,7 @@ double local::BinnedData::getCovariance(int index1, int index2) const {
     return _covariance->getCovariance(_offset[index1],_offset[index2]);
 }
 
-double local::BinnedData::getInverseCovariance(int index1, int index2) const {
+double local::BinnedData::getInverseCovariance(Index index1, Index index2) const {
     if(!hasCovariance()) {
         throw RuntimeError("BinnedData::getInverseCovariance: has no covariance specified.");
     }
@@ -257,7 +280,7 @@ double local::BinnedData::getInverseCovariance(int index1, int index2) const {
     return _covariance->getInverseCovariance(_offset[index1],_offset[index2]);
 }
 
-void local::BinnedData::setCovariance(int index1, int index2, double value) {
+void local::BinnedData::setCovariance(Index index1, Index index2, double value) {
     if(!hasData(index1) || !hasData(index2)) {
         throw RuntimeError("BinnedData::setCovariance: bin is empty.");
     }
@@ -265,6 +288,9 @@ void local::BinnedData::setCovariance(int index1, int index2, double value) {
         if(isFinalized()) {
             throw RuntimeError("BinnedData::setCovariance: object is finalized.");
         }
+        if(hasCovarianceOperator()) {
+            throw RuntimeError("BinnedData::setCovariance: cannot combine a covariance matrix and operator.");
+        }
         // Create a new covariance matrix sized to the number of bins with data.
         _covariance.reset(new CovarianceMatrix(getNBinsWithData()));
     }
@@ -276,7 +302,7 @@ void local::BinnedData::setCovariance(int index1, int index2, double value) {
     _covariance->setCovariance(_offset[index1],_offset[index2],value);
 }
 
-void local::BinnedData::setInverseCovariance(int index1, int index2, double value) {
+void local::BinnedData::setInverseCovariance(Index index1, Index index2, double value) {
     if(!hasData(index1) || !hasData(index2)) {
         throw RuntimeError("BinnedData::setInverseCovariance: bin is empty.");
     }
@@ -284,6 +310,9 @@ void local::BinnedData::setInverseCovariance(int index1, int index2, double valu
         if(isFinalized()) {
             throw RuntimeError("BinnedData::setInverseCovariance: object is finalized.");
         }
+        if(hasCovarianceOperator()) {
+            throw RuntimeError("BinnedData::setInverseCovariance: cannot combine a covariance matrix and operator.");
+        }
         // Create a new covariance matrix sized to the number of bins with data.
         _covariance.reset(new CovarianceMatrix(getNBinsWithData()));
     }
@@ -362,7 +391,7 @@ int local::BinnedData::projectOntoModes(int nkeep) {
             projected[bin] += dotprod*eigenvectors[index*size+bin];
         }
     }
-    _data = projected;
+    _data.assign(projected.begin(),projected.end());
     return ndrop;
 }
 
@@ -373,9 +402,26 @@ void local::BinnedData::setCovarianceMatrix(CovarianceMatrixPtr covariance) {
     if(covariance->getSize() != getNBinsWithData()) {
         throw RuntimeError("BinnedData::setCovarianceMatrix: new covariance has the wrong size.");
     }
+    if(hasCovarianceOperator()) {
+        throw RuntimeError("BinnedData::setCovarianceMatrix: cannot combine a covariance matrix and operator.");
+    }
     _covariance = covariance;
 }
 
+void local::BinnedData::setCovarianceOperator(ConjugateGradientCovarianceCPtr covariance) {
+    if(isFinalized()) {
+        throw RuntimeError("BinnedData::setCovarianceOperator: object is finalized.");
+    }
+    if(!covariance || covariance->getSize() != getNBinsWithData()) {
+        throw RuntimeError("BinnedData::setCovarianceOperator: new covariance has the wrong size.");
+    }
+    if(hasCovariance()) {
+        throw RuntimeError("BinnedData::setCovarianceOperator: cannot combine a covariance matrix and operator.");
+    }
+    unweightData();
+    _covarianceOperator = covariance;
+}
+
 void local::BinnedData::shareCovarianceMatrix(BinnedData const &other) {
     if(isFinalized()) {
         throw RuntimeError("BinnedData::shareCovarianceMatrix: object is finalized.");
@@ -394,7 +440,7 @@ bool local::BinnedData::compress(bool weighted) const {
     // Get our data vector into the requested format (weighted/unweighted)
     _setWeighted(weighted);
     // Drop any storage used by our cache of the alternate format.
-    std::vector<double>().swap(_dataCache);
+    AlignedVector().swap(_dataCache);
     // Compress our covariance matrix, if any.
     return _covariance.get() ? _covariance->compress() : false;
 }
@@ -409,20 +455,23 @@ bool local::BinnedData::isCompressed() const {
 
 std::size_t local::BinnedData::getMemoryUsage(bool includeCovariance) const {
     std::size_t size = sizeof(*this) +
-        sizeof(int)*(_offset.capacity() + _index.capacity()) +
+        sizeof(int)*_offset.capacity() + sizeof(Index)*_index.capacity() +
         sizeof(double)*(_data.capacity() + _dataCache.capacity());
     if(hasCovariance() && includeCovariance) size += _covariance->getMemoryUsage();
     return size;
 }
 
-void local::BinnedData::prune(std::set<int> const &keep) {
+void local::BinnedData::prune(std::set<Index> const &keep) {
     if(isFinalized()) {
         throw RuntimeError("BinnedData::prune: object is finalized.");
     }
+    if(hasCovarianceOperator()) {
+        throw RuntimeError("BinnedData::prune: cannot prune data with a covariance operator.");
+    }
     // Create a parallel set of internal offsets for each global index, checking that
     // all indices are valid.
     std::set<int> offsets;
-    BOOST_FOREACH(int index, keep) {
+    BOOST_FOREACH(Index index, keep) {
         _grid.checkIndex(index);
         offsets.insert(_offset[index]);
     }
@@ -439,7 +488,7 @@ void local::BinnedData::prune(std::set<int> const &keep) {
     BOOST_FOREACH(int oldOffset, offsets) {
         // oldOffset >= newOffset so we will never clobber an element that we still need
         assert(oldOffset >= newOffset);
-        int index = _index[oldOffset];
+        Index index = _index[oldOffset];
         _offset[index] = newOffset;
         _index[newOffset] = index;
         _data[newOffset] = _data[oldOffset];
@@ -454,9 +503,14 @@ void local::BinnedData::prune(std::set<int> const &keep) {
     }
 }
 
-double local::BinnedData::chiSquare(std::vector<double> pred) const {
+void local::BinnedData::prune(std::set<int> const &keep) {
+    prune(std::set<Index>(keep.begin(),keep.end()));
+}
+
+double local::BinnedData::_subtractData(std::vector<double> &pred, char const *method) const {
     if(pred.size() != getNBinsWithData()) {
-        throw RuntimeError("BinnedData::chiSquare: prediction vector has wrong size.");
+        throw RuntimeError(std::string("BinnedData::") + method +
+            ": prediction vector has wrong size.");
     }
     // Subtract our data vector from the prediction.
     IndexIterator nextIndex(begin());
@@ -466,16 +520,48 @@ double local::BinnedData::chiSquare(std::vector<double> pred) const {
         residual = (*nextPred++ -= getData(*nextIndex++));
         unweighted += residual*residual;
     }
+    return unweighted;
+}
+
+double local::BinnedData::chiSquare(std::vector<double> pred) const {
+    double unweighted(_subtractData(pred,"chiSquare"));
     // Our input vector now holds deltas. Our covariance does the rest of the work.
+    if(hasCovarianceOperator()) return _covarianceOperator->chiSquare(pred);
     return hasCovariance() ? _covariance->chiSquare(pred) : unweighted*_weight;
 }
 
+double local::BinnedData::chiSquare(std::vector<double> pred,
+std::vector<double> &icovResidual) const {
+    double unweighted(_subtractData(pred,"chiSquare"));
+    // Our input vector now holds deltas. Our covariance does the rest of the work.
+    if(hasCovarianceOperator()) return _covarianceOperator->chiSquare(pred,icovResidual);
+    if(hasCovariance()) return _covariance->chiSquare(pred,icovResidual);
+    icovResidual.swap(pred);
+    for(std::vector<double>::iterator iter = icovResidual.begin(); iter != icovResidual.end(); ++iter) {
+        *iter *= _weight;
+    }
+    return unweighted*_weight;
+}
+
+double local::BinnedData::chiSquareWithThreshold(std::vector<double> pred,
+double threshold) const {
+    double unweighted(_subtractData(pred,"chiSquareWithThreshold"));
+    // Our input vector now holds deltas. Our covariance does the rest of the work.
+    // Conjugate gradients only gives a chi-square once it has converged.
+    if(hasCovarianceOperator()) return _covarianceOperator->chiSquare(pred);
+    return hasCovariance() ?
+        _covariance->chiSquareWithThreshold(pred,threshold) : unweighted*_weight;
+}
+
 void local::BinnedData::getDecorrelatedWeights(std::vector<double> const &pred,
 std::vector<double> &dweights) const {
     int nbins(getNBinsWithData());
     if(pred.size() != nbins) {
         throw RuntimeError("BinnedData::getDecorrelatedErrors: prediction vector has wrong size.");
     }
+    if(hasCovarianceOperator()) {
+        throw RuntimeError("BinnedData::getDecorrelatedErrors: not available with a covariance operator.");
+    }
     dweights.reserve(nbins);
     dweights.resize(0);
     // Subtract the prediction from our data vector.
@@ -509,37 +595,55 @@ std::vector<double> &dweights) const {
 void local::BinnedData::printToStream(std::ostream &out, std::string format) const {
     boost::format indexFormat("[%4d] "),valueFormat(format);
     for(IndexIterator iter = begin(); iter != end(); ++iter) {
-        int index(*iter);
+        Index index(*iter);
         out << (indexFormat % index) << (valueFormat % getData(index)) << std::endl;
     }
 }
 
 void local::BinnedData::saveData(std::ostream &os, bool weighted) const {    
+    // TextWriter formats doubles exactly like lexical_cast, to ensure that the full
+    // double precision is saved.
+    TextWriter writer(os);
     for(IndexIterator iter = begin(); iter != end(); ++iter) {
         double value = getData(*iter,weighted);
-        // Use lexical_cast to ensure that the full double precision is saved.
-        os << *iter << ' ' << boost::lexical_cast<std::string>(value) << std::endl;
+        writer << *iter << ' ' << value << '\n';
     }
 }
 
-void local::BinnedData::saveInverseCovariance(std::ostream &os, double scale) const {
+void local::BinnedData::saveInverseCovariance(std::ostream &os, double scale, ThreadPoolPtr pool) const {
     if(!getCovarianceMatrix()->isPositiveDefinite()) {
         throw RuntimeError("BinnedData::saveInverseCovariance: matrix is not positive definite.");
     }
-    for(IndexIterator iter1 = begin(); iter1 != end(); ++iter1) {
-        int index1(*iter1);
+    TextWriter writer(os);
+    int nRows(getNBinsWithData());
+    // Calculate the inverse covariance once, before any parallel reads.
+    double const *icov(_covariance->getPackedInverseCovariance());
+    if(pool && nRows > 0) {
+        writeRows(writer,nRows,
+            boost::bind(&BinnedData::_saveInverseCovarianceRows,this,_1,_2,_3,scale,icov),pool);
+    }
+    else {
+        _saveInverseCovarianceRows(writer,0,nRows,scale,icov);
+    }
+}
+
+void local::BinnedData::_saveInverseCovarianceRows(TextWriter &writer, int first, int last,
+double scale, double const *icov) const {
+    // The bin at position k of our index order has covariance offset k, so row k of the
+    // upper triangle is found at packed[k+col*(col+1)/2] for col = k,k+1,...
+    for(int row = first; row < last; ++row) {
+        Index index1(_index[row]);
+        Index packed(symmetricMatrixIndex(row,row,_index.size()));
         // Save all diagonal elements.
-        double value = scale*getInverseCovariance(index1,index1);
-        os << index1 << ' ' << index1 << ' '
-            << boost::lexical_cast<std::string>(value) << std::endl;
+        double value = scale*icov[packed];
+        writer << index1 << ' ' << index1 << ' ' << value << '\n';
         // Loop over pairs with index2 > index1
-        for(IndexIterator iter2 = iter1; ++iter2 != end();) {
-            int index2(*iter2);
-            value = scale*getInverseCovariance(index1,index2);
+        for(int col = row+1; col < _index.size(); ++col) {
+            packed += col;
+            value = scale*icov[packed];
             // Only save non-zero off-diagonal elements.
             if(0 == value) continue;
-            // Use lexical_cast to ensure that the full double precision is saved.
-            os << index1 << ' ' << index2 << ' ' << boost::lexical_cast<std::string>(value) << std::endl;
+            writer << index1 << ' ' << _index[col] << ' ' << value << '\n';
         }
     }
 }
@@ -549,7 +653,9 @@ local::BinnedDataPtr local::BinnedData::sample(RandomPtr random) const {
     bool binningOnly(true);
     BinnedDataPtr sampled(this->clone(binningOnly));
     // Fill the new dataset with noise sampled from our covariance.
-    _covariance->sample(sampled->_data,random);
+    std::vector<double> noise;
+    _covariance->sample(noise,random);
+    sampled->_data.assign(noise.begin(),noise.end());
     // Copy our data vector book-keeping arrays to the sampled dataset.
     sampled->_offset = _offset;
     sampled->_index = _index;
@@ -567,6 +673,9 @@ local::BinnedDataPtr local::BinnedData::sample(RandomPtr random) const {
 }
 
 double local::BinnedData::getScalarWeight() const {
+    if(hasCovarianceOperator()) {
+        throw RuntimeError("BinnedData::getScalarWeight: not available with a covariance operator.");
+    }
     return hasCovariance() ? std::exp(-_covariance->getLogDeterminant()/getNBinsWithData()) : _weight;
 }
 
@@ -5,6 +5,7 @@
 
 #include "likely/types.h"
 #include "likely/BinnedGrid.h"
+#include "likely/AlignedAllocator.h"
 
 #include "boost/smart_ptr.hpp"
 
@@ -14,6 +15,7 @@
 #include <iosfwd>
 
 namespace likely {
+    class TextWriter;
     // Represents data that is binned independently along one or more axes. Not all possible
     // bins within the rectangular volumed defined by the binning are assumed to be filled.
     // The binned data may have an associated covariance matrix. Most of this class' methods
@@ -70,7 +72,8 @@ namespace likely {
         // Tests if another binned dataset is "congruent" with ours. Congruence requires:
         // [1] identical binning specifications along each axis
         // [2] that the same bins be occupied in the same order
-        // [3] that both datasets either have or do not have covariance matrices
+        // [3] that both datasets either have or do not have covariance matrices, and
+        //     either have or do not have covariance operators
         // Use the optional booleans to determine which conditions are checked:
         //
         //   onlyBinning   ignoreCovariance  conditions
@@ -89,7 +92,7 @@ namespace likely {
         // Returns iterators pointing to the first and last global indices for bins with data.
         // Iteration order is defined by the order of setData(...) calls, and not by the global
         // index value.
-        typedef std::vector<int>::const_iterator IndexIterator;
+        typedef std::vector<Index>::const_iterator IndexIterator;
         IndexIterator begin() const;
         IndexIterator end() const;
 
@@ -97,22 +100,22 @@ namespace likely {
         // is the first data value loaded by setData, offset = 1 is the next data value, etc.
         // This method is useful for matching up BinnedData entries with an ordered list of
         // values that was used to create it. Throws a RuntimeError if offset is out of range.
-        int getIndexAtOffset(int offset) const;
+        Index getIndexAtOffset(int offset) const;
         // Returns the offset corresponding to a global index, or throws a RuntimeError for
         // an index with no associated data or out of range.
-        int getOffsetForIndex(int index) const;
+        int getOffsetForIndex(Index index) const;
         
         // Returns true if the bin corresponding to the specified global index has data, or
         // else returns false. Note that a data whose contents is zero is not considered empty.
         // An empty bin is one that has never had any value assigned to it.
-        bool hasData(int index) const;
+        bool hasData(Index index) const;
         // Returns the data associated with the specified global index or else throws a
         // RuntimeError if this bin does not contain any data. If weighted is true, then
         // the value returned is (Cinv.data)[index] instead of data[index]. Be aware that
         // going back and forth between weighted and unweighted access requires potentially
         // expensive covariance matrix operations. If this data has no covariance, then
         // weighted and unweighted values are equivalent.
-        double getData(int index, bool weighted = false) const;
+        double getData(Index index, bool weighted = false) const;
         // Sets the data value for the bin associated with the specified global index. After
         // calling this method successfully, hasData(index) will be true. Note that once this
         // object has started filling a covariance matrix, i.e., hasCovariance() == true, then
@@ -121,13 +124,13 @@ namespace likely {
         // Be aware that going back and forth between weighted and unweighted access requires
         // potentially expensive covariance matrix operations. If this data has no covariance, then
         // weighted and unweighted values are equivalent.
-        void setData(int index, double value, bool weighted = false);
+        void setData(Index index, double value, bool weighted = false);
         // Adds the specified offset to the value for the specified bin, which must already
         // have data associated with it. If weighted is true, then the value being updated is
         // (Cinv.data)[index] instead of data[index]. Be aware that going back and forth between
         // weighted and unweighted access requires potentially expensive covariance matrix operations.
         // If this data has no covariance, then weighted and unweighted values are equivalent.
-        void addData(int index, double offset, bool weighted = false);
+        void addData(Index index, double offset, bool weighted = false);
         // Returns true if our internal data representation is currently weighted, i.e.,
         // stored as Cinv.data rather than data. Changes to our internal representation are
         // triggered automatically, so this method simply allows these changes to be tracked.
@@ -151,7 +154,7 @@ namespace likely {
         // method allows an object created via the copy constructor or assignment operator to
         // modify its covariance matrix, with a corresponding increase in memory usage.
         void cloneCovariance();
-        // Drops any covariance matrix and assigns the specified scalar weight.
+        // Drops any covariance matrix or operator and assigns the specified scalar weight.
         // Calls unweightData().
         void dropCovariance(double weight = 1);
         // Returns the (inverse) covariance matrix element for the specified pair of global
@@ -159,8 +162,8 @@ namespace likely {
         // or if no covariance has been specified for this data. Be aware that going back and
         // forth between Covariance and InverseCovariance operations requires potentially
         // expensive matrix operations.
-        double getCovariance(int index1, int index2) const;
-        double getInverseCovariance(int index1, int index2) const;
+        double getCovariance(Index index1, Index index2) const;
+        double getInverseCovariance(Index index1, Index index2) const;
         // Sets the (inverse) covariance matrix element for the specified pair of global
         // indices, or throws a RuntimeError if either of the corresponding bins has no data.
         // After the first call to one of these methods, hasCovariance() == true and no
@@ -172,8 +175,8 @@ namespace likely {
         // it does change the meaning of weighted data. For example, if isDataWeighted() is true,
         // then setCovariance() changes the subsequent result of getData(...,weighted=false) but
         // not of getData(...,weighted=true). Use the unweightData() method for more control of this.
-        void setCovariance(int index1, int index2, double value);
-        void setInverseCovariance(int index1, int index2, double value);
+        void setCovariance(Index index1, Index index2, double value);
+        void setInverseCovariance(Index index1, Index index2, double value);
         // Returns a const shared pointer to our covariance matrix, if any.
         CovarianceMatrixCPtr getCovarianceMatrix() const;
         // Replaces our covariance matrix, if any, with the specified matrix or throws a
@@ -183,6 +186,17 @@ namespace likely {
         // congruent binned data. After this operation, isCovarianceModifiable will be false
         // for both binned data objects. Think about whether you want to call unweightData() first.
         void shareCovarianceMatrix(BinnedData const &other);
+        // Replaces our covariance with an implicit covariance that uses conjugate gradients
+        // to calculate chi-square and weighted data, for datasets too large for a dense
+        // covariance matrix, or else throws a RuntimeError. A covariance operator cannot be
+        // combined with a covariance matrix, so none of the methods above that access or
+        // modify matrix elements are available, and hasCovariance() remains false. Data with
+        // a covariance operator cannot be added to other data. Calls unweightData().
+        void setCovarianceOperator(ConjugateGradientCovarianceCPtr covariance);
+        // Returns true if we have a covariance operator.
+        bool hasCovarianceOperator() const;
+        // Returns a const shared pointer to our covariance operator, if any.
+        ConjugateGradientCovarianceCPtr getCovarianceOperator() const;
         // Transforms our covariance matrix C by replacing it with C.Dinv.C. On return, D
         // contains our original covariance matrix. Calls unweightData().
         void transformCovariance(CovarianceMatrixPtr D);
@@ -194,11 +208,22 @@ namespace likely {
         // vector of predicted data, or throws a RuntimeError. The predicted data vector
         // must use the same index sequence as our index iterator. (The copy by value
         // used here is an optimization, not a mistake.) If no covariance is available,
-        // then Cinv=identity is assumed.
+        // then Cinv=identity is assumed. If we have a covariance operator, it calculates the
+        // chi-square with conjugate gradients, warm started from the previous call.
         double chiSquare(std::vector<double> pred) const;
+        // Calculates the same chi-square and also fills icovResidual with Cinv.(pred-data),
+        // from the same pass through Cinv, so that the chi-square gradient with respect to
+        // any parameters of pred is 2*Jt.icovResidual where J is the jacobian of pred.
+        // Use addChiSquareGradient (see CovarianceMatrix.h) to calculate this.
+        double chiSquare(std::vector<double> pred, std::vector<double> &icovResidual) const;
+        // Returns the same chi-square as chiSquare(pred) if it is <= threshold, or else any
+        // value > threshold, which can be much faster when a large chi-square is detected
+        // early. See CovarianceMatrix::chiSquareWithThreshold for details.
+        double chiSquareWithThreshold(std::vector<double> pred, double threshold) const;
         // Returns this dataset's scalar weight. If we have a covariance matrix, this is defined
         // as det(C)^(-1/n) where n = getNBinsWithData(). Otherwise, it will be a scalar value
         // playing the role of Cinv that is maintained internally and which defaults to one.
+        // Throws a RuntimeError if we have a covariance operator.
         double getScalarWeight() const;
         // Calculates the "decorrelated" weights for the specified prediction vector and
         // saves the results in the vector provided. Decorrelated weights are defined as:
@@ -221,6 +246,8 @@ namespace likely {
         // The axis binning is unchanged by pruning. A covariance matrix, if present,
         // will be changed. If an existing covariance matrix is not modifiable, it will
         // be cloned before pruning.
+        // Global indices are 64-bit, but callers may still build their keep set with int.
+        void prune(std::set<Index> const &keep);
         void prune(std::set<int> const &keep);
         
         // Projects our data onto a subspace defined by a set of eigenmodes of our covariance
@@ -277,24 +304,41 @@ namespace likely {
         // use full double precision. The format is a list of "index1 index2 value" lines,
         // where value = scale*getInverseCovariance(index1,index2). Lines with value==0
         // or index2 < index1 are not written to the file. Throws a RuntimeError if the
-        // covariance is not positive-definite.
-        void saveInverseCovariance(std::ostream &os, double scale = 1) const;
+        // covariance is not positive-definite. If a thread pool is provided, blocks of
+        // rows are formatted in parallel, with exactly the same output.
+        void saveInverseCovariance(std::ostream &os, double scale = 1,
+            ThreadPoolPtr pool = ThreadPoolPtr()) const;
 
         // Returns a string that displays the memory state of this object.
         std::string getMemoryState() const;
 
 	private:
+        // Replaces each prediction with its residual from our data and returns the sum of
+        // squared residuals, or throws a RuntimeError naming the specified method if the
+        // prediction vector has the wrong size.
+        double _subtractData(std::vector<double> &pred, char const *method) const;
+        // Writes the saveInverseCovariance lines for the bins in [first,last) of our index order,
+        // reading the packed inverse covariance provided.
+        void _saveInverseCovarianceRows(TextWriter &writer, int first, int last, double scale,
+            double const *icov) const;
         // The grid that our data represents.
         BinnedGrid _grid;
         enum { EMPTY_BIN = -1 };
-        std::vector<int> _offset, _index;
+        // The offset of each global index into our data vector, or EMPTY_BIN. Offsets are
+        // stored as 32-bit values since the number of bins with data is limited by the size
+        // of a covariance matrix, even when global indices are 64-bit.
+        std::vector<int> _offset;
+        // The global index of each bin with data, in the order that data was first set.
+        std::vector<Index> _index;
         // Our data vector which might be weighted.
-        mutable std::vector<double> _data;
+        mutable AlignedVector _data;
         // A data vector cache which is either empty or else contains the weighted/unweighted
         // complement corresponding to _data.
-        mutable std::vector<double> _dataCache;
+        mutable AlignedVector _dataCache;
         // A shared pointer to our covariance matrix, if any.
         CovarianceMatrixPtr _covariance;
+        // A shared pointer to our covariance operator, if any.
+        ConjugateGradientCovarianceCPtr _covarianceOperator;
         // In case we have no covariance, we need a scalar that plays the role of Cinv, to
         // implement weighted operations such as add() and chiSquare().
         double _weight;
@@ -315,6 +359,10 @@ namespace likely {
     inline bool BinnedData::hasCovariance() const { return _covariance.get() != 0; }
     inline bool BinnedData::isDataWeighted() const { return _weighted; }
     inline CovarianceMatrixCPtr BinnedData::getCovarianceMatrix() const { return _covariance; }
+    inline bool BinnedData::hasCovarianceOperator() const { return _covarianceOperator.get() != 0; }
+    inline ConjugateGradientCovarianceCPtr BinnedData::getCovarianceOperator() const {
+        return _covarianceOperator;
+    }
     inline bool BinnedData::isCovarianceModifiable() const {
         return 0 == _covariance.get() || _covariance.unique();
     }
@@ -7,6 +7,8 @@
 #include "boost/foreach.hpp"
 #include "boost/lexical_cast.hpp"
 
+#include <limits>
+
 namespace local = likely;
 
 local::BinnedGrid::BinnedGrid(std::vector<AbsBinningCPtr> axes)
@@ -51,18 +53,22 @@ local::BinnedGrid::BinnedGrid(AbsBinningCPtr axis1, AbsBinningCPtr axis2, AbsBin
 void local::BinnedGrid::_initialize() {
     _nbins = 1;
     BOOST_FOREACH(AbsBinningCPtr binning, _axisBinning) {
-        _nbins *= binning->getNBins();
+        Index nBins(binning->getNBins());
+        if(_nbins > std::numeric_limits<Index>::max()/nBins) {
+            throw RuntimeError("BinnedGrid: total number of bins overflows.");
+        }
+        _nbins *= nBins;
     }
 }
 
 local::BinnedGrid::~BinnedGrid() { }
 
-int local::BinnedGrid::getIndex(std::vector<int> const &binIndices) const {
+local::Index local::BinnedGrid::getIndex(std::vector<int> const &binIndices) const {
     int nAxes(getNAxes());
     if(binIndices.size() != nAxes) {
         throw RuntimeError("BinnedGrid::getIndex: invalid input vector size.");
     }
-    int index(0);
+    Index index(0);
     for(int axis = 0; axis < nAxes; ++axis) {
         int binIndex(binIndices[axis]), nBins(_axisBinning[axis]->getNBins());
         if(binIndex < 0 || binIndex >= nBins) {
@@ -73,8 +79,8 @@ int local::BinnedGrid::getIndex(std::vector<int> const &binIndices) const {
     return index;
 }
 
-int local::BinnedGrid::getIndex(std::vector<double> const &values) const {
-    int index(0), nAxes(getNAxes());
+local::Index local::BinnedGrid::getIndex(std::vector<double> const &values) const {
+    int nAxes(getNAxes());
     if(values.size() != nAxes) {
         throw RuntimeError("BinnedGrid::getIndex: invalid input vector size.");
     }
@@ -85,11 +91,11 @@ int local::BinnedGrid::getIndex(std::vector<double> const &values) const {
     return getIndex(binIndices);
 }
 
-void local::BinnedGrid::getBinIndices(int index, std::vector<int> &binIndices) const {
+void local::BinnedGrid::getBinIndices(Index index, std::vector<int> &binIndices) const {
     checkIndex(index);
     int nAxes(getNAxes());
     binIndices.resize(nAxes,0);
-    int partial(index);
+    Index partial(index);
     for(int axis = nAxes-1; axis >= 0; --axis) {
         AbsBinningCPtr binning = _axisBinning[axis];
         int nBins(binning->getNBins()), binIndex(partial % nBins);
@@ -98,7 +104,7 @@ void local::BinnedGrid::getBinIndices(int index, std::vector<int> &binIndices) c
     }
 }
 
-void local::BinnedGrid::getBinNeighbors(int index, std::vector<int> &neighborIndices, int n) const {
+void local::BinnedGrid::getBinNeighbors(Index index, std::vector<Index> &neighborIndices, int n) const {
     checkIndex(index);
     int nAxes(getNAxes());
     std::vector<int> binIndices(nAxes);
@@ -109,9 +115,10 @@ void local::BinnedGrid::getBinNeighbors(int index, std::vector<int> &neighborInd
     for(int axis = 0; axis < nAxes; ++axis) {
         int nBins(_axisBinning[axis]->getNBins());
         // Loop over neighbors so far
-        std::vector<int> tempIndices;
+        std::vector<Index> tempIndices;
         for(int neighbor = 0; neighbor < neighborIndices.size(); ++neighbor) {
-            int partial(neighborIndices[neighbor]), binIndex(binIndices[axis]);
+            Index partial(neighborIndices[neighbor]);
+            int binIndex(binIndices[axis]);
             // Add neighbors in this dimension
             for(int i = std::max(binIndex-n,0); i <= std::min(binIndex+n,nBins-1); ++i){
                 tempIndices.push_back(i + partial*nBins);
@@ -122,7 +129,7 @@ void local::BinnedGrid::getBinNeighbors(int index, std::vector<int> &neighborInd
     }
 }
 
-void local::BinnedGrid::getBinCenters(int index, std::vector<double> &binCenters) const {
+void local::BinnedGrid::getBinCenters(Index index, std::vector<double> &binCenters) const {
     checkIndex(index);
     binCenters.resize(0);
     binCenters.reserve(getNAxes());
@@ -135,7 +142,7 @@ void local::BinnedGrid::getBinCenters(int index, std::vector<double> &binCenters
     }
 }
 
-void local::BinnedGrid::getBinWidths(int index, std::vector<double> &binWidths) const {
+void local::BinnedGrid::getBinWidths(Index index, std::vector<double> &binWidths) const {
     checkIndex(index);
     binWidths.resize(0);
     binWidths.reserve(getNAxes());
@@ -167,7 +174,7 @@ local::AbsBinningCPtr local::BinnedGrid::getAxisBinning(int axis) const {
     return _axisBinning[axis];
 }
 
-void local::BinnedGrid::checkIndex(int index) const {
+void local::BinnedGrid::checkIndex(Index index) const {
     if(index < 0 || index >= _nbins) {
         throw RuntimeError("BinnedGrid: invalid index " +
             boost::lexical_cast<std::string>(index));
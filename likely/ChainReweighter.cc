@@ -0,0 +1,126 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/ChainReweighter.h"
+#include "likely/ThreadPool.h"
+#include "likely/CovarianceAccumulator.h"
+
+#include "boost/bind.hpp"
+#include "boost/math/special_functions/fpclassify.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace local = likely;
+
+local::ChainReweighter::ChainReweighter(FitParameters const &parameters)
+: _nParameters(parameters.size())
+{
+    for(int index = 0; index < _nParameters; ++index) {
+        if(parameters[index].isFloating()) _floatingIndex.push_back(index);
+    }
+    if(_floatingIndex.empty()) {
+        throw RuntimeError("ChainReweighter: no floating parameters.");
+    }
+}
+
+local::ChainReweighter::~ChainReweighter() { }
+
+void local::ChainReweighter::addSample(Parameters const &values, double nll, double weight) {
+    if(values.size() != _nParameters) {
+        throw RuntimeError("ChainReweighter::addSample: got wrong number of parameter values.");
+    }
+    if(!(boost::math::isfinite)(nll)) {
+        throw RuntimeError("ChainReweighter::addSample: got non-finite nll.");
+    }
+    if(weight <= 0) {
+        throw RuntimeError("ChainReweighter::addSample: got weight <= 0.");
+    }
+    _values.insert(_values.end(),values.begin(),values.end());
+    _nll.push_back(nll);
+    _logWeights.push_back(std::log(weight));
+    _weights.push_back(weight);
+}
+
+void local::ChainReweighter::addTrial(Parameters const &current, Parameters const &/*trial*/,
+double currentNLL, double /*trialNLL*/, bool /*accepted*/) {
+    addSample(current,currentNLL);
+}
+
+void local::ChainReweighter::resetWeights() {
+    for(int sample = 0; sample < _weights.size(); ++sample) {
+        _weights[sample] = std::exp(_logWeights[sample]);
+    }
+}
+
+double local::ChainReweighter::getWeight(int index) const {
+    if(index < 0 || index >= _weights.size()) {
+        throw RuntimeError("ChainReweighter::getWeight: invalid sample index.");
+    }
+    return _weights[index];
+}
+
+double local::ChainReweighter::getEffectiveSampleSize() const {
+    double sum(0), sumsq(0);
+    for(std::vector<double>::const_iterator iter = _weights.begin(); iter != _weights.end(); ++iter) {
+        sum += *iter;
+        sumsq += (*iter)*(*iter);
+    }
+    return sumsq > 0 ? sum*sum/sumsq : 0;
+}
+
+double local::ChainReweighter::reweight(FunctionPtr newNLL, ThreadPoolPtr pool) {
+    return _reweight(newNLL,false,pool);
+}
+
+double local::ChainReweighter::reweightByChange(FunctionPtr deltaNLL, ThreadPoolPtr pool) {
+    return _reweight(deltaNLL,true,pool);
+}
+
+void local::ChainReweighter::_evaluate(FunctionPtr f, bool isChange, int first, int last) {
+    Parameters values(_nParameters);
+    for(int sample = first; sample < last; ++sample) {
+        std::vector<double>::const_iterator begin(_values.begin() + sample*_nParameters);
+        std::copy(begin,begin + _nParameters,values.begin());
+        double change((*f)(values));
+        if(!isChange) change -= _nll[sample];
+        _newLogWeights[sample] = (boost::math::isfinite)(change) ?
+            _logWeights[sample] - change : -std::numeric_limits<double>::infinity();
+    }
+}
+
+double local::ChainReweighter::_reweight(FunctionPtr f, bool isChange, ThreadPoolPtr pool) {
+    if(!f) {
+        throw RuntimeError("ChainReweighter::reweight: no function provided.");
+    }
+    int nSamples(getNSamples());
+    if(0 == nSamples) {
+        throw RuntimeError("ChainReweighter::reweight: no samples available.");
+    }
+    if(!pool) pool = getDefaultThreadPool();
+    // Calculate the new log-weight of each sample in parallel.
+    _newLogWeights.resize(nSamples);
+    pool->parallelFor(0,nSamples,
+        boost::bind(&ChainReweighter::_evaluate,this,f,isChange,_1,_2));
+    // Normalize our weights to a maximum of one to avoid overflow.
+    double maxLogWeight(*std::max_element(_newLogWeights.begin(),_newLogWeights.end()));
+    if(!(boost::math::isfinite)(maxLogWeight)) {
+        throw RuntimeError("ChainReweighter::reweight: all samples have zero weight.");
+    }
+    for(int sample = 0; sample < nSamples; ++sample) {
+        _weights[sample] = std::exp(_newLogWeights[sample] - maxLogWeight);
+    }
+    return getEffectiveSampleSize();
+}
+
+void local::ChainReweighter::accumulate(CovarianceAccumulator &accumulator) const {
+    int nFloating(_floatingIndex.size());
+    std::vector<double> floating(nFloating);
+    for(int sample = 0; sample < _weights.size(); ++sample) {
+        if(_weights[sample] <= 0) continue;
+        for(int k = 0; k < nFloating; ++k) {
+            floating[k] = _values[sample*_nParameters + _floatingIndex[k]];
+        }
+        accumulator.accumulate(floating,_weights[sample]);
+    }
+}
@@ -0,0 +1,81 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_CHAIN_REWEIGHTER
+#define LIKELY_CHAIN_REWEIGHTER
+
+#include "likely/types.h"
+#include "likely/FitParameter.h"
+#include "likely/RuntimeError.h"
+
+#include <vector>
+
+namespace likely {
+    class CovarianceAccumulator;
+    // Reweights stored Markov chain samples to reflect a modified prior, dataset or
+    // covariance, using importance sampling instead of generating a new chain. Only the
+    // new -log(likelihood) (or its change) needs to be evaluated for each stored sample,
+    // and these evaluations are run in parallel. Reweighting is only reliable when the
+    // modified posterior is well covered by the original samples, which can be checked
+    // with the effective sample size.
+	class ChainReweighter {
+	public:
+	    // Creates a new reweighter for samples of the specified parameters. Statistics are
+	    // only accumulated for floating parameters, but samples include all parameter values.
+		ChainReweighter(FitParameters const &parameters);
+		virtual ~ChainReweighter();
+        // Adds a sample with the specified parameter values, -log(likelihood) and weight.
+        void addSample(Parameters const &values, double nll, double weight = 1);
+        // Adds the current state of a chain from a MarkovChainEngine::generate callback. Use
+        // this method with boost::bind(&ChainReweighter::addTrial,reweighter,_1,_2,_3,_4,_5).
+        void addTrial(Parameters const &current, Parameters const &trial,
+            double currentNLL, double trialNLL, bool accepted);
+        // Returns the number of samples added so far.
+        int getNSamples() const;
+        // Updates our sample weights for the specified new -log(likelihood) function,
+        // relative to the value recorded with each sample. Evaluations are run in parallel
+        // using the specified pool, or else the default pool, so newNLL must be safe to
+        // call from multiple threads. Samples where newNLL is not finite get zero weight.
+        // Returns the effective sample size after reweighting.
+        double reweight(FunctionPtr newNLL, ThreadPoolPtr pool = ThreadPoolPtr());
+        // Updates our sample weights for the specified change in -log(likelihood), for
+        // example, due to a modified prior. Otherwise identical to reweight() above.
+        double reweightByChange(FunctionPtr deltaNLL, ThreadPoolPtr pool = ThreadPoolPtr());
+        // Restores the weights originally provided with each sample.
+        void resetWeights();
+        // Returns the current weight of the sample with the specified index. After reweight()
+        // or reweightByChange(), weights are normalized so that the largest weight is one.
+        // Otherwise they are the weights originally provided with each sample.
+        double getWeight(int index) const;
+        // Returns the effective sample size (sum w)^2/(sum w^2) of our current weights.
+        double getEffectiveSampleSize() const;
+        // Accumulates the values of the floating parameter with the specified index using
+        // our current weights. Samples with zero weight are skipped. The accumulator can
+        // be a WeightedAccumulator, QuantileAccumulator or ExactQuantileAccumulator.
+        template <class A> void accumulate(int index, A &accumulator) const;
+        // Accumulates the floating parameter values of each sample using our current weights.
+        // The accumulator must have a size equal to the number of floating parameters.
+        void accumulate(CovarianceAccumulator &accumulator) const;
+	private:
+        double _reweight(FunctionPtr f, bool isChange, ThreadPoolPtr pool);
+        void _evaluate(FunctionPtr f, bool isChange, int first, int last);
+        int _nParameters;
+        std::vector<int> _floatingIndex;
+        std::vector<double> _values, _nll, _logWeights, _newLogWeights, _weights;
+	}; // ChainReweighter
+
+    inline int ChainReweighter::getNSamples() const { return _nll.size(); }
+
+    template <class A> void ChainReweighter::accumulate(int index, A &accumulator) const {
+        if(index < 0 || index >= _floatingIndex.size()) {
+            throw RuntimeError("ChainReweighter::accumulate: invalid parameter index.");
+        }
+        for(int sample = 0; sample < _weights.size(); ++sample) {
+            if(_weights[sample] <= 0) continue;
+            accumulator.accumulate(_values[sample*_nParameters + _floatingIndex[index]],
+                _weights[sample]);
+        }
+    }
+
+} // likely
+
+#endif // LIKELY_CHAIN_REWEIGHTER
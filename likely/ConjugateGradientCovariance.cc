@@ -0,0 +1,324 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/ConjugateGradientCovariance.h"
+#include "likely/RuntimeError.h"
+
+#include <cmath>
+
+namespace local = likely;
+
+namespace likely {
+namespace cg {
+    // Holds a mutex for the lifetime of this object.
+    class Lock {
+    public:
+        explicit Lock(pthread_mutex_t &mutex) : _mutex(mutex) { pthread_mutex_lock(&_mutex); }
+        ~Lock() { pthread_mutex_unlock(&_mutex); }
+    private:
+        pthread_mutex_t &_mutex;
+    };
+    double dot(std::vector<double> const &a, std::vector<double> const &b) {
+        double sum(0);
+        for(std::size_t index = 0; index < a.size(); ++index) sum += a[index]*b[index];
+        return sum;
+    }
+} // cg
+} // likely
+
+local::ConjugateGradientCovariance::ConjugateGradientCovariance(int size, bool isInverse)
+: _size(size), _maxIterations(0), _isInverse(isInverse), _warmStart(true), _tolerance(1e-10),
+_preconditioner(IncompleteCholeskyPreconditioner), _lastIterations(0), _prepared(false)
+{
+    if(_size <= 0) {
+        throw RuntimeError("ConjugateGradientCovariance: expected size > 0.");
+    }
+    _elements.resize(_size);
+    pthread_mutex_init(&_mutex,0);
+}
+
+local::ConjugateGradientCovariance::ConjugateGradientCovariance(int size, MultiplyFunction multiply,
+bool isInverse, std::vector<double> const &diagonal)
+: _size(size), _maxIterations(0), _isInverse(isInverse), _warmStart(true), _tolerance(1e-10),
+_multiplyFunction(multiply), _diagonal(diagonal), _lastIterations(0), _prepared(false)
+{
+    if(_size <= 0) {
+        throw RuntimeError("ConjugateGradientCovariance: expected size > 0.");
+    }
+    if(!_multiplyFunction) {
+        throw RuntimeError("ConjugateGradientCovariance: no multiply function provided.");
+    }
+    if(_diagonal.size() > 0 && _diagonal.size() != _size) {
+        throw RuntimeError("ConjugateGradientCovariance: diagonal has wrong size.");
+    }
+    for(int index = 0; index < _diagonal.size(); ++index) {
+        if(_diagonal[index] <= 0) {
+            throw RuntimeError("ConjugateGradientCovariance: diagonal must be positive.");
+        }
+    }
+    _preconditioner = _diagonal.empty() ? NoPreconditioner : DiagonalPreconditioner;
+    pthread_mutex_init(&_mutex,0);
+}
+
+local::ConjugateGradientCovariance::~ConjugateGradientCovariance() {
+    pthread_mutex_destroy(&_mutex);
+}
+
+void local::ConjugateGradientCovariance::setElement(int row, int col, double value) {
+    if(_multiplyFunction) {
+        throw RuntimeError("ConjugateGradientCovariance::setElement: matrix has a multiply function.");
+    }
+    if(_prepared) {
+        throw RuntimeError("ConjugateGradientCovariance::setElement: matrix is already in use.");
+    }
+    if(row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw RuntimeError("ConjugateGradientCovariance::setElement: invalid row or col.");
+    }
+    if(row > col) std::swap(row,col);
+    if(row == col && value <= 0) {
+        throw RuntimeError("ConjugateGradientCovariance::setElement: diagonal must be positive.");
+    }
+    if(0 == value) _elements[col].erase(row);
+    else _elements[col][row] = value;
+}
+
+void local::ConjugateGradientCovariance::setPreconditioner(PreconditionerType type) {
+    if(_prepared) {
+        throw RuntimeError("ConjugateGradientCovariance::setPreconditioner: matrix is already in use.");
+    }
+    if(_multiplyFunction) {
+        if(type == IncompleteCholeskyPreconditioner ||
+        (type == DiagonalPreconditioner && _diagonal.empty())) {
+            throw RuntimeError("ConjugateGradientCovariance::setPreconditioner: not available.");
+        }
+    }
+    _preconditioner = type;
+}
+
+void local::ConjugateGradientCovariance::setConvergence(double tolerance, int maxIterations) {
+    if(tolerance <= 0 || maxIterations < 0) {
+        throw RuntimeError("ConjugateGradientCovariance::setConvergence: invalid parameters.");
+    }
+    _tolerance = tolerance;
+    _maxIterations = maxIterations;
+}
+
+void local::ConjugateGradientCovariance::setWarmStart(bool warmStart) {
+    _warmStart = warmStart;
+    cg::Lock lock(_mutex);
+    if(!_warmStart) std::vector<double>().swap(_lastSolution);
+}
+
+int local::ConjugateGradientCovariance::getLastIterations() const {
+    cg::Lock lock(_mutex);
+    return _lastIterations;
+}
+
+void local::ConjugateGradientCovariance::_prepare() const {
+    if(_prepared) return;
+    if(!_multiplyFunction) {
+        // Pack our sparse matrix elements in compressed column format. Build the packed
+        // arrays separately so that we are unchanged if this fails.
+        std::vector<int> columnStart, rowIndex;
+        std::vector<double> values, diagonal(_size);
+        columnStart.reserve(_size+1);
+        columnStart.push_back(0);
+        for(int col = 0; col < _size; ++col) {
+            std::map<int,double> const &column(_elements[col]);
+            if(0 == column.count(col)) {
+                throw RuntimeError("ConjugateGradientCovariance: missing diagonal element.");
+            }
+            for(std::map<int,double>::const_iterator iter = column.begin(); iter != column.end(); ++iter) {
+                rowIndex.push_back(iter->first);
+                values.push_back(iter->second);
+            }
+            columnStart.push_back(rowIndex.size());
+            diagonal[col] = values.back();
+        }
+        _columnStart.swap(columnStart);
+        _rowIndex.swap(rowIndex);
+        _values.swap(values);
+        _diagonal.swap(diagonal);
+        // Release the memory used to build our sparse matrix.
+        std::vector<std::map<int,double> >().swap(_elements);
+        if(_preconditioner == IncompleteCholeskyPreconditioner && !_decompose()) {
+            std::vector<double>().swap(_cholesky);
+            _preconditioner = DiagonalPreconditioner;
+        }
+    }
+    _prepared = true;
+}
+
+bool local::ConjugateGradientCovariance::_decompose() const {
+    // Calculate U with the same sparsity as the upper triangle of A such that A ~ U*.U,
+    // one column at a time using
+    //
+    //   U[i,j] = (A[i,j] - Sum[U[k,i] U[k,j],{k,0,i-1}])/U[i,i]
+    //   U[j,j] = sqrt(A[j,j] - Sum[U[k,j]^2,{k,0,j-1}])
+    //
+    // where the sums only include elements present in both sparse columns.
+    _cholesky.resize(_values.size());
+    for(int col = 0; col < _size; ++col) {
+        int first(_columnStart[col]), last(_columnStart[col+1]);
+        for(int pos = first; pos < last; ++pos) {
+            int row(_rowIndex[pos]);
+            double sum(_values[pos]);
+            // Merge the sparse columns row and col of U for k < row.
+            int kr(_columnStart[row]), kc(first);
+            while(kr < _columnStart[row+1] && kc < pos) {
+                if(_rowIndex[kr] < _rowIndex[kc]) ++kr;
+                else if(_rowIndex[kr] > _rowIndex[kc]) ++kc;
+                else sum -= _cholesky[kr++]*_cholesky[kc++];
+            }
+            if(row < col) {
+                _cholesky[pos] = sum/_cholesky[_columnStart[row+1]-1];
+            }
+            else {
+                if(sum <= 0) return false;
+                _cholesky[pos] = std::sqrt(sum);
+            }
+        }
+    }
+    return true;
+}
+
+void local::ConjugateGradientCovariance::_multiply(std::vector<double> const &vector,
+std::vector<double> &result) const {
+    if(_multiplyFunction) {
+        _multiplyFunction(vector,result);
+        if(result.size() != _size) {
+            throw RuntimeError("ConjugateGradientCovariance: multiply result has wrong size.");
+        }
+        return;
+    }
+    result.assign(_size,0);
+    for(int col = 0; col < _size; ++col) {
+        double sum(0), xcol(vector[col]);
+        int last(_columnStart[col+1]-1);
+        for(int pos = _columnStart[col]; pos < last; ++pos) {
+            int row(_rowIndex[pos]);
+            sum += _values[pos]*vector[row];
+            result[row] += _values[pos]*xcol;
+        }
+        result[col] += sum + _values[last]*xcol;
+    }
+}
+
+void local::ConjugateGradientCovariance::_precondition(std::vector<double> &vector) const {
+    if(_preconditioner == DiagonalPreconditioner) {
+        for(int index = 0; index < _size; ++index) vector[index] /= _diagonal[index];
+    }
+    else if(_preconditioner == IncompleteCholeskyPreconditioner) {
+        // Solve U*.y = vector by forward substitution.
+        for(int col = 0; col < _size; ++col) {
+            int last(_columnStart[col+1]-1);
+            double sum(vector[col]);
+            for(int pos = _columnStart[col]; pos < last; ++pos) {
+                sum -= _cholesky[pos]*vector[_rowIndex[pos]];
+            }
+            vector[col] = sum/_cholesky[last];
+        }
+        // Solve U.z = y by back substitution.
+        for(int col = _size-1; col >= 0; --col) {
+            int last(_columnStart[col+1]-1);
+            double z(vector[col] /= _cholesky[last]);
+            for(int pos = _columnStart[col]; pos < last; ++pos) {
+                vector[_rowIndex[pos]] -= _cholesky[pos]*z;
+            }
+        }
+    }
+}
+
+void local::ConjugateGradientCovariance::_solve(std::vector<double> const &rhs,
+std::vector<double> &solution) const {
+    if(rhs.size() != _size) {
+        throw RuntimeError("ConjugateGradientCovariance: vector has wrong size.");
+    }
+    {
+        cg::Lock lock(_mutex);
+        _prepare();
+        if(_warmStart && _lastSolution.size() == _size) solution = _lastSolution;
+        else solution.assign(_size,0);
+    }
+    double rhsNorm(std::sqrt(cg::dot(rhs,rhs)));
+    if(0 == rhsNorm) {
+        solution.assign(_size,0);
+        return;
+    }
+    // Calculate the initial residual r = rhs - A.solution.
+    std::vector<double> residual, product;
+    _multiply(solution,product);
+    residual = rhs;
+    for(int index = 0; index < _size; ++index) residual[index] -= product[index];
+    std::vector<double> precond(residual), direction;
+    _precondition(precond);
+    direction = precond;
+    double rz(cg::dot(residual,precond)), threshold(_tolerance*rhsNorm);
+    int maxIterations(_maxIterations > 0 ? _maxIterations : 10*_size), iteration(0);
+    while(std::sqrt(cg::dot(residual,residual)) > threshold) {
+        if(iteration++ == maxIterations) {
+            throw RuntimeError("ConjugateGradientCovariance: solve did not converge.");
+        }
+        _multiply(direction,product);
+        double curvature(cg::dot(direction,product));
+        if(curvature <= 0) {
+            throw RuntimeError("ConjugateGradientCovariance: matrix is not positive definite.");
+        }
+        double alpha(rz/curvature);
+        for(int index = 0; index < _size; ++index) {
+            solution[index] += alpha*direction[index];
+            residual[index] -= alpha*product[index];
+        }
+        precond = residual;
+        _precondition(precond);
+        double rzNext(cg::dot(residual,precond)), beta(rzNext/rz);
+        rz = rzNext;
+        for(int index = 0; index < _size; ++index) {
+            direction[index] = precond[index] + beta*direction[index];
+        }
+    }
+    cg::Lock lock(_mutex);
+    if(_warmStart) _lastSolution = solution;
+    _lastIterations = iteration;
+}
+
+void local::ConjugateGradientCovariance::multiplyByCovariance(std::vector<double> &vector) const {
+    std::vector<double> result;
+    if(_isInverse) {
+        _solve(vector,result);
+    }
+    else {
+        if(vector.size() != _size) {
+            throw RuntimeError("ConjugateGradientCovariance::multiplyByCovariance: vector has wrong size.");
+        }
+        { cg::Lock lock(_mutex); _prepare(); }
+        _multiply(vector,result);
+    }
+    vector.swap(result);
+}
+
+void local::ConjugateGradientCovariance::multiplyByInverseCovariance(std::vector<double> &vector) const {
+    std::vector<double> result;
+    if(_isInverse) {
+        if(vector.size() != _size) {
+            throw RuntimeError("ConjugateGradientCovariance::multiplyByInverseCovariance: vector has wrong size.");
+        }
+        { cg::Lock lock(_mutex); _prepare(); }
+        _multiply(vector,result);
+    }
+    else {
+        _solve(vector,result);
+    }
+    vector.swap(result);
+}
+
+double local::ConjugateGradientCovariance::chiSquare(std::vector<double> const &delta) const {
+    std::vector<double> weighted;
+    return chiSquare(delta,weighted);
+}
+
+double local::ConjugateGradientCovariance::chiSquare(std::vector<double> const &delta,
+std::vector<double> &icovDelta) const {
+    icovDelta = delta;
+    multiplyByInverseCovariance(icovDelta);
+    return cg::dot(delta,icovDelta);
+}
@@ -0,0 +1,116 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_CONJUGATE_GRADIENT_COVARIANCE
+#define LIKELY_CONJUGATE_GRADIENT_COVARIANCE
+
+#include "likely/types.h"
+
+#include "boost/function.hpp"
+#include "boost/utility.hpp"
+
+#include <vector>
+#include <map>
+
+#include <pthread.h>
+
+namespace likely {
+    // Represents a covariance matrix that is only known implicitly, either as a sparse
+    // symmetric matrix or as an operator that multiplies a vector by the matrix, where the
+    // matrix can be either the covariance C or its inverse Cinv. Operations that require
+    // solving a linear system with the matrix are implemented with preconditioned conjugate
+    // gradients (PCG), so that a dense factorization is never needed. Each solve starts
+    // from the solution of the previous solve (a "warm start"), which reduces the number
+    // of iterations needed when successive residual vectors are nearly identical, as they
+    // are during a fit. All const methods are safe to call from multiple threads.
+	class ConjugateGradientCovariance : boost::noncopyable {
+	public:
+	    // Calculates result = A.vector where A is the matrix represented by this object.
+	    typedef boost::function<void (std::vector<double> const &vector,
+	        std::vector<double> &result)> MultiplyFunction;
+	    // Identifies the preconditioner used to accelerate conjugate gradient solves.
+	    enum PreconditionerType { NoPreconditioner, DiagonalPreconditioner,
+	        IncompleteCholeskyPreconditioner };
+	    // Creates a new sparse symmetric matrix of the specified size whose elements are all
+	    // zero. Use isInverse = true if the elements set via setElement() are those of Cinv
+	    // rather than C. The default preconditioner is an incomplete Cholesky decomposition
+	    // with no fill in, IC(0).
+		ConjugateGradientCovariance(int size, bool isInverse);
+		// Creates a new matrix of the specified size represented by the specified multiply
+		// function. Use isInverse = true if the multiply function calculates Cinv.vector rather
+		// than C.vector. If a diagonal is provided, it is used for a diagonal (Jacobi)
+		// preconditioner. Otherwise, no preconditioner is used.
+		ConjugateGradientCovariance(int size, MultiplyFunction multiply, bool isInverse,
+		    std::vector<double> const &diagonal = std::vector<double>());
+		virtual ~ConjugateGradientCovariance();
+		// Returns the size of this matrix.
+        int getSize() const;
+        // Returns true if this object represents Cinv rather than C.
+        bool isInverse() const;
+        // Sets the value of the symmetric matrix element (row,col) of a sparse matrix. Throws a
+        // RuntimeError if this object was created with a multiply function, or if any of our
+        // const methods below has already been called.
+        void setElement(int row, int col, double value);
+        // Selects the preconditioner to use. Throws a RuntimeError if an incomplete Cholesky
+        // preconditioner is requested for a matrix represented by a multiply function, or a
+        // diagonal preconditioner for a multiply function without any diagonal provided, or if
+        // any of our const methods below has already been called. An incomplete Cholesky
+        // decomposition that breaks down (with a non-positive pivot) falls back to a diagonal
+        // preconditioner.
+        void setPreconditioner(PreconditionerType type);
+        // Sets the convergence criteria for conjugate gradient solves A.x = b, which stop
+        // when |b - A.x| <= tolerance*|b|, or else throw a RuntimeError after maxIterations.
+        // Use maxIterations = 0 (the default) to allow up to 10*getSize() iterations, since
+        // rounding errors slow the convergence for badly conditioned matrices.
+        void setConvergence(double tolerance, int maxIterations = 0);
+        // Enables or disables warm starts, which are enabled by default. Disabling warm starts
+        // also forgets any previous solution.
+        void setWarmStart(bool warmStart);
+        // Multiplies the specified vector by the (inverse) covariance or throws a RuntimeError.
+        // The result is stored in the input vector, overwriting its original contents.
+        void multiplyByCovariance(std::vector<double> &vector) const;
+        void multiplyByInverseCovariance(std::vector<double> &vector) const;
+        // Calculates the chi-square = delta.Cinv.delta for the specified residuals vector delta
+        // or throws a RuntimeError.
+        double chiSquare(std::vector<double> const &delta) const;
+        // Calculates the same chi-square and also fills icovDelta with the Cinv.delta
+        // solution used to calculate it.
+        double chiSquare(std::vector<double> const &delta, std::vector<double> &icovDelta) const;
+        // Returns the number of conjugate gradient iterations used by the most recent solve.
+        int getLastIterations() const;
+	private:
+	    // Prepares our sparse matrix storage and preconditioner, if this has not already been
+	    // done. Must be called with our mutex held.
+	    void _prepare() const;
+	    // Calculates result = A.vector.
+	    void _multiply(std::vector<double> const &vector, std::vector<double> &result) const;
+	    // Replaces vector with Minv.vector where M is our preconditioner.
+	    void _precondition(std::vector<double> &vector) const;
+	    // Solves A.solution = rhs using preconditioned conjugate gradients.
+	    void _solve(std::vector<double> const &rhs, std::vector<double> &solution) const;
+	    // Calculates the incomplete Cholesky decomposition of our sparse matrix, or returns
+	    // false if it breaks down.
+	    bool _decompose() const;
+        int _size, _maxIterations;
+        bool _isInverse, _warmStart;
+        double _tolerance;
+        MultiplyFunction _multiplyFunction;
+        mutable PreconditionerType _preconditioner;
+        // The upper triangle (row <= col) of a sparse matrix, indexed by column then row.
+        mutable std::vector<std::map<int,double> > _elements;
+        // The upper triangle of a sparse matrix in compressed column format, with rows in
+        // increasing order within each column so that the diagonal is the last element of
+        // each column. Our incomplete Cholesky decomposition uses the same format.
+        mutable std::vector<int> _columnStart, _rowIndex;
+        mutable std::vector<double> _values, _cholesky;
+        mutable std::vector<double> _diagonal, _lastSolution;
+        mutable int _lastIterations;
+        mutable bool _prepared;
+        mutable pthread_mutex_t _mutex;
+	}; // ConjugateGradientCovariance
+
+    inline int ConjugateGradientCovariance::getSize() const { return _size; }
+    inline bool ConjugateGradientCovariance::isInverse() const { return _isInverse; }
+
+} // likely
+
+#endif // LIKELY_CONJUGATE_GRADIENT_COVARIANCE
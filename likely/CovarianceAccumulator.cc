@@ -4,13 +4,14 @@
 #include "likely/RuntimeError.h"
 #include "likely/CovarianceMatrix.h"
 #include "likely/BinnedData.h"
+#include "likely/AlignedAllocator.h"
+#include "likely/TextWriter.h"
 
 #include "boost/accumulators/accumulators.hpp"
 #include "boost/accumulators/statistics/weighted_covariance.hpp"
 #include "boost/accumulators/statistics/stats.hpp"
 #include "boost/accumulators/statistics/count.hpp"
 #include "boost/accumulators/statistics/variates/covariate.hpp"
-#include "boost/lexical_cast.hpp"
 
 #include <iostream>
 
@@ -18,13 +19,14 @@ using namespace boost::accumulators;
 
 typedef accumulator_set<double, stats<
     tag::weighted_covariance<double, tag::covariate1> >, double > Accumulator;
-typedef std::vector<Accumulator> Accumulators;
+// There is one accumulator per packed matrix element, so use huge pages for large sizes.
+typedef std::vector<Accumulator,likely::AlignedAllocator<Accumulator> > Accumulators;
 
 namespace local = likely;
 
 namespace likely {
     struct CovarianceAccumulator::Implementation {
-        std::vector<Accumulator> accumulators;
+        Accumulators accumulators;
     }; // CovarianceAccumulator::Implementation
 } // likely::
 
@@ -34,7 +36,7 @@ local::CovarianceAccumulator::CovarianceAccumulator(int size)
     if(size <= 0) {
         throw RuntimeError("CovarianceAccumulator: expected size > 0.");
     }
-    _pimpl->accumulators.resize((size*(size+1))/2);
+    _pimpl->accumulators.resize(symmetricMatrixElements(size));
 }
 
 local::CovarianceAccumulator::~CovarianceAccumulator() { }
@@ -47,7 +49,7 @@ void local::CovarianceAccumulator::accumulate(std::vector<double> const &vector,
 }
 
 void local::CovarianceAccumulator::accumulate(double const *vector, double wgt) {
-    int index(0);
+    Index index(0);
     for(int i = 0; i < _size; ++i) {
         double xi(vector[i]);
         for(int j = 0; j <= i; ++j) {
@@ -60,7 +62,7 @@ void local::CovarianceAccumulator::accumulate(BinnedDataCPtr data, double wgt) {
     if(data->getNBinsWithData() != _size) {
         throw RuntimeError("CovarianceAccumulator::accumulate: invalid data size.");
     }
-    int index(0);
+    Index index(0);
     bool weighted(false);
     for(BinnedData::IndexIterator row = data->begin(); row != data->end(); ++row) {
         double xi(data->getData(*row,weighted));
@@ -76,7 +78,7 @@ int local::CovarianceAccumulator::count() const {
 
 local::CovarianceMatrixPtr local::CovarianceAccumulator::getCovariance() const {
     CovarianceMatrixPtr cov(new CovarianceMatrix(_size));
-    int index(0);
+    Index index(0);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row <= col; ++row) {
             double value(weighted_covariance(_pimpl->accumulators[index++]));
@@ -86,26 +88,26 @@ local::CovarianceMatrixPtr local::CovarianceAccumulator::getCovariance() const {
     return cov;
 }
 
-void local::CovarianceAccumulator::dump(std::ostream &out) const {
+void local::CovarianceAccumulator::dump(std::ostream &os) const {
+    // TextWriter formats doubles with full precision, exactly like lexical_cast.
+    TextWriter out(os);
     // matrix dimension
-    out << _size << std::endl;
+    out << _size << '\n';
     // number of samples accumulated
-    out << count() << std::endl;
-    // total weight of accumulated samples (use lexical_cast to get full precision)
-    out << boost::lexical_cast<std::string>(
-        sum_of_weights(_pimpl->accumulators[0])) << std::endl;
+    out << count() << '\n';
+    // total weight of accumulated samples
+    out << sum_of_weights(_pimpl->accumulators[0]) << '\n';
     // weighted means
     for(int col = 0; col < _size; ++col) {
-        int index = symmetricMatrixIndex(col,col,_size);
-        out << col << ' ' << boost::lexical_cast<std::string>(
-            weighted_mean(_pimpl->accumulators[index])) << std::endl;
+        Index index = symmetricMatrixIndex(col,col,_size);
+        out << col << ' ' << weighted_mean(_pimpl->accumulators[index]) << '\n';
     }
     // weighted second moments
-    int index(0);
+    Index index(0);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row <= col; ++row) {
-            out << row << ' ' << col << ' ' << boost::lexical_cast<std::string>(
-                weighted_covariance(_pimpl->accumulators[index++])) << std::endl;
+            out << row << ' ' << col << ' '
+                << weighted_covariance(_pimpl->accumulators[index++]) << '\n';
         }
     }
 }
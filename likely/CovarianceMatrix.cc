@@ -1,14 +1,19 @@
 // Created 17-Apr-2012 by David Kirkby (University of California, Irvine) <dkirkby@uci.edu>
 
 #include "likely/CovarianceMatrix.h"
+#include "likely/TiledCholesky.h"
+#include "likely/PackedKernels.h"
 #include "likely/RuntimeError.h"
 #include "likely/Random.h"
+#include "likely/ThreadPool.h"
 
 #include "boost/format.hpp"
 #include "boost/lexical_cast.hpp"
 #include "boost/smart_ptr.hpp"
+#include "boost/bind.hpp"
 
 #include <cassert>
+#include <limits>
 #include <cmath>
 #include <iostream>
 
@@ -18,9 +23,6 @@ extern "C" {
     void dpptrf_(char const *uplo, int const *n, double *ap, int *info);
     // http://www.netlib.org/lapack/double/dpptri.f
     void dpptri_(char const *uplo, int const *n, double *ap, int *info);
-    // http://netlib.org/blas/dspmv.f
-    void dspmv_(char const *uplo, int const *n, double const *alpha, double const *ap,
-        double const *x, int const *incx, double const *beta, double *y, int const *incy);
     // http://www.netlib.org/blas/dtrmm.f
     void dtrmm_(char const *side, char const *uplo, char const *transa, const char *diag,
         int const *m, int const *n, double const *alpha, double const *a, int const *lda,
@@ -29,6 +31,10 @@ extern "C" {
     void dsyrk_(char const *uplo, char const *trans, int const *n, int const *k,
         double const *alpha, double const *a, int const *lda, double const *beta,
         double *c, int const *ldc);
+    // http://www.netlib.org/blas/dgemv.f
+    void dgemv_(char const *trans, int const *m, int const *n, double const *alpha,
+        double const *a, int const *lda, double const *x, int const *incx, double const *beta,
+        double *y, int const *incy);
     // http://www.netlib.org/lapack/double/dspevd.f
     void dspevd_(char const *jobz, char const *uplo, int const *n, double *ap, double *w,
         double *z, int const *ldz, double *work, int const *lwork, int *iwork,
@@ -43,7 +49,7 @@ local::CovarianceMatrix::CovarianceMatrix(int size)
     if(size <= 0) {
         throw RuntimeError("CovarianceMatrix: expected size > 0.");
     }
-    _ncov = (_size*(_size+1))/2;
+    _ncov = symmetricMatrixElements(_size);
     // We don't actually allocate any memory at this point. Wait until this is actually
     // necessary, and we know wether to allocate _cov or _icov.
 }
@@ -57,7 +63,7 @@ local::CovarianceMatrix::CovarianceMatrix(std::vector<double> packed)
     _size = symmetricMatrixSize(_ncov);
     // Copy elements from the input array to our internal storage now. The first
     // call to setCovariance triggers the allocation of our internal storage.
-    int index(0);
+    Index index(0);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row <= col; ++row) {
             setCovariance(row,col,packed[index++]);
@@ -82,14 +88,20 @@ void local::swap(CovarianceMatrix& a, CovarianceMatrix& b) {
     swap(a._cov,b._cov);
     swap(a._icov,b._icov);
     swap(a._cholesky,b._cholesky);
+    swap(a._icovReplicas,b._icovReplicas);
+    swap(a._whitened,b._whitened);
     swap(a._diag,b._diag);
     swap(a._offdiagIndex,b._offdiagIndex);
     swap(a._offdiagValue,b._offdiagValue);
 }
 
 size_t local::CovarianceMatrix::getMemoryUsage() const {
+    std::size_t replicas(0);
+    for(int node = 0; node < _icovReplicas.size(); ++node) {
+        if(_icovReplicas[node]) replicas += _icovReplicas[node]->capacity();
+    }
     return sizeof(*this) + sizeof(double)*(
-        _cov.capacity() + _icov.capacity() + _cholesky.capacity() +
+        _cov.capacity() + _icov.capacity() + _cholesky.capacity() + replicas +
         _diag.capacity() + _offdiagIndex.capacity() + _offdiagValue.capacity());
 }
 
@@ -105,6 +117,12 @@ char local::CovarianceMatrix::_tag(char symbol, std::vector<double> const &vecto
     return symbol;
 }
 
+char local::CovarianceMatrix::_tag(char symbol, AlignedVector const &vector) const {
+    if(0 == vector.capacity()) return '-';
+    if(0 == vector.size()) return std::tolower(symbol);
+    return symbol;
+}
+
 bool local::CovarianceMatrix::compress() const {
     // Are we already compressed?
     if(_compressed) return false;
@@ -115,7 +133,7 @@ bool local::CovarianceMatrix::compress() const {
         // Prepare to read the inverse covariance and check if anything been allocated yet.
         if(!_readsICov()) return false;
         // Loop over the upper-diagonal (row <= col) inverse matrix elements.
-        int index(0);
+        Index index(0);
         double value;
         for(int col = 0; col < _size; ++col) {
             for(int row = 0; row < col; ++row) {
@@ -130,9 +148,10 @@ bool local::CovarianceMatrix::compress() const {
         }
     }
     // Delete anything we don't need now.
-    if(!_cov.empty()) std::vector<double>().swap(_cov);
-    if(!_icov.empty()) std::vector<double>().swap(_icov);
-    if(!_cholesky.empty()) std::vector<double>().swap(_cholesky);
+    _icovReplicas.clear();
+    if(!_cov.empty()) AlignedVector().swap(_cov);
+    if(!_icov.empty()) AlignedVector().swap(_icov);
+    if(!_cholesky.empty()) AlignedVector().swap(_cholesky);
     _compressed = true;
     return true;
 }
@@ -144,124 +163,216 @@ void local::CovarianceMatrix::_uncompress() const {
     assert(0 == _icov.capacity());
     assert(0 == _cholesky.capacity());
     // Decompress the inverse covariance matrix.
-    std::vector<double>(_ncov,0).swap(_icov);
+    AlignedVector(_ncov,0).swap(_icov);
     for(int k = 0; k < _offdiagIndex.size(); ++k) {
         _icov[_offdiagIndex[k]] = _offdiagValue[k];
     }
     for(int k = 0; k < _size; ++k) {
-        _icov[(k*(k+3))/2] = _diag[k];
+        _icov[((Index)k*(k+3))/2] = _diag[k];
     }
     // Don't delete the compressed matrix data in case we can re-use it
     // because no changes are made before the next call to compress().
     _compressed = false;
 }
 
-int local::symmetricMatrixIndex(int row, int col, int size) {
+local::Index local::symmetricMatrixIndex(int row, int col, int size) {
     if(row < 0 || col < 0 || row >= size || col >= size) {
         throw RuntimeError("symmetricMatrixIndex: row or col out of range.");
     }
     // Ensure that row <= col
     if(row > col) std::swap(row,col);
-    return row+(col*(col+1))/2;
+    return row+((Index)col*(col+1))/2;
 }
 
-int local::symmetricMatrixSize(int nelem) {
-    int size = std::floor(std::sqrt(8*nelem+1)/2);
-    if(nelem != (size*(size+1))/2) {
+local::Index local::symmetricMatrixElements(int size) {
+    if(size < 0) {
+        throw RuntimeError("symmetricMatrixElements: expected size >= 0.");
+    }
+    Index n(size);
+    if(n > 0 && n+1 > std::numeric_limits<Index>::max()/n) {
+        throw RuntimeError("symmetricMatrixElements: number of elements overflows.");
+    }
+    return (n*(n+1))/2;
+}
+
+int local::symmetricMatrixSize(Index nelem) {
+    double root(nelem < 0 ? -1 : std::floor(std::sqrt(8*(double)nelem+1)/2));
+    if(root < 0 || root > std::numeric_limits<int>::max()) {
+        throw RuntimeError("symmetricMatrixSize: invalid number of elements.");
+    }
+    int size(root);
+    if(nelem != symmetricMatrixElements(size)) {
         throw RuntimeError("symmetricMatrixSize: invalid number of elements.");
     }
     return size;
 }
 
-double local::choleskyDecompose(std::vector<double> &matrix, int size) {
-    static char uplo('U');
-    static int info(0);
-    if(0 == size) size = symmetricMatrixSize(matrix.size());
-    dpptrf_(&uplo,&size,&matrix[0],&info);
-    if(0 != info) {
-        info = 0;
-        throw RuntimeError("choleskyDecomposition: matrix is not positive definite.");
+namespace likely {
+namespace covariance {
+    // Implement the packed matrix functions declared in CovarianceMatrix.h for both
+    // std::vector and AlignedVector storage.
+    template <class Vector> double choleskyDecompose(Vector &matrix, int size) {
+        static char uplo('U');
+        static int info(0);
+        if(0 == size) size = symmetricMatrixSize(matrix.size());
+        if(useTiledCholesky(size)) return tiledCholeskyDecompose(matrix,size);
+        dpptrf_(&uplo,&size,&matrix[0],&info);
+        if(0 != info) {
+            info = 0;
+            throw RuntimeError("choleskyDecomposition: matrix is not positive definite.");
+        }
+        // Calculate and the product of diagonal Cholesky matrix elements squared.
+        double logdet(0);
+        for(int index = 0; index < size; ++index) {
+            logdet += 2*std::log(matrix[symmetricMatrixIndex(index,index,size)]);
+        }
+        return logdet;
+    }
+    template <class Vector> void invertCholesky(Vector &matrix, int size) {
+        static char uplo('U');
+        static int info(0);
+        if(0 == size) size = symmetricMatrixSize(matrix.size());
+        if(useTiledCholesky(size)) {
+            tiledInvertCholesky(matrix,size);
+            return;
+        }
+        dpptri_(&uplo,&size,&matrix[0],&info);
+        if(0 != info) {
+            info = 0;
+            throw RuntimeError("invertCholesky: symmetric matrix inversion failed.");
+        }
+    }
+    template <class Vector> void matrixSquare(std::vector<double> const &matrix, Vector &result,
+    bool transposeLeft, int size) {
+        static char uplo('U');
+        static int info(0);
+        static double alpha(1),beta(0);
+        // Calculate the matrix size, if necessary.
+        if(0 == size) size = symmetricMatrixSize(matrix.size());
+        // Calculate Mt.M or M.Mt ?
+        char trans = transposeLeft ? 'T' : 'N';
+        boost::shared_array<double> unpackedResult(new double [(std::size_t)size*size]);
+        dsyrk_(&uplo,&trans,&size,&size,&alpha,&matrix[0],&size,&beta,unpackedResult.get(),&size);
+        // Pack the result back into 'U' format.
+        result.resize(0);
+        result.reserve(symmetricMatrixElements(size));
+        for(int col = 0; col < size; ++col) {
+            std::size_t base((std::size_t)col*size);
+            for(int row = 0; row <= col; ++row) {
+                result.push_back(unpackedResult[base++]);
+            }
+        }
+    }
+    template <class Matrix, class Vector> void symmetricMatrixMultiply(Matrix const &matrix,
+    Vector const &vector, Vector &result) {
+        int size(vector.size());
+        if((Index)matrix.size() != symmetricMatrixElements(size)) {
+            throw RuntimeError("symmetricMatrixMultiply: incompatible matrix and vector sizes.");
+        }
+        // size result correctly (but do not need to zero elements since they are all overwritten)
+        Vector(size).swap(result);
+        if(0 == size) return;
+        packedSymmetricMultiply(&matrix[0],&vector[0],&result[0],size);
     }
-    // Calculate and the product of diagonal Cholesky matrix elements squared.
-    double logdet(0);
-    for(int index = 0; index < size; ++index) {
-        logdet += 2*std::log(matrix[symmetricMatrixIndex(index,index,size)]);
+    template <class Matrix> void symmetricMatrixEigenSolve(Matrix const &matrix,
+    std::vector<double> &eigenvalues, std::vector<double> &eigenvectors, int size) {
+        static char jobz('V'), uplo('U');
+        static int info(0);
+        // Calculate the matrix size if it was not provided.
+        if(0 == size) size = symmetricMatrixSize(matrix.size());
+        // Allocate space for the eigenvalues and vectors.
+        eigenvalues.resize(size), eigenvectors.resize((std::size_t)size*size);
+        {
+            // copy the input matrix since the algorithm overwrites it
+            Matrix matrixCopy(matrix);
+            // allocate temporory workspaces
+            // LAPACK workspace sizes must fit in an int.
+            if(1+6*(std::size_t)size+(std::size_t)size*size > std::numeric_limits<int>::max()) {
+                throw RuntimeError("symmetricMatrixEigenSolve: matrix is too large.");
+            }
+            int workSize(1+6*size+size*size), iworkSize(3+5*size);
+            boost::scoped_array<double> work(new double[workSize]);
+            boost::scoped_array<int> iwork(new int[iworkSize]);
+            dspevd_(&jobz,&uplo,&size,&matrixCopy[0],&eigenvalues[0],&eigenvectors[0],&size,
+                &work[0],&workSize,&iwork[0],&iworkSize,&info);
+            if(0 != info) {
+                throw RuntimeError("symmetricMatrixEigenSolve: failed with info = " +
+                    boost::lexical_cast<std::string>(info));
+                info = 0;
+            }
+            // cleanup temporary storage by closing this scope
+        }
     }
-    return logdet;
+}} // likely::covariance
+
+double local::choleskyDecompose(std::vector<double> &matrix, int size) {
+    return covariance::choleskyDecompose(matrix,size);
+}
+
+double local::choleskyDecompose(AlignedVector &matrix, int size) {
+    return covariance::choleskyDecompose(matrix,size);
 }
 
 void local::invertCholesky(std::vector<double> &matrix, int size) {
-    static char uplo('U');
-    static int info(0);
-    if(0 == size) size = symmetricMatrixSize(matrix.size());
-    dpptri_(&uplo,&size,&matrix[0],&info);
-    if(0 != info) {
-        info = 0;
-        throw RuntimeError("invertCholesky: symmetric matrix inversion failed.");
-    }
-} 
+    covariance::invertCholesky(matrix,size);
+}
+
+void local::invertCholesky(AlignedVector &matrix, int size) {
+    covariance::invertCholesky(matrix,size);
+}
 
 void local::matrixSquare(std::vector<double> const &matrix, std::vector<double> &result,
 bool transposeLeft, int size) {
-    static char uplo('U');
-    static int info(0);
-    static double alpha(1),beta(0);
-    // Calculate the matrix size, if necessary.
-    if(0 == size) size = symmetricMatrixSize(matrix.size());
-    // Calculate Mt.M or M.Mt ?
-    char trans = transposeLeft ? 'T' : 'N';
-    boost::shared_array<double> unpackedResult(new double [size*size]);
-    dsyrk_(&uplo,&trans,&size,&size,&alpha,&matrix[0],&size,&beta,unpackedResult.get(),&size);
-    // Pack the result back into 'U' format.
-    result.resize(0);
-    result.reserve((size*(size+1))/2);
-    for(int col = 0; col < size; ++col) {
-        int base(col*size);
-        for(int row = 0; row <= col; ++row) {
-            result.push_back(unpackedResult[base++]);
-        }
-    }    
+    covariance::matrixSquare(matrix,result,transposeLeft,size);
+}
+
+void local::matrixSquare(std::vector<double> const &matrix, AlignedVector &result,
+bool transposeLeft, int size) {
+    covariance::matrixSquare(matrix,result,transposeLeft,size);
 }
 
 void local::symmetricMatrixMultiply(std::vector<double> const &matrix,
 std::vector<double> const &vector, std::vector<double> &result) {
-    static char uplo('U');
-    static int incr(1);
-    static double alpha(1),beta(0);
-    int size(vector.size());
-    if(matrix.size() != (size*(size+1))/2) {
-        throw RuntimeError("symmetricMatrixMultiply: incompatible matrix and vector sizes.");
-    }
-    // size result correctly (but do not need to zero elements since beta=0)
-    std::vector<double>(size).swap(result);
-    // See http://netlib.org/blas/dspmv.f
-    dspmv_(&uplo,&size,&alpha,&matrix[0],&vector[0],&incr,&beta,&result[0],&incr);
+    covariance::symmetricMatrixMultiply(matrix,vector,result);
+}
+
+void local::symmetricMatrixMultiply(AlignedVector const &matrix,
+std::vector<double> const &vector, std::vector<double> &result) {
+    covariance::symmetricMatrixMultiply(matrix,vector,result);
+}
+
+void local::symmetricMatrixMultiply(AlignedVector const &matrix,
+AlignedVector const &vector, AlignedVector &result) {
+    covariance::symmetricMatrixMultiply(matrix,vector,result);
 }
 
 void local::symmetricMatrixEigenSolve(std::vector<double> const &matrix,
 std::vector<double> &eigenvalues, std::vector<double> &eigenvectors, int size) {
-    static char jobz('V'), uplo('U');
-    static int info(0);
-    // Calculate the matrix size if it was not provided.
-    if(0 == size) size = symmetricMatrixSize(matrix.size());
-    // Allocate space for the eigenvalues and vectors.
-    eigenvalues.resize(size), eigenvectors.resize(size*size);
-    {
-        // copy the input matrix since the algorithm overwrites it
-        std::vector<double> matrixCopy(matrix);
-        // allocate temporory workspaces
-        int workSize(1+6*size+size*size), iworkSize(3+5*size);
-        boost::scoped_array<double> work(new double[workSize]);
-        boost::scoped_array<int> iwork(new int[iworkSize]);
-        dspevd_(&jobz,&uplo,&size,&matrixCopy[0],&eigenvalues[0],&eigenvectors[0],&size,
-            &work[0],&workSize,&iwork[0],&iworkSize,&info);
-        if(0 != info) {
-            throw RuntimeError("symmetricMatrixEigenSolve: failed with info = " +
-                boost::lexical_cast<std::string>(info));
-            info = 0;
-        }
-        // cleanup temporary storage by closing this scope
-    }   
+    covariance::symmetricMatrixEigenSolve(matrix,eigenvalues,eigenvectors,size);
+}
+
+void local::symmetricMatrixEigenSolve(AlignedVector const &matrix,
+std::vector<double> &eigenvalues, std::vector<double> &eigenvectors, int size) {
+    covariance::symmetricMatrixEigenSolve(matrix,eigenvalues,eigenvectors,size);
+}
+
+void local::addChiSquareGradient(std::vector<double> const &icovDelta,
+std::vector<double> const &jacobian, std::vector<double> &gradient, int offset) {
+    int nrow(icovDelta.size());
+    if(0 == nrow || jacobian.size() % nrow != 0) {
+        throw RuntimeError("addChiSquareGradient: jacobian has wrong size.");
+    }
+    int ncol(jacobian.size()/nrow);
+    if(offset < 0 || offset + ncol > gradient.size()) {
+        throw RuntimeError("addChiSquareGradient: gradient block out of range.");
+    }
+    if(0 == ncol) return;
+    // Calculate gradient[offset:] += 2*Jt.icovDelta
+    char trans('T');
+    int incr(1);
+    double alpha(2), beta(1);
+    dgemv_(&trans,&nrow,&ncol,&alpha,&jacobian[0],&nrow,&icovDelta[0],&incr,&beta,
+        &gradient[offset],&incr);
 }
 
 void local::CovarianceMatrix::prune(std::set<int> const &keep) {
@@ -279,8 +390,8 @@ void local::CovarianceMatrix::prune(std::set<int> const &keep) {
         std::set<int>::const_iterator nextOldRow(keep.begin());
         for(int newRow = 0; newRow <= newCol; ++newRow) {
             int oldRow = *nextOldRow++;
-            int newIndex = symmetricMatrixIndex(newRow, newCol, newSize);            
-            int oldIndex = symmetricMatrixIndex(oldRow, oldCol, getSize());
+            Index newIndex = symmetricMatrixIndex(newRow, newCol, newSize);
+            Index oldIndex = symmetricMatrixIndex(oldRow, oldCol, getSize());
 
             //std::cout << "prune: " << newCol << ',' << newRow << ' ' << oldCol << ',' << oldRow
             //    << ' ' << newIndex << ',' << oldIndex << std::endl;
@@ -290,7 +401,7 @@ void local::CovarianceMatrix::prune(std::set<int> const &keep) {
         }
     }
     _size = newSize;
-    _ncov = (newSize*(newSize+1))/2;
+    _ncov = symmetricMatrixElements(newSize);
     _cov.resize(_ncov);
 
     assert(0 == _icov.capacity());
@@ -302,8 +413,9 @@ void local::CovarianceMatrix::prune(std::set<int> const &keep) {
 
 void local::CovarianceMatrix::_changesCov() {
     _uncompress();
-    // Any cached determinant is now invalid.
+    // Any cached determinant and copies of the inverse are now invalid.
     _logDeterminant = 0;
+    _icovReplicas.clear();
     // Any cached compressed matrix data is now invalid so delete it.
     if(!_diag.empty()) {
         // TODO: use resize(0) instead?
@@ -316,7 +428,7 @@ void local::CovarianceMatrix::_changesCov() {
         // Have we allocated anything yet?
         if(_icov.empty()) {
             // Allocate a covariance matrix initialized to zero.
-            std::vector<double>(_ncov,0).swap(_cov);
+            AlignedVector(_ncov,0).swap(_cov);
         }
         else {
             // Try to invert the existing inverse covariance in place. This will throw a
@@ -328,13 +440,13 @@ void local::CovarianceMatrix::_changesCov() {
             _cov.swap(_icov);
             // Remove any existing Cholesky decomposition since it will become invalid.
             // TODO: use resize(0) instead here?
-            if(!_cholesky.empty()) std::vector<double>().swap(_cholesky);
+            if(!_cholesky.empty()) AlignedVector().swap(_cholesky);
         }
     }
     else {
         // Delete any inverse covariance and Cholesky decomposition.
-        if(!_icov.empty()) std::vector<double>().swap(_icov);
-        if(!_cholesky.empty()) std::vector<double>().swap(_cholesky);
+        if(!_icov.empty()) AlignedVector().swap(_icov);
+        if(!_cholesky.empty()) AlignedVector().swap(_cholesky);
     }
     assert(!_cov.empty());
     assert(0 == _icov.capacity());
@@ -343,8 +455,9 @@ void local::CovarianceMatrix::_changesCov() {
 
 void local::CovarianceMatrix::_changesICov() {
     _uncompress();
-    // Any cached determinant is now invalid.
+    // Any cached determinant and copies of the inverse are now invalid.
     _logDeterminant = 0;
+    _icovReplicas.clear();
     // Any cached compressed matrix data is now invalid so delete it.
     if(!_diag.empty()) {
         // TODO: use resize(0) instead?
@@ -357,7 +470,7 @@ void local::CovarianceMatrix::_changesICov() {
         // Have we allocated anything yet?
         if(_cov.empty()) {
             // Allocate an inverse covariance matrix initialized to zero.
-            std::vector<double>(_ncov,0).swap(_icov);
+            AlignedVector(_ncov,0).swap(_icov);
         }
         else {
             // Try to invert the existing covariance in place. This will throw a
@@ -377,14 +490,14 @@ void local::CovarianceMatrix::_changesICov() {
                 // Remove the existing _cholesky by swapping with _icov.
                 _icov.swap(_cholesky);
                 // Remove the existing _cov.
-                std::vector<double>().swap(_cov);
+                AlignedVector().swap(_cov);
             }
         }
     }
     else {
         // Delete and covariance and Cholesky decomposition.
-        if(!_cov.empty()) std::vector<double>().swap(_cov);
-        if(!_cholesky.empty()) std::vector<double>().swap(_cholesky);
+        if(!_cov.empty()) AlignedVector().swap(_cov);
+        if(!_cholesky.empty()) AlignedVector().swap(_cholesky);
     }
     assert(!_icov.empty());
     assert(0 == _cov.capacity());
@@ -453,7 +566,7 @@ void local::CovarianceMatrix::_readsCholesky() const {
 double local::CovarianceMatrix::getCovariance(int row, int col) const {
     // Calculate the index corresponding to (row,col). This will throw a RuntimeError
     // in case of an invalid address, before we go any further.
-    int index(symmetricMatrixIndex(row,col,_size));
+    Index index(symmetricMatrixIndex(row,col,_size));
     // Prepare to read from the covariance matrix, and return zero if nothing has
     // been allocated yet.
     if(!_readsCov()) return 0;
@@ -463,20 +576,45 @@ double local::CovarianceMatrix::getCovariance(int row, int col) const {
 double local::CovarianceMatrix::getInverseCovariance(int row, int col) const {
     // Calculate the index corresponding to (row,col). This will throw a RuntimeError
     // in case of an invalid address, before we go any further.
-    int index(symmetricMatrixIndex(row,col,_size));
+    Index index(symmetricMatrixIndex(row,col,_size));
     // Prepare to read from the inverse covariance matrix, and return zero if nothing has
     // been allocated yet.
     if(!_readsICov()) return 0;
     return _icov[index];
 }
 
+double const *local::CovarianceMatrix::getPackedInverseCovariance() const {
+    if(!_readsICov()) return 0;
+    return &_icov[0];
+}
+
+void local::CovarianceMatrix::addInverseCovarianceColumn(int col, double scale,
+std::vector<double> &vector) const {
+    if(col < 0 || col >= _size) {
+        throw RuntimeError("CovarianceMatrix::addInverseCovarianceColumn: invalid col.");
+    }
+    if(vector.size() != _size) {
+        throw RuntimeError("CovarianceMatrix::addInverseCovarianceColumn: vector has wrong size.");
+    }
+    if(!_readsICov() || 0 == scale) return;
+    // Elements with row <= col are stored contiguously in our packed matrix, and the
+    // remaining elements are found in the later columns at row index col.
+    double const *packed(&_icov[symmetricMatrixIndex(0,col,_size)]);
+    for(int row = 0; row <= col; ++row) vector[row] += scale*packed[row];
+    Index index(symmetricMatrixIndex(col,col,_size));
+    for(int row = col+1; row < _size; ++row) {
+        index += row;
+        vector[row] += scale*_icov[index];
+    }
+}
+
 local::CovarianceMatrix &local::CovarianceMatrix::setCovariance(int row, int col, double value) {
     if(row == col && value <= 0) {
         throw RuntimeError("CovarianceMatrix: diagonal elements must be > 0.");
     }
     // Calculate the index corresponding to (row,col). This will throw a RuntimeError
     // in case of an invalid address, before we actually change anything.
-    int index(symmetricMatrixIndex(row,col,_size));
+    Index index(symmetricMatrixIndex(row,col,_size));
     // Prepare to change the covariance matrix, which might throw a RuntimeError
     // if icov elements have already been set, but icov is not invertible.
     _changesCov();
@@ -492,7 +630,7 @@ local::CovarianceMatrix &local::CovarianceMatrix::setInverseCovariance(int row,
     }
     // Calculate the index corresponding to (row,col). This will throw a RuntimeError
     // in case of an invalid address, before we actually change anything.
-    int index(symmetricMatrixIndex(row,col,_size));
+    Index index(symmetricMatrixIndex(row,col,_size));
     // Prepare to change the inverse covariance matrix, which might throw a RuntimeError
     // if cov elements have already been set, but cov is not invertible.
     _changesICov();
@@ -516,14 +654,130 @@ void local::CovarianceMatrix::multiplyByInverseCovariance(std::vector<double> &v
     vector.swap(result);
 }
 
+void local::CovarianceMatrix::multiplyByCovariance(AlignedVector &vector) const {
+    _readsCov();
+    AlignedVector result;
+    symmetricMatrixMultiply(_cov,vector,result);
+    vector.swap(result);
+}
+
+void local::CovarianceMatrix::multiplyByInverseCovariance(AlignedVector &vector) const {
+    _readsICov();
+    AlignedVector result;
+    symmetricMatrixMultiply(_icov,vector,result);
+    vector.swap(result);
+}
+
+double const *local::CovarianceMatrix::_readsLocalICov(std::vector<double> const &delta) const {
+    if(delta.size() != _size) {
+        throw RuntimeError("CovarianceMatrix::chiSquare: delta has wrong size.");
+    }
+    if(!_readsICov()) {
+        throw RuntimeError("CovarianceMatrix::chiSquare: matrix is empty.");
+    }
+    // Use the copy of our packed inverse on this thread's NUMA node, if there is one.
+    if(!_icovReplicas.empty()) {
+        int node(getCurrentNumaNode());
+        if(node < _icovReplicas.size() && _icovReplicas[node]) return &(*_icovReplicas[node])[0];
+    }
+    return &_icov[0];
+}
+
 double local::CovarianceMatrix::chiSquare(std::vector<double> const &delta) const {
-    std::vector<double> icovDelta = delta;
-    multiplyByInverseCovariance(icovDelta);
-    double result(0);
-    for(int k = 0; k < delta.size(); ++k) {
-        result += delta[k]*icovDelta[k];
+    // Evaluate delta.Cinv.delta in a single pass through our packed inverse.
+    return packedQuadraticForm(_readsLocalICov(delta),&delta[0],_size);
+}
+
+double local::CovarianceMatrix::chiSquare(std::vector<double> const &delta,
+std::vector<double> &icovDelta) const {
+    double const *icov(_readsLocalICov(delta));
+    // Calculate Cinv.delta in a single pass, then the chi-square is an O(n) dot product.
+    icovDelta.resize(_size);
+    packedSymmetricMultiply(icov,&delta[0],&icovDelta[0],_size);
+    return vectorDotProduct(&delta[0],&icovDelta[0],_size);
+}
+
+namespace likely {
+namespace covariance {
+    // Copies a packed matrix, so that its pages are first touched by the calling thread.
+    void replicate(AlignedVector const *matrix, AlignedVector *replica) {
+        replica->assign(matrix->begin(),matrix->end());
+    }
+}} // likely::covariance
+
+void local::CovarianceMatrix::replicateInverseCovariance(ThreadPoolPtr pool) const {
+    if(!pool || !pool->isPinned()) {
+        throw RuntimeError("CovarianceMatrix::replicateInverseCovariance: expected pinned workers.");
+    }
+    if(!_readsICov()) {
+        throw RuntimeError("CovarianceMatrix::replicateInverseCovariance: matrix is empty.");
+    }
+    std::vector<boost::shared_ptr<AlignedVector> > replicas(getNumaNodeCount());
+    ThreadPool::TaskGroup group(*pool);
+    for(int worker = 0; worker < pool->getNThreads(); ++worker) {
+        int node(pool->getWorkerNode(worker));
+        if(replicas[node]) continue;
+        replicas[node].reset(new AlignedVector());
+        group.submit(boost::bind(covariance::replicate,&_icov,replicas[node].get()),worker);
+    }
+    group.wait();
+    _icovReplicas.swap(replicas);
+}
+
+int local::CovarianceMatrix::getNReplicas() const {
+    int count(0);
+    for(int node = 0; node < _icovReplicas.size(); ++node) {
+        if(_icovReplicas[node]) count++;
+    }
+    return count;
+}
+
+double local::CovarianceMatrix::chiSquareWithThreshold(std::vector<double> const &delta,
+double threshold) const {
+    if(delta.size() != _size) {
+        throw RuntimeError("CovarianceMatrix::chiSquareWithThreshold: delta has wrong size.");
+    }
+    // Solve L.z = delta for the whitened residuals z, where L is the lower-diagonal
+    // Cholesky decomposition of C, so that chi-square = z.z. Row i of L is stored
+    // contiguously in our packed _cholesky, so each element of z only needs the row
+    // of L and the elements of z already calculated.
+    _readsCholesky();
+    _whitened.resize(_size);
+    double *z(&_whitened[0]);
+    double const *row(&_cholesky[0]);
+    double chi2(0);
+    for(int i = 0; i < _size; ++i) {
+        double zi((delta[i] - vectorDotProduct(row,z,i))/row[i]);
+        z[i] = zi;
+        chi2 += zi*zi;
+        if(chi2 > threshold) break;
+        row += i+1;
+    }
+    return chi2;
+}
+
+void local::CovarianceMatrix::projectInverse(std::vector<double> const &matrix, int ncol,
+std::vector<double> &result) const {
+    if(ncol <= 0 || matrix.size() != (std::size_t)_size*ncol) {
+        throw RuntimeError("CovarianceMatrix::projectInverse: matrix has wrong size.");
+    }
+    // With C = U*.U, we have At.Cinv.A = Bt.B where B = Uinv*.A is the solution of U*.B = A.
+    // First, calculate the elements of U = _cholesky, if necessary, then solve for each
+    // column of B directly with the packed elements, so that we never need a dense copy.
+    _readsCholesky();
+    std::vector<double> B(matrix);
+    for(int col = 0; col < ncol; ++col) {
+        packedTriangularSolve(&_cholesky[0],&B[(std::size_t)col*_size],_size,true);
+    }
+    // Calculate the upper triangle of Bt.B using the BLAS DSYRK routine, then fill in
+    // the lower triangle.
+    result.resize(ncol*ncol);
+    char uplo = 'U', trans = 'T';
+    double alpha(1), beta(0);
+    dsyrk_(&uplo,&trans,&ncol,&_size,&alpha,&B[0],&_size,&beta,&result[0],&ncol);
+    for(int col = 0; col < ncol; ++col) {
+        for(int row = 0; row < col; ++row) result[row*ncol + col] = result[col*ncol + row];
     }
-    return result;
 }
 
 void local::CovarianceMatrix::getEigenModes(
@@ -547,7 +801,7 @@ std::vector<double> &chi2modes) const {
         // Calculate the dot product of eigenvector i with delta
         double dotprod(0);
         for(int j = 0; j < _size; ++j) {
-            dotprod += eigenvectors[i*_size + j]*delta[j];
+            dotprod += eigenvectors[(std::size_t)i*_size + j]*delta[j];
         }
         // Calculate and save the contribution to chi2 due to this eigenmode.
         double chi2i = dotprod*dotprod*eigenvalues[i];
@@ -577,7 +831,7 @@ void local::CovarianceMatrix::rescaleEigenvalues(std::vector<double> const &scal
     }
     // Next we replace X with S.X where S is a diagonal matrix of scaleFactors and X[j*size+i] is
     // the i-th element of the j-th eigenvector.
-    int index(0);
+    std::size_t index(0);
     // Loop over eigenvectors
     for(int j = 0; j < _size; ++j) {
         double scale = std::sqrt(eigenvalues[j]/scales[j]);
@@ -610,15 +864,9 @@ double local::CovarianceMatrix::sample(std::vector<double> &delta, RandomPtr ran
         nll += r*r;
     }
     _readsCholesky();
-    // Add correlations via L.delta
-    int index(0);
-    for(int i = 0; i < _size; ++i) {
-        double result(0);
-        for(int j = 0; j <= i; ++j) {
-            result += _cholesky[index++]*deltap[j];
-        }
-        delta.push_back(result);
-    }
+    // Add correlations via L.delta = U*.delta
+    delta.resize(_size);
+    packedTriangularMultiply(&_cholesky[0],&deltap[0],&delta[0],_size,true);
     return nll/2;
 }
 
@@ -626,6 +874,8 @@ void local::CovarianceMatrix::replaceWithTripleProduct(CovarianceMatrix const &o
     if(other.getSize() != _size) {
         throw RuntimeError("CovarianceMatrix::addInverse: incompatible sizes.");
     }
+    // Any copies of our inverse are now invalid.
+    _icovReplicas.clear();
     // Any cached compressed matrix data is now invalid so delete it.
     if(!_diag.empty()) {
         // TODO: use resize(0) instead?
@@ -642,28 +892,29 @@ void local::CovarianceMatrix::replaceWithTripleProduct(CovarianceMatrix const &o
     _readsCholesky();
     
     // Free up any _cov or _icov storage now, before we allocate new temporary storage.
-    if(!_cov.empty()) std::vector<double>().swap(_cov);
-    if(!_icov.empty()) std::vector<double>().swap(_icov);
+    if(!_cov.empty()) AlignedVector().swap(_cov);
+    if(!_icov.empty()) AlignedVector().swap(_icov);
 
     // Next, multiply U.Ainv using the BLAS DTRMM routine which is optimized for the
     // upper triangular form of U, but not optimized for the symmetry of Ainv.
     // DTRMM needs both matrices to be unpacked first. Do this in two separate loops
     // so we can free the _cholesky memory before allocating the second temporary array.
-    boost::shared_array<double> unpackedCholesky(new double [_size*_size]);
+    std::size_t sizeSq((std::size_t)_size*_size);
+    boost::shared_array<double> unpackedCholesky(new double [sizeSq]);
     double *choleskyPtr(&_cholesky[0]);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row <= col; ++row) {
-            unpackedCholesky[col*_size + row] = *choleskyPtr++;
+            unpackedCholesky[(std::size_t)col*_size + row] = *choleskyPtr++;
         }
     }
-    std::vector<double>().swap(_cholesky);
-    boost::shared_array<double> unpackedOther(new double [_size*_size]);
+    AlignedVector().swap(_cholesky);
+    boost::shared_array<double> unpackedOther(new double [sizeSq]);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row < col; ++row) {
-            unpackedOther[row*_size + col] = unpackedOther[col*_size + row] =
+            unpackedOther[(std::size_t)row*_size + col] = unpackedOther[(std::size_t)col*_size + row] =
                 other.getInverseCovariance(row,col);
         }
-        unpackedOther[col*_size + col] = other.getInverseCovariance(col,col);
+        unpackedOther[(std::size_t)col*_size + col] = other.getInverseCovariance(col,col);
     }
 
     double alpha(1);
@@ -685,9 +936,11 @@ void local::CovarianceMatrix::replaceWithTripleProduct(CovarianceMatrix const &o
     _icov.reserve(_ncov);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row <= col; ++row) {
-            _icov.push_back(unpackedResult[col*_size + row]);
+            _icov.push_back(unpackedResult[(std::size_t)col*_size + row]);
         }
     }
+    // The determinant cached by _readsCholesky() above was for the original matrix.
+    _logDeterminant = 0;
 }
 
 local::CovarianceMatrixPtr local::generateRandomCovariance(int size, double scale, RandomPtr random) {
@@ -700,7 +953,7 @@ local::CovarianceMatrixPtr local::generateRandomCovariance(int size, double scal
     // Use the default generator if none was specified.
     if(!random) random = Random::instance();
     // Initialize the storage we will need.
-    int sizeSq(size*size);
+    std::size_t sizeSq((std::size_t)size*size);
     CovarianceMatrixPtr C(new CovarianceMatrix(size));
     boost::shared_array<double> M;
     std::vector<double> MtM(sizeSq);
@@ -714,7 +967,7 @@ local::CovarianceMatrixPtr local::generateRandomCovariance(int size, double scal
         // since we will be rescaling to get the desired determinant. However, the choice of a
         // uniform distribution does determine the distribution properties of the generated
         // covariance matrices. Might want to provide an option for e.g, Gaussian instead?
-        for(int index = 0; index < sizeSq; ++index) M[index] -= 0.5;
+        for(std::size_t index = 0; index < sizeSq; ++index) M[index] -= 0.5;
 
         // Mt.M is positive definite iff M is invertible (i.e., has full rank and no zero singular values)
         // At this point, we can either calculate the singular values with BLAS DGESVD or go ahead and
@@ -730,7 +983,7 @@ local::CovarianceMatrixPtr local::generateRandomCovariance(int size, double scal
         // Loop over elements.
         for(int col = 0; col < size; ++col) {
             for(int row = 0; row <= col; ++row) {
-                C->setCovariance(row,col,MtM[col*size + row]);
+                C->setCovariance(row,col,MtM[(std::size_t)col*size + row]);
             }
         }
         // Calculate the re-scaling factor required to get the requested determinant. This
@@ -758,20 +1011,20 @@ boost::shared_array<double> local::CovarianceMatrix::sample(int nsample, RandomP
     }
     _readsCholesky();
     // Temporarily transpose and expand the packed Cholesky matrix.
-    boost::shared_array<double> expanded(new double[_size*_size]);
+    boost::shared_array<double> expanded(new double[(std::size_t)_size*_size]);
     double *ptr(&_cholesky[0]);
     for(int col = 0; col < _size; ++col) {
         for(int row = 0; row <= col; ++row) {
             // BLAS expects column-major ordering, i.e., with row increasing fastest.
             // Since we are transposing, col increases fastest here. We do not need to
             // initialize the upper diagonal elements since they will never be used.
-            expanded[row*_size + col] = *ptr++;
+            expanded[(std::size_t)row*_size + col] = *ptr++;
         }
     }
     // Use the default generator if none was specified.
     if(!random) random = Random::instance();
     // Generate double-precision normally distributed (but uncorrelated) random numbers.
-    std::size_t nrandom(nsample*_size), ngen(nrandom);
+    std::size_t nrandom((std::size_t)nsample*_size), ngen(nrandom);
     boost::shared_array<double> array = random->fillDoubleArrayNormal(ngen);
     // Consider this array to be a rectangular matrix M of dimensions _size x nsample and
     // calculate (expanded).(M) to obtain a new matrix of dimensions _size x nsample
@@ -827,9 +1080,9 @@ void local::CovarianceMatrix::addInverse(CovarianceMatrix const &other, double w
     if(other.isCompressed()) {
         _changesICov();
         for(int k = 0; k < _size; ++k) {
-            _icov[(k*(k+3))/2] += weight*other._diag[k];
+            _icov[((Index)k*(k+3))/2] += weight*other._diag[k];
         }
-        for(int k = 0; k < other._offdiagIndex.size(); ++k) {
+        for(std::size_t k = 0; k < other._offdiagIndex.size(); ++k) {
             _icov[other._offdiagIndex[k]] += weight*other._offdiagValue[k];
         }
     }
@@ -844,13 +1097,13 @@ void local::CovarianceMatrix::addInverse(CovarianceMatrix const &other, double w
     }
 }
 
-int local::CovarianceMatrix::getNElements() const {
+local::Index local::CovarianceMatrix::getNElements() const {
     // Prepare to read from the covariance matrix, and return zero if nothing has
     // been allocated yet.
     if(!_readsCov()) return 0;
     // Loop over all elements.
-    int nelem(0);
-    for(int index = 0; index < _ncov; ++index) {
+    Index nelem(0);
+    for(Index index = 0; index < _ncov; ++index) {
         if(_cov[index] != 0) nelem++;
     }
     return nelem;
@@ -874,9 +1127,16 @@ double local::CovarianceMatrix::getLogDeterminant() const {
     // Only do the minimum work necessary...
     if(0 == _logDeterminant) {
         _uncompress();
+        // A determinant of exactly one (e.g., after generateRandomCovariance rescales) looks
+        // the same as no cached value, so use any decomposition we already have.
+        if(!_cholesky.empty()) {
+            for(int index = 0; index < _size; ++index) {
+                _logDeterminant += 2*std::log(_cholesky[symmetricMatrixIndex(index,index,_size)]);
+            }
+            return _logDeterminant;
+        }
         // If we don't have a cached value then we have at most one of _icov or _cov,
         // but not both. Do a Cholesky decomposition of whatever we have.
-        assert(_cholesky.empty());
         assert(_cov.empty() || _icov.empty());
         if(!_cov.empty()) {
             // Calculate and save the covariance Cholesky decomposition now.
@@ -888,13 +1148,12 @@ double local::CovarianceMatrix::getLogDeterminant() const {
             _cholesky = _icov;
             _logDeterminant = -choleskyDecompose(_cholesky,_size);
             // Don't keep this decomposition, since this was the inverse.
-            std::vector<double>().swap(_cholesky);
+            AlignedVector().swap(_cholesky);
         }
         else {
             throw RuntimeError("CovarianceMatrix::getLogDeterminant: no elements have been set.");
         }
     }
-    assert(_logDeterminant != 0);
     return _logDeterminant;
 }
 
@@ -904,18 +1163,19 @@ void local::CovarianceMatrix::applyScaleFactor(double scaleFactor) {
     }
     // We could actually do this on a compressed object - maybe later...
     _uncompress();
+    _icovReplicas.clear();
     // Transform whatever vectors we have using the appropriate scale.
     if(!_cov.empty()) {
         double scale(scaleFactor);
-        for(int index = 0; index < _ncov; ++index) _cov[index] *= scale;
+        for(Index index = 0; index < _ncov; ++index) _cov[index] *= scale;
     }
     if(!_icov.empty()) {
         double scale(1/scaleFactor);
-        for(int index = 0; index < _ncov; ++index) _icov[index] *= scale;
+        for(Index index = 0; index < _ncov; ++index) _icov[index] *= scale;
     }
     if(!_cholesky.empty()) {
         double scale(std::sqrt(scaleFactor));
-        for(int index = 0; index < _ncov; ++index) _cholesky[index] *= scale;
+        for(Index index = 0; index < _ncov; ++index) _cholesky[index] *= scale;
     }
     if(_logDeterminant != 0) _logDeterminant += _size*std::log(scaleFactor);
 }
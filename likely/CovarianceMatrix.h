@@ -4,6 +4,7 @@
 #define LIKELY_COVARIANCE_MATRIX
 
 #include "likely/types.h"
+#include "likely/AlignedAllocator.h"
 
 #include "boost/smart_ptr.hpp"
 
@@ -41,7 +42,7 @@ namespace likely {
 		// Returns the fixed size of this covariance matrix.
         int getSize() const;
         // Returns the number of non-zero covariance matrix elements stored in this object.
-        int getNElements() const;
+        Index getNElements() const;
         // Returns the (natural) log of the determinant of this covariance matrix. The value is
         // cached so repeated calls to this method are inexpensive. A cached value is available
         // after compression, so call this method before compress() if you will need it. Otherwise,
@@ -58,6 +59,11 @@ namespace likely {
         // potentially expensive matrix operations.
         double getCovariance(int row, int col) const;
         double getInverseCovariance(int row, int col) const;
+        // Returns a pointer to our inverse covariance elements, packed column-wise as for the
+        // constructor above, or zero if no elements have been set yet. This avoids the range
+        // checks of getInverseCovariance when reading many elements. The pointer is only valid
+        // until this matrix is next changed or compressed.
+        double const *getPackedInverseCovariance() const;
         // Sets the specified (inverse) covariance matrix element or throws a RuntimeError.
         // Row and column indices should be in the range [0,size-1]. Setting any element with
         // row != col will also set the symmetric element in the matrix. Diagonal elements
@@ -81,9 +87,46 @@ namespace likely {
         // The result is stored in the input vector, overwriting its original contents.
         void multiplyByCovariance(std::vector<double> &vector) const;
         void multiplyByInverseCovariance(std::vector<double> &vector) const;
+        void multiplyByCovariance(AlignedVector &vector) const;
+        void multiplyByInverseCovariance(AlignedVector &vector) const;
         // Calculates the chi-square = delta.Cinv.delta for the specified residuals vector delta
-        // or throws a RuntimeError.
+        // or throws a RuntimeError. Reads the copy of Cinv on the NUMA node of the calling
+        // thread, if there is one (see replicateInverseCovariance).
         double chiSquare(std::vector<double> const &delta) const;
+        // Calculates the same chi-square and also fills icovDelta with Cinv.delta, from the
+        // same pass through Cinv. Use addChiSquareGradient to calculate a chi-square gradient
+        // from icovDelta.
+        double chiSquare(std::vector<double> const &delta, std::vector<double> &icovDelta) const;
+        // Copies our inverse covariance to each NUMA node used by the workers of the specified
+        // pool, which must have pinned workers, by having one worker on each node make its
+        // own copy. This trades one extra packed matrix per node for less traffic between
+        // nodes when threads on different nodes call chiSquare concurrently. Copies are
+        // dropped whenever the matrix is changed or compressed. Must not be called from
+        // within a thread pool task.
+        void replicateInverseCovariance(ThreadPoolPtr pool) const;
+        // Returns the number of NUMA nodes with a copy of our inverse covariance.
+        int getNReplicas() const;
+        // Calculates the chi-square for the specified residuals vector delta by forward
+        // substitution with our Cholesky decomposition, stopping as soon as the partial sum of
+        // non-negative whitened residuals squared exceeds the specified threshold. Returns the
+        // exact chi-square if it is <= threshold, or else a partial sum that is > threshold.
+        // Throws a RuntimeError if no Cholesky decomposition is possible. Reuses an internal
+        // buffer, so concurrent calls on the same object are not safe.
+        double chiSquareWithThreshold(std::vector<double> const &delta, double threshold) const;
+        // Calculates the symmetric product At.Cinv.A for the specified matrix A with getSize()
+        // rows and ncol columns, stored in column-major order with element [row,col] at
+        // col*getSize()+row, and saves the full ncol x ncol result in the vector provided.
+        // Solves with our packed Cholesky decomposition one column at a time and then uses
+        // level-3 BLAS for the product, so is much faster than multiplying each column of A
+        // by the inverse covariance, and needs no dense copy of the decomposition. Throws a
+        // RuntimeError if no Cholesky decomposition is possible.
+        void projectInverse(std::vector<double> const &matrix, int ncol,
+            std::vector<double> &result) const;
+        // Adds scale times the specified column of the inverse covariance to the vector
+        // provided, which must have getSize() elements, or throws a RuntimeError. This is
+        // O(getSize()) and allows Cinv.delta to be updated when only a few elements of
+        // delta change.
+        void addInverseCovarianceColumn(int col, double scale, std::vector<double> &vector) const;
         // Calculates the contributions to the chi-square for delta associated with each of
         // our eigenmodes, or throws a RuntimeError. Returns the chi-square value and fills the
         // vectors provided with the eigenvalues (in decreasing order), corresponding orthonormal
@@ -188,6 +231,10 @@ namespace likely {
 	    // been allocated yet, or else returns true. Always uncompresses.
         bool _readsCov() const;
         bool _readsICov() const;
+        // Prepares to read _icov for a chiSquare of the specified delta vector, and returns
+        // the copy on this thread's NUMA node, if any, or else _icov. Throws a RuntimeError
+        // if delta has the wrong size or _icov is empty.
+        double const *_readsLocalICov(std::vector<double> const &delta) const;
         // Prepares to read the Cholesky decomposition of the covariance stored in _cholesky.
         void _readsCholesky() const;
         // Prepares to change at least one element of _cov or _icov.
@@ -195,9 +242,11 @@ namespace likely {
         void _changesICov();
         // Helper function used by getMemoryState()
         char _tag(char symbol, std::vector<double> const &vector) const;
+        char _tag(char symbol, AlignedVector const &vector) const;
 
-        // TODO: is a cached value of _ncov = (_size*(_size+1))/2 really necessary?
-        int _size, _ncov;
+        // TODO: is a cached value of _ncov = symmetricMatrixElements(_size) really necessary?
+        int _size;
+        Index _ncov;
         // Remembers the value of our log(determinant), or is zero if no valid cached value
         // is available. Value is calculated, if necessary, when getLogDeterminant() is called
         // and is reset when _changesCov or _changesICov are called.
@@ -205,8 +254,13 @@ namespace likely {
         // Track our compression state. This is not the same as !_diag.empty() since we
         // cache previous compression data until a change to _cov or _icov invalidates it.
         mutable bool _compressed;
-        // _cholesky is the Cholesky decomposition of the covariance matrix (_cov, not _icov)
-        mutable std::vector<double> _cov, _icov, _cholesky;
+        // _cholesky is the Cholesky decomposition of the covariance matrix (_cov, not _icov).
+        // These can be large, so they use cache-line aligned storage backed by huge pages.
+        mutable AlignedVector _cov, _icov, _cholesky;
+        // Copies of _icov indexed by NUMA node, or empty pointers for nodes without a copy.
+        mutable std::vector<boost::shared_ptr<AlignedVector> > _icovReplicas;
+        // Whitened residuals buffer reused by chiSquareWithThreshold.
+        mutable std::vector<double> _whitened;
         // compression replaces _cov, _icov, _cholesky with the following
         // smaller vectors, that encode the inverse covariance matrix (_icov not _cov).
         mutable std::vector<double> _diag, _offdiagIndex, _offdiagValue;
@@ -222,39 +276,59 @@ namespace likely {
     // described at http://www.netlib.org/lapack/lug/node123.html or throws a
     // RuntimeError for invalid row or col inputs. The corresponding iterator sequence is:
     //
-    //   int index(0);
+    //   Index index(0);
     //   for(int col = 0; col < size; ++col) {
     //     for(int row = 0; row <= col; ++row) {
     //       index++;
     //     }
     //   }
-    int symmetricMatrixIndex(int row, int col, int size);
+    //
+    // Indices are 64-bit since packed matrices with more than about 65k rows have more
+    // than 2^31 elements.
+    Index symmetricMatrixIndex(int row, int col, int size);
+    // Returns the number of elements nelem = (size*(size+1))/2 of a symmetric matrix in the
+    // BLAS packed format implied by symmetricMatrixIndex, or throws a RuntimeError if this
+    // calculation overflows.
+    Index symmetricMatrixElements(int size);
     // Returns the size of a symmetric matrix in the BLAS packed format implied by
     // symmetricMatrixIndex, or throws a RuntimeError. The size is related to the
-    // number nelem of packed matrix elements by size = (nelem*(nelem+1))/2.
-    int symmetricMatrixSize(int nelem);
+    // number nelem of packed matrix elements by nelem = (size*(size+1))/2.
+    int symmetricMatrixSize(Index nelem);
+    // The functions below accept packed matrices stored in either a std::vector or an
+    // AlignedVector (see AlignedAllocator.h).
     // Performs a Cholesky decomposition in place of a symmetric positive definite matrix
     // or throws a RuntimeError if the matrix is not positive definite. The input matrix
     // is assumed to be in the BLAS packed format implied by packedMatrixIndex(row,col).
     // The matrix size will be calculated unless a positive value is provided. Returns
     // the log(determinant) of the input matrix, calculated as the product of the diagonal
-    // elements of the Cholesky decomposition.
+    // elements of the Cholesky decomposition. Large matrices are decomposed with
+    // tiledCholeskyDecompose (see TiledCholesky.h).
     double choleskyDecompose(std::vector<double> &matrix, int size = 0);
+    double choleskyDecompose(AlignedVector &matrix, int size = 0);
     // Inverts a symmetric positive definite matrix in place, or throws a RuntimeError.
     // The input matrix should already be Cholesky decomposed and in the BLAS packed 'U' format
     // implied by packedMatrixIndex(row,col), e.g. by first calling _choleskyDecompose(matrix).
-    // The matrix size will be calculated unless a positive value is provided.
+    // The matrix size will be calculated unless a positive value is provided. Large matrices
+    // are inverted with tiledInvertCholesky (see TiledCholesky.h).
     void invertCholesky(std::vector<double> &matrix, int size = 0);
+    void invertCholesky(AlignedVector &matrix, int size = 0);
     // Multiplies a symmetric matrix by a vector, or throws a RuntimeError. The input matrix
     // is assumed to be in the BLAS packed 'U' format implied by packedMatrixIndex(row,col).
+    // Uses packedSymmetricMultiply (see PackedKernels.h).
     void symmetricMatrixMultiply(std::vector<double> const &matrix,
         std::vector<double> const &vector, std::vector<double> &result);
+    void symmetricMatrixMultiply(AlignedVector const &matrix,
+        std::vector<double> const &vector, std::vector<double> &result);
+    void symmetricMatrixMultiply(AlignedVector const &matrix,
+        AlignedVector const &vector, AlignedVector &result);
     // Fills the result vector with Mt.M (transposeLeft = true) or M.Mt (transposeLeft = false)
     // where M is the input (unpacked) matrix, and result is in the BLAS packed 'U' format
     // implied by packedMatrixIndex(row,col). The matrix size will be calculated unless a
     // positive value is provided. 
     void matrixSquare(std::vector<double> const &matrix, std::vector<double> &result,
         bool transposeLeft, int size = 0);
+    void matrixSquare(std::vector<double> const &matrix, AlignedVector &result,
+        bool transposeLeft, int size = 0);
     // Solves the eigensystem for a symmetric matrix, or throws a RuntimeError. The input matrix
     // is assumed to be in the BLAS packed 'U' format implied by packedMatrixIndex(row,col).
     // The matrix size will be calculated unless a positive value is provided. Fills eigenvalues
@@ -262,6 +336,16 @@ namespace likely {
     // eigenvectors are orthonormal.
     void symmetricMatrixEigenSolve(std::vector<double> const &matrix,
         std::vector<double> &eigenvalues, std::vector<double> &eigenvectors, int size = 0);
+    void symmetricMatrixEigenSolve(AlignedVector const &matrix,
+        std::vector<double> &eigenvalues, std::vector<double> &eigenvectors, int size = 0);
+    // Adds the gradient of a chi-square with respect to a block of parameters to the specified
+    // gradient vector, starting at the specified offset, or throws a RuntimeError. The input
+    // icovDelta = Cinv.delta, with delta = pred - data, is filled by a chiSquare variant, and
+    // jacobian holds the partial derivatives of pred with respect to each parameter of the
+    // block, with element [row,par] at par*icovDelta.size()+row (i.e., column major). The
+    // gradient is 2*Jt.Cinv.delta and is calculated with level-2 BLAS.
+    void addChiSquareGradient(std::vector<double> const &icovDelta,
+        std::vector<double> const &jacobian, std::vector<double> &gradient, int offset = 0);
         
     // Creates a diagonal covariance matrix with constant elements (first form) or specified
     // positive elements (second form).
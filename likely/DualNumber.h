@@ -0,0 +1,308 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_DUAL_NUMBER
+#define LIKELY_DUAL_NUMBER
+
+#include "likely/types.h"
+
+#include "boost/bind.hpp"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace likely {
+    // Represents a value together with its partial derivatives with respect to N parameters,
+    // for forward-mode automatic differentiation. Functions written for a templated scalar
+    // type T, and evaluated with T = DualNumber<N>, calculate their exact partial derivatives
+    // along with their value. Use unqualified calls to math functions, after a using
+    // declaration for the std:: version, e.g. "using std::exp; return exp(-x);", so that the
+    // DualNumber overloads below are selected by argument-dependent lookup. Values are
+    // calculated exactly as they would be with double arithmetic, so a model evaluated with
+    // DualNumber parameters returns the same value as with double parameters.
+    //
+    // There is no adapter for FitModel subclasses, since they evaluate their predictions
+    // from the double parameter values stored by FitModel::updateParameterValues(). To use
+    // exact gradients with a FitModel, write its calculation as a templated function object
+    // and pass createDualFunctionAndGradient(model) to FitModel::findMinimum.
+    template <int N> class DualNumber {
+    public:
+        // Creates a new constant, whose derivatives are all zero.
+        DualNumber(double value = 0);
+        // Creates a new variable whose derivative with respect to the parameter with the
+        // specified index is one. Any index outside of [0,N) creates a constant instead.
+        DualNumber(double value, int index);
+        // Returns our value.
+        double getValue() const;
+        // Returns our partial derivative with respect to the parameter with the specified
+        // index, which must be in [0,N).
+        double getDerivative(int index) const;
+        double &derivative(int index);
+        // Returns true if all of our partial derivatives are zero.
+        bool isConstant() const;
+        // Arithmetic assignment operators.
+        DualNumber &operator+=(DualNumber const &other);
+        DualNumber &operator-=(DualNumber const &other);
+        DualNumber &operator*=(DualNumber const &other);
+        DualNumber &operator/=(DualNumber const &other);
+        DualNumber &operator+=(double other);
+        DualNumber &operator-=(double other);
+        DualNumber &operator*=(double other);
+        DualNumber &operator/=(double other);
+        // Returns a new number with the specified value whose derivatives are given by the
+        // chain rule as scale times ours.
+        DualNumber chain(double value, double scale) const;
+    private:
+        double _value, _derivative[N];
+    }; // DualNumber
+
+    template <int N> DualNumber<N>::DualNumber(double value)
+    : _value(value)
+    {
+        std::fill(_derivative,_derivative+N,0.);
+    }
+    template <int N> DualNumber<N>::DualNumber(double value, int index)
+    : _value(value)
+    {
+        std::fill(_derivative,_derivative+N,0.);
+        if(index >= 0 && index < N) _derivative[index] = 1;
+    }
+    template <int N> inline double DualNumber<N>::getValue() const { return _value; }
+    template <int N> inline double DualNumber<N>::getDerivative(int index) const {
+        return _derivative[index];
+    }
+    template <int N> inline double &DualNumber<N>::derivative(int index) {
+        return _derivative[index];
+    }
+
+    template <int N> inline bool DualNumber<N>::isConstant() const {
+        for(int k = 0; k < N; ++k) if(0 != _derivative[k]) return false;
+        return true;
+    }
+
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator+=(DualNumber const &other) {
+        _value += other._value;
+        for(int k = 0; k < N; ++k) _derivative[k] += other._derivative[k];
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator-=(DualNumber const &other) {
+        _value -= other._value;
+        for(int k = 0; k < N; ++k) _derivative[k] -= other._derivative[k];
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator*=(DualNumber const &other) {
+        for(int k = 0; k < N; ++k) {
+            _derivative[k] = _derivative[k]*other._value + _value*other._derivative[k];
+        }
+        _value *= other._value;
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator/=(DualNumber const &other) {
+        double value(_value/other._value);
+        for(int k = 0; k < N; ++k) {
+            _derivative[k] = (_derivative[k] - value*other._derivative[k])/other._value;
+        }
+        _value = value;
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator+=(double other) {
+        _value += other;
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator-=(double other) {
+        _value -= other;
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator*=(double other) {
+        _value *= other;
+        for(int k = 0; k < N; ++k) _derivative[k] *= other;
+        return *this;
+    }
+    template <int N> inline DualNumber<N> &DualNumber<N>::operator/=(double other) {
+        _value /= other;
+        for(int k = 0; k < N; ++k) _derivative[k] /= other;
+        return *this;
+    }
+    template <int N> inline DualNumber<N> DualNumber<N>::chain(double value, double scale) const {
+        DualNumber result(value);
+        for(int k = 0; k < N; ++k) result._derivative[k] = scale*_derivative[k];
+        return result;
+    }
+
+    // Arithmetic operators.
+    template <int N> inline DualNumber<N> operator-(DualNumber<N> const &a) {
+        return a.chain(-a.getValue(),-1);
+    }
+    template <int N> inline DualNumber<N> operator+(DualNumber<N> a, DualNumber<N> const &b) {
+        return a += b;
+    }
+    template <int N> inline DualNumber<N> operator+(DualNumber<N> a, double b) { return a += b; }
+    template <int N> inline DualNumber<N> operator+(double a, DualNumber<N> b) { return b += a; }
+    template <int N> inline DualNumber<N> operator-(DualNumber<N> a, DualNumber<N> const &b) {
+        return a -= b;
+    }
+    template <int N> inline DualNumber<N> operator-(DualNumber<N> a, double b) { return a -= b; }
+    template <int N> inline DualNumber<N> operator-(double a, DualNumber<N> const &b) {
+        return b.chain(a - b.getValue(),-1);
+    }
+    template <int N> inline DualNumber<N> operator*(DualNumber<N> a, DualNumber<N> const &b) {
+        return a *= b;
+    }
+    template <int N> inline DualNumber<N> operator*(DualNumber<N> a, double b) { return a *= b; }
+    template <int N> inline DualNumber<N> operator*(double a, DualNumber<N> b) { return b *= a; }
+    template <int N> inline DualNumber<N> operator/(DualNumber<N> a, DualNumber<N> const &b) {
+        return a /= b;
+    }
+    template <int N> inline DualNumber<N> operator/(DualNumber<N> a, double b) { return a /= b; }
+    template <int N> inline DualNumber<N> operator/(double a, DualNumber<N> const &b) {
+        double value(a/b.getValue());
+        return b.chain(value,-value/b.getValue());
+    }
+
+    // Comparisons only use values, so that branches in a model select the same code path
+    // for any scalar type.
+#define LIKELY_DUAL_NUMBER_COMPARISON(OP) \
+    template <int N> inline bool operator OP(DualNumber<N> const &a, DualNumber<N> const &b) { \
+        return a.getValue() OP b.getValue(); } \
+    template <int N> inline bool operator OP(DualNumber<N> const &a, double b) { \
+        return a.getValue() OP b; } \
+    template <int N> inline bool operator OP(double a, DualNumber<N> const &b) { \
+        return a OP b.getValue(); }
+    LIKELY_DUAL_NUMBER_COMPARISON(<)
+    LIKELY_DUAL_NUMBER_COMPARISON(>)
+    LIKELY_DUAL_NUMBER_COMPARISON(<=)
+    LIKELY_DUAL_NUMBER_COMPARISON(>=)
+    LIKELY_DUAL_NUMBER_COMPARISON(==)
+    LIKELY_DUAL_NUMBER_COMPARISON(!=)
+#undef LIKELY_DUAL_NUMBER_COMPARISON
+
+    // Math functions.
+    template <int N> inline DualNumber<N> sqrt(DualNumber<N> const &a) {
+        double value(std::sqrt(a.getValue()));
+        return a.chain(value,0.5/value);
+    }
+    template <int N> inline DualNumber<N> exp(DualNumber<N> const &a) {
+        double value(std::exp(a.getValue()));
+        return a.chain(value,value);
+    }
+    template <int N> inline DualNumber<N> log(DualNumber<N> const &a) {
+        return a.chain(std::log(a.getValue()),1/a.getValue());
+    }
+    template <int N> inline DualNumber<N> pow(DualNumber<N> const &a, double b) {
+        double value(std::pow(a.getValue(),b));
+        return a.chain(value,0 == b ? 0 : b*std::pow(a.getValue(),b-1));
+    }
+    template <int N> inline DualNumber<N> pow(DualNumber<N> const &a, DualNumber<N> const &b) {
+        DualNumber<N> result(pow(a,b.getValue()));
+        // log(a) is not finite for a = 0, so only add the dependence on b when it varies.
+        if(!b.isConstant()) result += b.chain(0,result.getValue()*std::log(a.getValue()));
+        return result;
+    }
+    template <int N> inline DualNumber<N> sin(DualNumber<N> const &a) {
+        return a.chain(std::sin(a.getValue()),std::cos(a.getValue()));
+    }
+    template <int N> inline DualNumber<N> cos(DualNumber<N> const &a) {
+        return a.chain(std::cos(a.getValue()),-std::sin(a.getValue()));
+    }
+    template <int N> inline DualNumber<N> sinh(DualNumber<N> const &a) {
+        return a.chain(std::sinh(a.getValue()),std::cosh(a.getValue()));
+    }
+    template <int N> inline DualNumber<N> cosh(DualNumber<N> const &a) {
+        return a.chain(std::cosh(a.getValue()),std::sinh(a.getValue()));
+    }
+    template <int N> inline DualNumber<N> asin(DualNumber<N> const &a) {
+        double x(a.getValue());
+        return a.chain(std::asin(x),1/std::sqrt(1 - x*x));
+    }
+    template <int N> inline DualNumber<N> acos(DualNumber<N> const &a) {
+        double x(a.getValue());
+        return a.chain(std::acos(x),-1/std::sqrt(1 - x*x));
+    }
+    template <int N> inline DualNumber<N> tan(DualNumber<N> const &a) {
+        double value(std::tan(a.getValue()));
+        return a.chain(value,1 + value*value);
+    }
+    template <int N> inline DualNumber<N> atan(DualNumber<N> const &a) {
+        double x(a.getValue());
+        return a.chain(std::atan(x),1/(1 + x*x));
+    }
+    template <int N> inline DualNumber<N> atan2(DualNumber<N> const &a, DualNumber<N> const &b) {
+        double y(a.getValue()), x(b.getValue()), r2(x*x + y*y);
+        DualNumber<N> result(a.chain(std::atan2(y,x),x/r2));
+        return result += b.chain(0,-y/r2);
+    }
+    template <int N> inline DualNumber<N> atan2(DualNumber<N> const &a, double b) {
+        double y(a.getValue());
+        return a.chain(std::atan2(y,b),b/(b*b + y*y));
+    }
+    template <int N> inline DualNumber<N> atan2(double a, DualNumber<N> const &b) {
+        double x(b.getValue());
+        return b.chain(std::atan2(a,x),-a/(x*x + a*a));
+    }
+    template <int N> inline DualNumber<N> tanh(DualNumber<N> const &a) {
+        double value(std::tanh(a.getValue()));
+        return a.chain(value,1 - value*value);
+    }
+    template <int N> inline DualNumber<N> fabs(DualNumber<N> const &a) {
+        return a.getValue() < 0 ? -a : a;
+    }
+    template <int N> inline DualNumber<N> abs(DualNumber<N> const &a) { return fabs(a); }
+
+    namespace dual {
+        // Evaluates model(pValues) with DualNumber<N> parameters and fills gValues with its
+        // exact gradient, using one pass per block of N parameters. Returns the model value.
+        template <int N, class P>
+        double evaluate(boost::shared_ptr<P> model, Parameters const &pValues, Gradient &gValues) {
+            int npar(pValues.size());
+            gValues.resize(npar);
+            std::vector<DualNumber<N> > duals(npar);
+            double value(0);
+            int first(0);
+            do {
+                for(int k = 0; k < npar; ++k) duals[k] = DualNumber<N>(pValues[k],k - first);
+                DualNumber<N> result((*model)(duals));
+                value = result.getValue();
+                for(int k = first; k < npar && k < first + N; ++k) {
+                    gValues[k] = result.getDerivative(k - first);
+                }
+                first += N;
+            } while(first < npar);
+            return value;
+        }
+        template <class P> double value(boost::shared_ptr<P> model, Parameters const &pValues) {
+            return (*model)(pValues);
+        }
+        template <int N, class P>
+        void gradient(boost::shared_ptr<P> model, Parameters const &pValues, Gradient &gValues) {
+            evaluate<N>(model,pValues,gValues);
+        }
+    } // dual
+
+    // Creates and returns a function, gradient calculator or fused function and gradient
+    // evaluator for a model of class P, which must provide a templated function call operator:
+    //
+    //   template <class T> T operator()(std::vector<T> const &pValues) const;
+    //
+    // The function evaluates the model with T = double. Gradients are calculated exactly,
+    // with T = DualNumber<N>, using one model evaluation per block of N parameters, instead
+    // of the 2*npar evaluations needed for central finite differences. Each DualNumber
+    // operation does N+1 times the arithmetic of a double operation, but any overhead that
+    // does not depend on the parameter values is only paid once per block. The returned
+    // objects keep a reference to the model.
+    template <class P> FunctionPtr createDualFunction(boost::shared_ptr<P> model) {
+        return FunctionPtr(new Function(boost::bind(dual::value<P>,model,_1)));
+    }
+    template <int N, class P> GradientCalculatorPtr createDualGradientCalculator(
+    boost::shared_ptr<P> model) {
+        return GradientCalculatorPtr(new GradientCalculator(
+            boost::bind(dual::gradient<N,P>,model,_1,_2)));
+    }
+    template <int N, class P> FunctionAndGradientPtr createDualFunctionAndGradient(
+    boost::shared_ptr<P> model) {
+        return FunctionAndGradientPtr(new FunctionAndGradient(
+            boost::bind(dual::evaluate<N,P>,model,_1,_2)));
+    }
+
+} // likely
+
+#endif // LIKELY_DUAL_NUMBER
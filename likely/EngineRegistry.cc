@@ -11,6 +11,8 @@
 #include "likely/MinuitEngine.h"
 #endif
 #include "likely/MarkovChainEngine.h"
+#include "likely/NestedSamplingEngine.h"
+#include "likely/LbfgsbEngine.h"
 
 #include "boost/regex.hpp"
 
@@ -31,6 +33,8 @@ FunctionPtr f, GradientCalculatorPtr gc, FitParameters const &parameters) {
     registerMinuitEngineMethods();
 #endif
     registerMarkovChainEngineMethods();
+    registerNestedSamplingEngineMethods();
+    registerLbfgsbEngineMethods();
     // Parse the method name to split out the fields of <engine>::<algorithm>
     static boost::regex pattern("([a-z0-9]+)::([0-9a-z_]+)");
     boost::smatch parsed;
@@ -0,0 +1,151 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/FisherMatrix.h"
+#include "likely/BinnedData.h"
+#include "likely/CovarianceMatrix.h"
+#include "likely/FunctionMinimum.h"
+#include "likely/ThreadPool.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/bind.hpp"
+
+#include <cmath>
+
+// Declare bindings to BLAS,LAPACK routines we need
+extern "C" {
+    // http://www.netlib.org/blas/dsyrk.f
+    void dsyrk_(char const *uplo, char const *trans, int const *n, int const *k,
+        double const *alpha, double const *a, int const *lda, double const *beta,
+        double *c, int const *ldc);
+}
+
+namespace local = likely;
+
+local::FisherMatrix::FisherMatrix(PredictionFunction prediction, BinnedDataCPtr data,
+FitParameters const &parameters, double stepScale)
+: _prediction(prediction), _data(data), _parameters(parameters)
+{
+    if(!_prediction) {
+        throw RuntimeError("FisherMatrix: no prediction function provided.");
+    }
+    if(!_data || 0 == _data->getNBinsWithData()) {
+        throw RuntimeError("FisherMatrix: no data provided.");
+    }
+    if(stepScale <= 0) {
+        throw RuntimeError("FisherMatrix: expected stepScale > 0.");
+    }
+    _nBins = _data->getNBinsWithData();
+    for(int index = 0; index < _parameters.size(); ++index) {
+        if(!_parameters[index].isFloating()) continue;
+        _floatingIndex.push_back(index);
+        _step.push_back(stepScale*_parameters[index].getError());
+    }
+    if(_floatingIndex.empty()) {
+        throw RuntimeError("FisherMatrix: no floating parameters.");
+    }
+}
+
+local::FisherMatrix::~FisherMatrix() { }
+
+void local::FisherMatrix::_evaluateRange(int first, int last, Parameters const *values,
+std::vector<double> *shifted) const {
+    Parameters trial(*values);
+    std::vector<double> pred;
+    for(int task = first; task < last; ++task) {
+        int k(task/2), index(_floatingIndex[k]);
+        trial[index] = (*values)[index] + ((task % 2) ? -_step[k] : +_step[k]);
+        _prediction(trial,pred);
+        if(pred.size() != _nBins) {
+            throw RuntimeError("FisherMatrix: prediction vector has wrong size.");
+        }
+        std::copy(pred.begin(),pred.end(),shifted->begin() + task*_nBins);
+        trial[index] = (*values)[index];
+    }
+}
+
+void local::FisherMatrix::calculateJacobian(Parameters const &values,
+std::vector<double> &jacobian, ThreadPoolPtr pool) const {
+    if(values.size() != _parameters.size()) {
+        throw RuntimeError("FisherMatrix::calculateJacobian: got wrong number of parameter values.");
+    }
+    int nFloating(_floatingIndex.size());
+    if(_jacobian) {
+        _jacobian(values,jacobian);
+        if(jacobian.size() != _nBins*nFloating) {
+            throw RuntimeError("FisherMatrix::calculateJacobian: Jacobian has wrong size.");
+        }
+        return;
+    }
+    // Evaluate the predictions shifted up and down for each floating parameter, in parallel
+    // if we have a pool.
+    std::vector<double> shifted(2*nFloating*_nBins);
+    if(pool) {
+        pool->parallelFor(0,2*nFloating,
+            boost::bind(&FisherMatrix::_evaluateRange,this,_1,_2,&values,&shifted),1);
+    }
+    else {
+        _evaluateRange(0,2*nFloating,&values,&shifted);
+    }
+    // Combine the shifted predictions into central differences.
+    jacobian.resize(_nBins*nFloating);
+    for(int k = 0; k < nFloating; ++k) {
+        double const *up(&shifted[2*k*_nBins]), *down(up + _nBins);
+        double *column(&jacobian[k*_nBins]), norm(0.5/_step[k]);
+        for(int bin = 0; bin < _nBins; ++bin) column[bin] = norm*(up[bin] - down[bin]);
+    }
+}
+
+local::FunctionMinimumPtr local::FisherMatrix::forecast(ThreadPoolPtr pool) const {
+    Parameters values;
+    getFitParameterValues(_parameters,values);
+    return forecast(values,pool);
+}
+
+local::FunctionMinimumPtr local::FisherMatrix::forecast(Parameters const &values,
+ThreadPoolPtr pool) const {
+    std::vector<double> jacobian;
+    calculateJacobian(values,jacobian,pool);
+    // Calculate F = Jt.Cinv.J using level-3 BLAS.
+    int nFloating(_floatingIndex.size());
+    std::vector<double> fisher;
+    if(_data->hasCovariance()) {
+        _data->getCovarianceMatrix()->projectInverse(jacobian,nFloating,fisher);
+    }
+    else {
+        // Cinv is the data's scalar weight times the identity matrix.
+        fisher.resize(nFloating*nFloating);
+        char uplo = 'U', trans = 'T';
+        double alpha(_data->getScalarWeight()), beta(0);
+        dsyrk_(&uplo,&trans,&nFloating,&_nBins,&alpha,&jacobian[0],&_nBins,&beta,
+            &fisher[0],&nFloating);
+    }
+    // Add the curvature of any Gaussian priors and copy the upper triangle of F into
+    // the inverse covariance of our result.
+    CovarianceMatrixPtr covariance(new CovarianceMatrix(nFloating));
+    for(int col = 0; col < nFloating; ++col) {
+        FitParameter const &param(_parameters[_floatingIndex[col]]);
+        if(param.getPriorType() == FitParameter::GaussPrior) {
+            double sigma(0.5*param.getPriorScale()*(param.getPriorMax() - param.getPriorMin()));
+            fisher[col*nFloating + col] += 1/(sigma*sigma);
+        }
+        for(int row = 0; row <= col; ++row) {
+            covariance->setInverseCovariance(row,col,fisher[col*nFloating + row]);
+        }
+    }
+    if(!covariance->isPositiveDefinite()) {
+        throw RuntimeError("FisherMatrix::forecast: Fisher matrix is not positive definite.");
+    }
+    // Calculate the chi-square of the prediction at these values.
+    std::vector<double> pred;
+    _prediction(values,pred);
+    double chiSquare(_data->chiSquare(pred));
+    // Build our result with the forecast errors.
+    FitParameters parameters(_parameters);
+    setFitParameterValues(parameters,values);
+    for(int k = 0; k < nFloating; ++k) {
+        parameters[_floatingIndex[k]].setError(std::sqrt(covariance->getCovariance(k,k)));
+    }
+    FunctionMinimumPtr fmin(new FunctionMinimum(0.5*chiSquare,parameters,covariance));
+    fmin->setCounts(_jacobian ? 1 : 2*nFloating+1,0);
+    return fmin;
+}
@@ -0,0 +1,77 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_FISHER_MATRIX
+#define LIKELY_FISHER_MATRIX
+
+#include "likely/types.h"
+#include "likely/FitParameter.h"
+
+#include "boost/function.hpp"
+
+#include <vector>
+
+namespace likely {
+    // Forecasts parameter constraints using the Fisher matrix F = Jt.Cinv.J, where J is the
+    // Jacobian of a model's predicted data with respect to its floating parameters and C is
+    // the covariance of a BinnedData. The inverse of F estimates the covariance of parameters
+    // fitted to the data, without performing a fit, which makes forecasts over a grid of
+    // parameter values cheap and provides a good initial proposal covariance for engines that
+    // sample the likelihood. The prediction function would normally be bound to a method of a
+    // FitModel subclass and must fill its vector using the same index sequence as the data's
+    // index iterator. Derivatives are estimated with central finite differences, unless a
+    // Jacobian function is provided. The finite differences are evaluated serially by default,
+    // or in parallel when a thread pool is provided, in which case the prediction function
+    // must be safe to call from multiple threads.
+	class FisherMatrix {
+	public:
+	    // Fills the vector provided with the predicted data for the specified parameter values.
+        typedef boost::function<void (Parameters const &values, std::vector<double> &pred)>
+            PredictionFunction;
+        // Fills the vector provided with the derivatives of the predicted data for the
+        // specified parameter values. The derivative of prediction i with respect to the k-th
+        // floating parameter is stored at k*getNBinsWithData()+i.
+        typedef boost::function<void (Parameters const &values, std::vector<double> &jacobian)>
+            JacobianFunction;
+        // Creates a new Fisher matrix calculator for the specified prediction function, data
+        // and parameters. Derivatives are estimated with a step for each floating parameter
+        // equal to its error times the specified scale.
+		FisherMatrix(PredictionFunction prediction, BinnedDataCPtr data,
+            FitParameters const &parameters, double stepScale = 0.1);
+		virtual ~FisherMatrix();
+		// Uses the specified function to calculate derivatives instead of finite differences.
+		// Call with an empty function to revert to finite differences.
+        void setJacobianFunction(JacobianFunction jacobian);
+        // Calculates the Jacobian of the predicted data for the specified parameter values,
+        // evaluating finite differences in parallel with the specified thread pool, or else
+        // serially. See JacobianFunction for the layout of the result.
+        void calculateJacobian(Parameters const &values, std::vector<double> &jacobian,
+            ThreadPoolPtr pool = ThreadPoolPtr()) const;
+        // Returns a function minimum at the specified parameter values, or else our parameter
+        // values, whose covariance is the inverse of the Fisher matrix, including the
+        // curvature of any Gaussian priors, and whose floating parameter errors are the
+        // square roots of its diagonal elements. The minimum value is half the data
+        // chi-square of the prediction at these values, which is zero when the data is
+        // itself the fiducial prediction. Throws a RuntimeError if the Fisher matrix is
+        // not positive definite, e.g., because some parameter is unconstrained.
+        FunctionMinimumPtr forecast(ThreadPoolPtr pool = ThreadPoolPtr()) const;
+        FunctionMinimumPtr forecast(Parameters const &values,
+            ThreadPoolPtr pool = ThreadPoolPtr()) const;
+	private:
+        // Evaluates the shifted predictions with the specified range of indices, where index
+        // 2k (2k+1) shifts the k-th floating parameter up (down).
+        void _evaluateRange(int first, int last, Parameters const *values,
+            std::vector<double> *shifted) const;
+        PredictionFunction _prediction;
+        JacobianFunction _jacobian;
+        BinnedDataCPtr _data;
+        FitParameters _parameters;
+        std::vector<int> _floatingIndex;
+        std::vector<double> _step;
+        int _nBins;
+	}; // FisherMatrix
+
+    inline void FisherMatrix::setJacobianFunction(JacobianFunction jacobian) { _jacobian = jacobian; }
+
+} // likely
+
+#endif // LIKELY_FISHER_MATRIX
@@ -74,16 +74,24 @@ void local::FitModel::configureFitParameters(std::string const &script) {
 
 local::FunctionMinimumPtr local::FitModel::findMinimum(FunctionPtr fptr, std::string const &method,
 std::string const &oneTimeConfig) {
+    // Use a null fused evaluator.
+    FunctionAndGradientPtr fgptr;
+    return findMinimum(fptr,fgptr,method,oneTimeConfig);
+}
+
+local::FunctionMinimumPtr local::FitModel::findMinimum(FunctionPtr fptr, FunctionAndGradientPtr fgptr,
+std::string const &method, std::string const &oneTimeConfig) {
+    GradientCalculatorPtr gcptr;
     if(0 < oneTimeConfig.length()) {
         // Apply the config script to a copy of our parameters.
         FitParameters modified(_parameters);
         modifyFitParameters(modified,oneTimeConfig);
         // Minimize using the modified parameters.
-        return local::findMinimum(fptr, modified, method);
+        return local::findMinimum(fptr, gcptr, fgptr, modified, method);
     }
     else {
         // Minimize using un-modified parameters.
-        return local::findMinimum(fptr, _parameters, method);
+        return local::findMinimum(fptr, gcptr, fgptr, _parameters, method);
     }
 }
 
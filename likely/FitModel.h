@@ -44,6 +44,11 @@ namespace likely {
         // Note that any modifications to priors in oneTimeConfig will have no effect on evaluatePrior().
         FunctionMinimumPtr findMinimum(FunctionPtr fptr, std::string const &method,
             std::string const &oneTimeConfig = "");
+        // Same as above, but also providing a fused function and gradient evaluator for
+        // methods that use gradients, e.g., created with createDualFunctionAndGradient
+        // (see DualNumber.h) for a model that is written for a templated scalar type.
+        FunctionMinimumPtr findMinimum(FunctionPtr fptr, FunctionAndGradientPtr fgptr,
+            std::string const &method, std::string const &oneTimeConfig = "");
         // Returns the current value of the named parameter, or throws a RuntimeError for an
         // invalid parameter name. If no value has ever been set, the default value specified
         // when this parameter was first defined is returned. Calls to configureFitParmeters()
@@ -206,12 +206,17 @@ double *fval, gsl_vector *g) {
     GslErrorHandler eh("GslEngine::_evaluateBoth");
     // Get the top engine on the stack.
     GslEngine *top(_useTopEngine(v));
-    // Call the function and save its value.
     top->incrementEvalCount();
-    *fval = (*(top->_f))(top->_params);
-    // Fill the engine's gradient vector.
     top->incrementGradCount();
-    (*(top->_gc))(top->_params,top->_grad);
+    if(top->functionAndGradient) {
+        // Calculate the function value and fill the engine's gradient vector in one call.
+        *fval = (*(top->functionAndGradient))(top->_params,top->_grad);
+    }
+    else {
+        // Call the function and save its value, then fill the engine's gradient vector.
+        *fval = (*(top->_f))(top->_params);
+        (*(top->_gc))(top->_params,top->_grad);
+    }
     // Copy the gradient components to the GSL vector provided.
     for(int i = 0; i < top->_nPar; ++i) gsl_vector_set(g,i,top->_grad[i]);
 }
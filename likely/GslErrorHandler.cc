@@ -3,31 +3,76 @@
 #include "likely/GslErrorHandler.h"
 #include "likely/RuntimeError.h"
 
+#include "config.h" // propagates HAVE_THREAD_LOCAL from configure
+
 #include "boost/format.hpp"
 
 #include <iostream>
+#include <cstdlib>
+
+#include <pthread.h>
 
 namespace local = likely;
 
-local::GslErrorHandler::GslErrorHandler(std::string const &context)
-: _original(gsl_set_error_handler(_handle))
+namespace likely {
+namespace gslerror {
+    // The innermost context declared by the current thread, or zero.
+#ifdef HAVE_THREAD_LOCAL
+    __thread GslErrorHandler *current = 0;
+    GslErrorHandler *getCurrent() { return current; }
+    void setCurrent(GslErrorHandler *handler) { current = handler; }
+#else
+    pthread_key_t currentKey;
+    pthread_once_t currentKeyOnce = PTHREAD_ONCE_INIT;
+    void createCurrentKey() { pthread_key_create(&currentKey,0); }
+    GslErrorHandler *getCurrent() {
+        pthread_once(&currentKeyOnce,createCurrentKey);
+        return static_cast<GslErrorHandler*>(pthread_getspecific(currentKey));
+    }
+    void setCurrent(GslErrorHandler *handler) {
+        pthread_once(&currentKeyOnce,createCurrentKey);
+        pthread_setspecific(currentKey,handler);
+    }
+#endif
+    // The handler that was installed before ours, which is only written once by _install.
+    gsl_error_handler_t *original = 0;
+    pthread_once_t installOnce = PTHREAD_ONCE_INIT;
+}} // likely::gslerror
+
+void local::GslErrorHandler::_install() {
+    gslerror::original = gsl_set_error_handler(_handle);
+}
+
+local::GslErrorHandler::GslErrorHandler(char const *context)
+: _context(context), _outer(gslerror::getCurrent())
 {
-    getContextStack().push(context);
+    // Install our handler the first time any context is created, so that contexts do not
+    // write any process-wide state.
+    pthread_once(&gslerror::installOnce,&_install);
+    gslerror::setCurrent(this);
 }
 
 local::GslErrorHandler::~GslErrorHandler() {
-    getContextStack().pop();
-    gsl_set_error_handler(_original);
+    gslerror::setCurrent(_outer);
 }
 
 void local::GslErrorHandler::_handle(
 const char *reason,const char *file,int line,int gsl_errno) {
-    static boost::format messageFormat("%s <GSL error at line %d of %s> %s\n");
+    GslErrorHandler const *current(gslerror::getCurrent());
+    if(0 == current) {
+        // Pass errors outside of any context to the handler we replaced, unless that was
+        // ours, which happens when other code saved and then restored our handler.
+        gsl_error_handler_t *original(gslerror::original);
+        if(original && original != _handle) {
+            original(reason,file,line,gsl_errno);
+            return;
+        }
+        // Report the error and abort, like the default GSL handler.
+        std::cerr << "gsl: " << file << ":" << line << ": ERROR: " << reason << std::endl
+            << "Default GSL error handler invoked." << std::endl;
+        std::abort();
+    }
+    boost::format messageFormat("%s <GSL error at line %d of %s> %s\n");
     throw RuntimeError(boost::str(
-        messageFormat % getContextStack().top() % line % file % reason));
-}
-
-std::stack<std::string> &local::GslErrorHandler::getContextStack() {
-    static std::stack<std::string> *contextStack = new std::stack<std::string>();
-    return *contextStack;
+        messageFormat % current->_context % line % file % reason));
 }
@@ -5,23 +5,34 @@
 
 #include "gsl/gsl_errno.h"
 
-#include <string>
-#include <stack>
-
 namespace likely {
+    // Declares a context for GSL errors detected by the current thread during the lifetime
+    // of this object, which are then reported by throwing a RuntimeError that includes the
+    // context. Contexts are kept in a thread-local stack, so creating a handler does not
+    // allocate any memory, and is cheap enough to use around each objective function
+    // evaluation. Our GSL error handler is installed once per process, when the first
+    // context is created, so contexts never write process-wide state. GSL errors detected
+    // by a thread outside of any context are passed to the handler that ours replaced, or
+    // else reported in the same way as the default GSL handler. Code that installs its own
+    // GSL handler later receives all GSL errors, including those inside contexts.
 	class GslErrorHandler {
 	public:
-	    // Installs a new context-specific error handler, remembering the original handler.
-		GslErrorHandler(std::string const &context);
-		// Restores the error handler that was in place when this object was created.
+	    // Declares a new context, which must be a string that outlives this object,
+	    // normally a string literal.
+		explicit GslErrorHandler(char const *context);
+		// Restores the context that was active when this object was created.
 		virtual ~GslErrorHandler();
 	private:
-		// Remembers the original handler
-        gsl_error_handler_t *_original;
+	    // Contexts are not copied.
+        GslErrorHandler(GslErrorHandler const &);
+        GslErrorHandler &operator=(GslErrorHandler const &);
+        // Our context and the context that was active when we were created.
+        char const *_context;
+        GslErrorHandler *_outer;
 		// Handles an error by throwing a RuntimeError with a descriptive message.
 		static void _handle(const char *reason,const char *file,int line,int gsl_errno);
-        // Keeps track of the current context in case of nested handlers.
-        static std::stack<std::string> &getContextStack();
+		// Installs our handler, remembering the handler it replaces.
+        static void _install();
 	}; // GslErrorHandler	
 } // likely
 
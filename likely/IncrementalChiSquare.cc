@@ -0,0 +1,123 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/IncrementalChiSquare.h"
+#include "likely/BinnedData.h"
+#include "likely/CovarianceMatrix.h"
+#include "likely/RuntimeError.h"
+
+#include <utility>
+#include <algorithm>
+
+namespace local = likely;
+
+local::IncrementalChiSquare::IncrementalChiSquare(BinnedDataCPtr data)
+: _data(data), _weight(1), _chiSquare(0), _refreshInterval(100), _nUpdates(0)
+{
+    if(!_data || 0 == _data->getNBinsWithData()) {
+        throw RuntimeError("IncrementalChiSquare: no data provided.");
+    }
+    if(_data->hasCovarianceOperator()) {
+        throw RuntimeError("IncrementalChiSquare: data has a covariance operator.");
+    }
+    if(_data->hasCovariance()) {
+        _covariance = _data->getCovarianceMatrix();
+    }
+    else {
+        _weight = _data->getScalarWeight();
+    }
+    _values.reserve(_data->getNBinsWithData());
+    for(BinnedData::IndexIterator iter = _data->begin(); iter != _data->end(); ++iter) {
+        _values.push_back(_data->getData(*iter));
+    }
+}
+
+local::IncrementalChiSquare::~IncrementalChiSquare() { }
+
+void local::IncrementalChiSquare::setRefreshInterval(int interval) {
+    if(interval < 0) {
+        throw RuntimeError("IncrementalChiSquare::setRefreshInterval: expected interval >= 0.");
+    }
+    _refreshInterval = interval;
+}
+
+double local::IncrementalChiSquare::reset(std::vector<double> const &pred) {
+    int nbins(_values.size());
+    if(pred.size() != nbins) {
+        throw RuntimeError("IncrementalChiSquare::reset: prediction vector has wrong size.");
+    }
+    _pred = pred;
+    _residual.resize(nbins);
+    for(int offset = 0; offset < nbins; ++offset) _residual[offset] = pred[offset] - _values[offset];
+    _weighted = _residual;
+    if(_covariance) {
+        _covariance->multiplyByInverseCovariance(_weighted);
+    }
+    else {
+        for(int offset = 0; offset < nbins; ++offset) _weighted[offset] *= _weight;
+    }
+    _chiSquare = 0;
+    for(int offset = 0; offset < nbins; ++offset) _chiSquare += _residual[offset]*_weighted[offset];
+    _nUpdates = 0;
+    return _chiSquare;
+}
+
+double local::IncrementalChiSquare::update(std::vector<double> const &pred,
+std::vector<int> const &changed) {
+    int nbins(_values.size());
+    if(pred.size() != nbins) {
+        throw RuntimeError("IncrementalChiSquare::update: prediction vector has wrong size.");
+    }
+    // Validate every offset before changing any state.
+    for(std::vector<int>::const_iterator iter = changed.begin(); iter != changed.end(); ++iter) {
+        if(*iter < 0 || *iter >= nbins) {
+            throw RuntimeError("IncrementalChiSquare::update: invalid offset.");
+        }
+    }
+    if(_pred.empty() || 4*changed.size() > nbins || _nUpdates >= _refreshInterval) {
+        return reset(pred);
+    }
+    // Find the change d in residuals of each distinct changed bin.
+    std::vector<int> offsets(changed);
+    std::sort(offsets.begin(),offsets.end());
+    offsets.erase(std::unique(offsets.begin(),offsets.end()),offsets.end());
+    std::vector<std::pair<int,double> > deltas;
+    deltas.reserve(offsets.size());
+    for(std::vector<int>::const_iterator iter = offsets.begin(); iter != offsets.end(); ++iter) {
+        double delta(pred[*iter] - _pred[*iter]);
+        if(0 != delta) deltas.push_back(std::make_pair(*iter,delta));
+    }
+    // Accumulate the change Cinv.d in the weighted residuals, one column of Cinv for each
+    // changed bin, before updating our residuals, so that we are unchanged if this fails.
+    _change.assign(nbins,0);
+    for(std::vector<std::pair<int,double> >::const_iterator iter = deltas.begin();
+    iter != deltas.end(); ++iter) {
+        if(_covariance) {
+            _covariance->addInverseCovarianceColumn(iter->first,iter->second,_change);
+        }
+        else {
+            _change[iter->first] += _weight*iter->second;
+        }
+    }
+    // The chi-square changes by d.(2 Cinv.r + Cinv.d), where r is the previous residual.
+    for(std::vector<std::pair<int,double> >::const_iterator iter = deltas.begin();
+    iter != deltas.end(); ++iter) {
+        int offset(iter->first);
+        _chiSquare += iter->second*(2*_weighted[offset] + _change[offset]);
+        _pred[offset] = pred[offset];
+        _residual[offset] += iter->second;
+    }
+    if(!deltas.empty()) {
+        for(int offset = 0; offset < nbins; ++offset) _weighted[offset] += _change[offset];
+        _nUpdates++;
+    }
+    return _chiSquare;
+}
+
+double local::IncrementalChiSquare::update(std::vector<double> const &pred) {
+    if(_pred.empty() || pred.size() != _pred.size()) return reset(pred);
+    std::vector<int> changed;
+    for(int offset = 0; offset < pred.size(); ++offset) {
+        if(pred[offset] != _pred[offset]) changed.push_back(offset);
+    }
+    return update(pred,changed);
+}
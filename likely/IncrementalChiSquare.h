@@ -0,0 +1,56 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_INCREMENTAL_CHI_SQUARE
+#define LIKELY_INCREMENTAL_CHI_SQUARE
+
+#include "likely/types.h"
+
+#include <vector>
+
+namespace likely {
+    // Calculates the same chi-square as BinnedData::chiSquare for a sequence of predictions,
+    // remembering the previous residuals r = pred - data and Cinv.r so that a prediction that
+    // only changes k bins is updated in O(n*k) using the affected columns of Cinv, instead of
+    // the O(n^2) full calculation. This is useful for models whose parameters each affect
+    // only a subset of bins, e.g., when used with FitModel::isParameterValueChanged(). The
+    // data and its covariance must not change during the lifetime of this object. An object
+    // of this class should not be used from more than one thread at a time.
+	class IncrementalChiSquare {
+	public:
+	    // Creates a new chi-square evaluator for the specified data, which must not have a
+	    // covariance operator.
+		explicit IncrementalChiSquare(BinnedDataCPtr data);
+		virtual ~IncrementalChiSquare();
+		// Calculates the chi-square for the specified prediction vector from scratch and
+		// remembers it for future updates.
+        double reset(std::vector<double> const &pred);
+        // Calculates the chi-square for the specified prediction vector, which is assumed to
+        // differ from the previous prediction only for the bins with the specified offsets
+        // (where offsets follow BinnedData's index iterator order). Performs a full
+        // calculation if reset() has not been called yet, if more than a quarter of all
+        // bins have changed, or after every getRefreshInterval() updates to limit the
+        // accumulation of rounding errors. Offsets can be repeated. Throws a RuntimeError,
+        // without changing any state, if any offset is out of range.
+        double update(std::vector<double> const &pred, std::vector<int> const &changed);
+        // Calculates the chi-square for the specified prediction vector, after first
+        // comparing it with the previous prediction to find which bins have changed.
+        double update(std::vector<double> const &pred);
+        // Returns the most recently calculated chi-square.
+        double getChiSquare() const;
+        // Gets/sets the number of incremental updates between full calculations.
+        int getRefreshInterval() const;
+        void setRefreshInterval(int interval);
+	private:
+        BinnedDataCPtr _data;
+        CovarianceMatrixCPtr _covariance;
+        double _weight, _chiSquare;
+        int _refreshInterval, _nUpdates;
+        std::vector<double> _values, _pred, _residual, _weighted, _change;
+	}; // IncrementalChiSquare
+
+    inline double IncrementalChiSquare::getChiSquare() const { return _chiSquare; }
+    inline int IncrementalChiSquare::getRefreshInterval() const { return _refreshInterval; }
+
+} // likely
+
+#endif // LIKELY_INCREMENTAL_CHI_SQUARE
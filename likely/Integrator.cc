@@ -24,14 +24,34 @@ namespace likely {
     }; // Integrator::Implementation
 } // likely::
 
+namespace likely {
+namespace integrator {
+    // Returns a reference to the integrand in a smart pointer, after checking that it exists.
+    Integrator::Integrand &dereference(Integrator::IntegrandPtr integrand) {
+        if(!integrand) throw RuntimeError("Integrator: missing integrand.");
+        return *integrand;
+    }
+}} // likely::integrator
+
 local::Integrator::Integrator(IntegrandPtr integrand, double epsAbs, double epsRel)
-: _integrand(integrand), _epsAbs(epsAbs), _epsRel(epsRel), _absError(0),
+: _integrand(integrand), _integrandRef(integrator::dereference(integrand)),
+_epsAbs(epsAbs), _epsRel(epsRel), _absError(0), _pimpl(new Implementation())
+{
+    _initialize();
+}
+
+local::Integrator::Integrator(IntegrandRef integrand, double epsAbs, double epsRel)
+: _integrandRef(integrand), _epsAbs(epsAbs), _epsRel(epsRel), _absError(0),
 _pimpl(new Implementation())
 {
-    if(epsRel < 0) {
+    _initialize();
+}
+
+void local::Integrator::_initialize() {
+    if(_epsRel < 0) {
         throw RuntimeError("Integrator: bad epsRel < 0.");
     }
-    if(epsAbs < 0) {
+    if(_epsAbs < 0) {
         throw RuntimeError("Integrator: bad epsAbs < 0.");
     }
 #ifdef HAVE_LIBGSL
@@ -43,9 +63,9 @@ _pimpl(new Implementation())
     _pimpl->cycle_workspace = 0;
     _pimpl->cquad_workspace = 0;
     _pimpl->qawo_table = 0;
-    // Link the function wrapper to our static evaluator.
+    // Link the function wrapper to our static evaluator, passing ourself as its parameter.
     _pimpl->function.function = &_evaluate;
-    _pimpl->function.params = 0;
+    _pimpl->function.params = this;
 #else
     throw RuntimeError("Integrator: GSL required for all integration methods.");
 #endif
@@ -64,7 +84,6 @@ local::Integrator::~Integrator() {
 
 double local::Integrator::integrateSmooth(double a, double b) {
     double result(0);
-    _getStack().push(this);
 #ifdef HAVE_LIBGSL
     // Declare our error-handling context.
     GslErrorHandler eh("Integrator::integrateSmooth");
@@ -73,13 +92,11 @@ double local::Integrator::integrateSmooth(double a, double b) {
     int status = gsl_integration_qag(&_pimpl->function,a,b,_epsAbs,_epsRel,
         _pimpl->workspaceSize,GSL_INTEG_GAUSS61,_pimpl->workspace,&result,&_absError);
 #endif
-    _getStack().pop();
     return result;
 }
 
 double local::Integrator::integrateRobust(double a, double b) {
     double result(0);
-    _getStack().push(this);
 #ifdef HAVE_LIBGSL
     // Declare our error-handling context.
     GslErrorHandler eh("Integrator::integrateRobust");
@@ -89,13 +106,11 @@ double local::Integrator::integrateRobust(double a, double b) {
     int status = gsl_integration_cquad(&_pimpl->function,a,b,_epsAbs,_epsRel,
         _pimpl->cquad_workspace,&result,&_absError,&nEvals);
 #endif
-    _getStack().pop();
     return result;
 }
 
 double local::Integrator::integrateSingular(double a, double b) {
     double result(0);
-    _getStack().push(this);
 #ifdef HAVE_LIBGSL
     // Declare our error-handling context.
     GslErrorHandler eh("Integrator::integrateSingular");
@@ -104,13 +119,11 @@ double local::Integrator::integrateSingular(double a, double b) {
     int status = gsl_integration_qags(&_pimpl->function,a,b,_epsAbs,_epsRel,
         _pimpl->workspaceSize,_pimpl->workspace,&result,&_absError);
 #endif
-    _getStack().pop();
     return result;
 }
 
 double local::Integrator::integrateUp(double a) {
         double result(0);
-        _getStack().push(this);
     #ifdef HAVE_LIBGSL
         // Declare our error-handling context.
         GslErrorHandler eh("Integrator::integrateUp");
@@ -119,13 +132,11 @@ double local::Integrator::integrateUp(double a) {
         int status = gsl_integration_qagiu(&_pimpl->function,a,_epsAbs,_epsRel,
             _pimpl->workspaceSize,_pimpl->workspace,&result,&_absError);
     #endif
-        _getStack().pop();
         return result;    
 }
 
 double local::Integrator::integrateDown(double b) {
         double result(0);
-        _getStack().push(this);
     #ifdef HAVE_LIBGSL
         // Declare our error-handling context.
         GslErrorHandler eh("Integrator::integrateDown");
@@ -134,13 +145,11 @@ double local::Integrator::integrateDown(double b) {
         int status = gsl_integration_qagil(&_pimpl->function,b,_epsAbs,_epsRel,
             _pimpl->workspaceSize,_pimpl->workspace,&result,&_absError);
     #endif
-        _getStack().pop();
         return result;    
 }
 
 double local::Integrator::integrateAll() {
         double result(0);
-        _getStack().push(this);
     #ifdef HAVE_LIBGSL
         // Declare our error-handling context.
         GslErrorHandler eh("Integrator::integrateDown");
@@ -149,13 +158,11 @@ double local::Integrator::integrateAll() {
         int status = gsl_integration_qagi(&_pimpl->function,_epsAbs,_epsRel,
             _pimpl->workspaceSize,_pimpl->workspace,&result,&_absError);
     #endif
-        _getStack().pop();
         return result;    
 }
 
 double local::Integrator::integrateOsc(double a, double b, double omega, bool useSin) {
         double result(0);
-        _getStack().push(this);
     #ifdef HAVE_LIBGSL
         // Declare our error-handling context.
         GslErrorHandler eh("Integrator::integrateOsc");
@@ -172,13 +179,11 @@ double local::Integrator::integrateOsc(double a, double b, double omega, bool us
         int status = gsl_integration_qawo(&_pimpl->function,a,_epsAbs,_epsRel,
             _pimpl->workspaceSize,_pimpl->workspace,_pimpl->qawo_table,&result,&_absError);
     #endif
-        _getStack().pop();
         return result;    
 }
 
 double local::Integrator::integrateOscUp(double a, double omega, bool useSin) {
         double result(0);
-        _getStack().push(this);
     #ifdef HAVE_LIBGSL
         // Declare our error-handling context.
         GslErrorHandler eh("Integrator::integrateOscUp");
@@ -198,16 +203,9 @@ double local::Integrator::integrateOscUp(double a, double omega, bool useSin) {
             _pimpl->workspaceSize,_pimpl->workspace,_pimpl->cycle_workspace,
             _pimpl->qawo_table,&result,&_absError);
     #endif
-        _getStack().pop();
         return result;    
 }
 
 double local::Integrator::_evaluate(double x, void *params) {
-    const Integrator *top(_getStack().top());
-    return (*(top->_integrand))(x);
-}
-
-std::stack<const local::Integrator*> &local::Integrator::_getStack() {
-    static std::stack<const Integrator*> *stack = new std::stack<const Integrator*>();
-    return *stack;
+    return static_cast<Integrator const*>(params)->_integrandRef(x);
 }
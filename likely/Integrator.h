@@ -3,19 +3,24 @@
 #ifndef LIKELY_INTEGRATOR
 #define LIKELY_INTEGRATOR
 
+#include "likely/function.h"
+
 #include "boost/function.hpp"
 #include "boost/smart_ptr.hpp"
 
-#include <stack>
-
 namespace likely {
     // Implements one-dimensional numerical integration algorithms.
 	class Integrator {
 	public:
         typedef boost::function<double (double)> Integrand;
         typedef boost::shared_ptr<Integrand> IntegrandPtr;
+        typedef CallableRef<double (double)> IntegrandRef;
         // Creates a new integrator of the specified integrand.
 		Integrator(IntegrandPtr integrand, double epsAbs, double epsRel);
+        // Creates a new integrator of the specified callable object, which is not copied
+        // and must outlive this integrator. GSL then reaches the object's operator() through
+        // a single CallableRef thunk instead of a boost::function.
+		Integrator(IntegrandRef integrand, double epsAbs, double epsRel);
 		virtual ~Integrator();
 		// Returns the integral over an interval [a,b] where the integrand is smooth
 		// and non-singular. Updates the value returned by getAbsError(). Uses GSL QAG.
@@ -47,15 +52,14 @@ namespace likely {
         // no integrations have been performed yet.
         double getAbsError() const;
 	private:
+        void _initialize();
         IntegrandPtr _integrand;
+        IntegrandRef _integrandRef;
         double _epsAbs, _epsRel, _absError;
         class Implementation;
         boost::scoped_ptr<Implementation> _pimpl;
-        // Global C-style callbacks that evaluate the top engine on the stack.
+        // Global C-style callback that evaluates the integrator passed via params.
         static double _evaluate(double x, void *params);
-        // Maintains an integrand stack that the global callback uses to determine which
-        // function to invoke when called.
-        static std::stack<const Integrator*> &_getStack();
 	}; // Integrator
 	
     inline double Integrator::getAbsError() const { return _absError; }
@@ -3,65 +3,81 @@
 #include "likely/Interpolator.h"
 #include "likely/RuntimeError.h"
 
-#include "config.h" // propagates HAVE_LIBGSL from configure
+#include "config.h" // propagates HAVE_LIBGSL, HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC from configure
 #ifdef HAVE_LIBGSL
 #include "likely/GslErrorHandler.h"
 #include "gsl/gsl_interp.h"
 #endif
 
 #include "boost/lexical_cast.hpp"
+#include "boost/cstdint.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iterator>
+#include <map>
+#include <limits>
+#include <cstring>
+#include <cstdio>
 
-// Declares our implementation data container.
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Declares our implementation data containers.
 namespace likely {
     struct Interpolator::Implementation {
 #ifdef HAVE_LIBGSL
-        const gsl_interp_type *engine;
         gsl_interp_accel *accelerator;
-        gsl_interp *interpolator;
+        gsl_interp const *interpolator;
 #endif
     }; // Interpolator::Implementation
+    struct InterpolatorTable::Implementation {
+#ifdef HAVE_LIBGSL
+        const gsl_interp_type *engine;
+        gsl_interp *interpolator;
+#endif
+    }; // InterpolatorTable::Implementation
 } // likely::
 
 namespace local = likely;
 
 local::Interpolator::Interpolator(CoordinateValues const &x, CoordinateValues const &y,
 std::string const &algorithm)
-: _x(x), _y(y), _nValues(x.size()), _pimpl(new Implementation())
+: _writableTable(new InterpolatorTable(x,y,algorithm)), _scale(1), _offset(0),
+_pimpl(new Implementation())
 {
-    // Check that the input vectors have the same length.
-    if(x.size() != y.size()) {
-        throw RuntimeError("Interpolator: input vectors must have the same length.");
-    }
-    // Check that x is sorted here, or does gsl_interp_init handle that?
+    _table = _writableTable;
+    _initialize();
+}
+
+local::Interpolator::Interpolator(InterpolatorTableCPtr table)
+: _table(table), _scale(1), _offset(0), _pimpl(new Implementation())
+{
+    if(!_table) throw RuntimeError("Interpolator: missing table.");
+    _initialize();
+}
+
+void local::Interpolator::_initialize() {
 #ifdef HAVE_LIBGSL
-    // Declare our error-handling context.
-    GslErrorHandler eh("Interpolator::Interpolator");
-    // Create our accelerator.
+    // Create our own accelerator.
     _pimpl->accelerator = gsl_interp_accel_alloc();
-    // Lookup the GSL engine for the requested algorithm.
-    if(algorithm == "linear") _pimpl->engine = gsl_interp_linear;
-    else if(algorithm == "polynomial") _pimpl->engine = gsl_interp_polynomial;
-    else if(algorithm == "cspline") _pimpl->engine = gsl_interp_cspline;
-    else if(algorithm == "cspline_periodic") _pimpl->engine = gsl_interp_cspline_periodic;
-    else if(algorithm == "cspline_akima") _pimpl->engine = gsl_interp_akima;
-    else if(algorithm == "cspline_akima_periodic") _pimpl->engine = gsl_interp_akima_periodic;
-    else {
-        throw RuntimeError("Interpolator: unknown algorithm '" + algorithm + "'.");
-    }
-    // Check that we have enough coordinate values for the requested scheme.
-    if(_nValues < _pimpl->engine->min_size) {
-        throw RuntimeError("Interpolator: need more values for the requested algorithm.");
-    }
-    // Create the engine's data structure.
-    _pimpl->interpolator = gsl_interp_alloc(_pimpl->engine, _nValues);
-    // Initialize the interpolation using the coordinate values provided.
-    gsl_interp_init(_pimpl->interpolator, &_x[0], &_y[0], _nValues);
+#endif
+    _useTable();
+}
+
+void local::Interpolator::_useTable() {
+    _nValues = _table->getNValues();
+    _x = _table->getX();
+    _y = _table->getY();
+#ifdef HAVE_LIBGSL
+    // Share the table's precomputed coefficients.
+    _pimpl->interpolator = _table->_pimpl->interpolator;
 #else
     throw RuntimeError("Interpolator: GSL required for all interpolation methods.");
 #endif
@@ -69,7 +85,6 @@ std::string const &algorithm)
 
 local::Interpolator::~Interpolator() {
 #ifdef HAVE_LIBGSL
-    gsl_interp_free(_pimpl->interpolator);
     gsl_interp_accel_free(_pimpl->accelerator);
 #endif
 }
@@ -79,10 +94,9 @@ double local::Interpolator::operator()(double x) const {
     // Declare our error-handling context.
     //!!GslErrorHandler eh("Interpolator::operator()");
     // Check for an out-of-range x value.
-    if(x <= _x.front()) return _y.front();
-    if(x >= _x.back()) return _y.back();
-    return gsl_interp_eval(_pimpl->interpolator,
-        &_x[0], &_y[0], x, _pimpl->accelerator);
+    if(x <= _x[0]) return _scale*_y[0] + _offset;
+    if(x >= _x[_nValues-1]) return _scale*_y[_nValues-1] + _offset;
+    return _scale*gsl_interp_eval(_pimpl->interpolator, _x, _y, x, _pimpl->accelerator) + _offset;
 #else
     throw RuntimeError("Interpolator: GSL required for all interpolation methods.");
 #endif
@@ -90,23 +104,287 @@ double local::Interpolator::operator()(double x) const {
 
 double local::Interpolator::getDerivative(double x) const {
 #ifdef HAVE_LIBGSL
-    if(x <= _x.front() || x >= _x.back()) return 0;
-    return gsl_interp_eval_deriv(_pimpl->interpolator,
-        &_x[0], &_y[0], x, _pimpl->accelerator);
+    if(x <= _x[0] || x >= _x[_nValues-1]) return 0;
+    return _scale*gsl_interp_eval_deriv(_pimpl->interpolator, _x, _y, x, _pimpl->accelerator);
 #else
     throw RuntimeError("Interpolator: GSL required for all interpolation methods.");
 #endif
 }
 
+local::Interpolator::CoordinateValues local::Interpolator::getYGrid() const {
+    CoordinateValues y(_y,_y+_nValues);
+    if(_scale != 1 || _offset != 0) {
+        for(int index = 0; index < _nValues; ++index) y[index] = _scale*y[index] + _offset;
+    }
+    return y;
+}
+
+double *local::Interpolator::_getWritableYValues() {
+    // Make a private copy of our table if we are sharing it, or if it is read only.
+    // The table is ours alone when it is only referenced by _table and _writableTable.
+    if(!_writableTable || _writableTable.use_count() > 2) {
+        _writableTable.reset(new InterpolatorTable(
+            CoordinateValues(_x,_x+_nValues),CoordinateValues(_y,_y+_nValues),
+            _table->getAlgorithm()));
+        _table = _writableTable;
+        _useTable();
+    }
+    _scale = 1;
+    _offset = 0;
+    return &_writableTable->_values[_nValues];
+}
+
+void local::Interpolator::setYValues(CoordinateValues const &y) {
+    if(y.size() != (std::size_t)_nValues) {
+        throw RuntimeError("Interpolator::setYValues: got wrong number of y values.");
+    }
+    std::copy(y.begin(),y.end(),_getWritableYValues());
+    _writableTable->_updateCoefficients();
+}
+
+void local::Interpolator::setYValues(GenericFunctionRef f) {
+    double *y = _getWritableYValues();
+    for(int index = 0; index < _nValues; ++index) y[index] = f(_x[index]);
+    _writableTable->_updateCoefficients();
+}
+
+void local::Interpolator::transformYValues(double scale, double offset) {
+    _offset = scale*_offset + offset;
+    _scale *= scale;
+}
+
 local::InterpolatorPtr local::createInterpolator(std::string const &filename,
-std::string const &algorithm) {
-    std::vector<std::vector<double> > columns(2);
-    std::ifstream input(filename.c_str());
-    readVectors(input, columns);
-    InterpolatorPtr interpolator(new Interpolator(columns[0],columns[1],algorithm));
+std::string const &algorithm, bool useSidecar) {
+    InterpolatorPtr interpolator(new Interpolator(
+        getInterpolatorTable(filename,algorithm,useSidecar)));
     return interpolator;
 }
 
+local::InterpolatorTable::InterpolatorTable(CoordinateValues const &x, CoordinateValues const &y,
+std::string const &algorithm)
+: _nValues(x.size()), _algorithm(algorithm), _pimpl(new Implementation())
+{
+    // Check that the input vectors have the same length.
+    if(x.size() != y.size()) {
+        throw RuntimeError("InterpolatorTable: input vectors must have the same length.");
+    }
+    // Store our x values followed by our y values in a single contiguous block.
+    _values.reserve(2*_nValues);
+    _values.insert(_values.end(),x.begin(),x.end());
+    _values.insert(_values.end(),y.begin(),y.end());
+    _x = _values.empty() ? 0 : &_values[0];
+    _y = _x + _nValues;
+    _initialize();
+}
+
+local::InterpolatorTable::InterpolatorTable(boost::shared_ptr<void> mapping,
+double const *x, double const *y, int nValues, std::string const &algorithm)
+: _nValues(nValues), _algorithm(algorithm), _mapping(mapping), _x(x), _y(y),
+_pimpl(new Implementation())
+{
+    _initialize();
+}
+
+void local::InterpolatorTable::_initialize() {
+#ifdef HAVE_LIBGSL
+    _pimpl->interpolator = 0;
+    // Declare our error-handling context.
+    GslErrorHandler eh("InterpolatorTable::InterpolatorTable");
+    // Lookup the GSL engine for the requested algorithm.
+    if(_algorithm == "linear") _pimpl->engine = gsl_interp_linear;
+    else if(_algorithm == "polynomial") _pimpl->engine = gsl_interp_polynomial;
+    else if(_algorithm == "cspline") _pimpl->engine = gsl_interp_cspline;
+    else if(_algorithm == "cspline_periodic") _pimpl->engine = gsl_interp_cspline_periodic;
+    else if(_algorithm == "cspline_akima") _pimpl->engine = gsl_interp_akima;
+    else if(_algorithm == "cspline_akima_periodic") _pimpl->engine = gsl_interp_akima_periodic;
+    else {
+        throw RuntimeError("InterpolatorTable: unknown algorithm '" + _algorithm + "'.");
+    }
+    // Check that we have enough coordinate values for the requested scheme.
+    if(_nValues < _pimpl->engine->min_size) {
+        throw RuntimeError("InterpolatorTable: need more values for the requested algorithm.");
+    }
+    // Create the engine's data structure and precompute its coefficients.
+    _pimpl->interpolator = gsl_interp_alloc(_pimpl->engine, _nValues);
+    try {
+        _updateCoefficients();
+    }
+    catch(...) {
+        gsl_interp_free(_pimpl->interpolator);
+        _pimpl->interpolator = 0;
+        throw;
+    }
+#else
+    throw RuntimeError("InterpolatorTable: GSL required for all interpolation methods.");
+#endif
+}
+
+void local::InterpolatorTable::_updateCoefficients() {
+#ifdef HAVE_LIBGSL
+    // Declare our error-handling context.
+    GslErrorHandler eh("InterpolatorTable::_updateCoefficients");
+    // Calculate the coefficients using the engine's existing data structure, which is
+    // O(n) for all of the supported algorithms. GSL checks that our x values are strictly
+    // increasing.
+    gsl_interp_init(_pimpl->interpolator, _x, _y, _nValues);
+#endif
+}
+
+local::InterpolatorTable::~InterpolatorTable() {
+#ifdef HAVE_LIBGSL
+    if(_pimpl->interpolator) gsl_interp_free(_pimpl->interpolator);
+#endif
+}
+
+namespace likely {
+namespace table {
+    // Identifies a binary sidecar file and the layout version of its contents.
+    char const sidecarMagic[8] = { 'L','I','K','E','L','Y','T','1' };
+    // Describes the start of a binary sidecar file, which is followed by the x values
+    // then the y values in native byte order.
+    struct SidecarHeader {
+        char magic[8];
+        boost::uint64_t nValues;
+    };
+    // Unmaps a sidecar file when the last table using it is deleted.
+    class Unmapper {
+    public:
+        Unmapper(std::size_t length) : _length(length) { }
+        void operator()(void *address) { ::munmap(address,_length); }
+    private:
+        std::size_t _length;
+    };
+    // Returns the nanoseconds part of a file's modification time, or zero if this
+    // platform only records whole seconds.
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+    long getModificationNanosec(struct stat const &info) { return info.st_mtim.tv_nsec; }
+#else
+    long getModificationNanosec(struct stat const &/*info*/) { return 0; }
+#endif
+    // Remembers a cached table and the state of its input file when it was read.
+    struct CacheEntry {
+        InterpolatorTableCPtr table;
+        time_t mtime;
+        long mtimeNanosec;
+        off_t size;
+    };
+    typedef std::map<std::pair<std::string,std::string>,CacheEntry> Cache;
+    Cache &getCache() {
+        static Cache *cache = new Cache();
+        return *cache;
+    }
+    pthread_mutex_t cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+    // Holds the cache mutex across fork(), so that a child process never inherits it
+    // locked by a thread that does not exist in the child.
+    pthread_once_t cacheAtForkOnce = PTHREAD_ONCE_INIT;
+    void lockCache() { pthread_mutex_lock(&cacheMutex); }
+    void unlockCache() { pthread_mutex_unlock(&cacheMutex); }
+    void registerCacheAtFork() { pthread_atfork(&lockCache,&unlockCache,&unlockCache); }
+    // Holds the cache mutex for the lifetime of this object.
+    class CacheLock {
+    public:
+        CacheLock() {
+            pthread_once(&cacheAtForkOnce,&registerCacheAtFork);
+            pthread_mutex_lock(&cacheMutex);
+        }
+        ~CacheLock() { pthread_mutex_unlock(&cacheMutex); }
+    };
+    // Tries to write a binary sidecar for the specified values. Writes to a temporary file
+    // first so that other processes never see a partially written sidecar.
+    void writeSidecar(std::string const &sidecarName, std::vector<std::vector<double> > const &columns) {
+        std::string tmpName = sidecarName + ".tmp" + boost::lexical_cast<std::string>(::getpid());
+        std::ofstream out(tmpName.c_str(),std::ios::binary);
+        if(!out.is_open()) return;
+        SidecarHeader header;
+        std::memcpy(header.magic,sidecarMagic,sizeof(sidecarMagic));
+        header.nValues = columns[0].size();
+        out.write(reinterpret_cast<char const*>(&header),sizeof(header));
+        for(int col = 0; col < 2; ++col) {
+            if(columns[col].empty()) continue;
+            out.write(reinterpret_cast<char const*>(&columns[col][0]),
+                columns[col].size()*sizeof(double));
+        }
+        out.close();
+        if(out.fail() || 0 != std::rename(tmpName.c_str(),sidecarName.c_str())) {
+            std::remove(tmpName.c_str());
+        }
+    }
+    // Tries to map a valid binary sidecar that is not older than the text file described
+    // by textInfo. Returns an empty pointer if this is not possible, or else a pointer that
+    // owns the mapping and sets nValues.
+    boost::shared_ptr<void> mapSidecar(std::string const &sidecarName, struct stat const &textInfo,
+    int &nValues) {
+        boost::shared_ptr<void> mapping;
+        struct stat info;
+        if(0 != ::stat(sidecarName.c_str(),&info) || info.st_size < (off_t)sizeof(SidecarHeader) ||
+            info.st_mtime < textInfo.st_mtime || (info.st_mtime == textInfo.st_mtime &&
+            getModificationNanosec(info) < getModificationNanosec(textInfo))) return mapping;
+        int fd = ::open(sidecarName.c_str(),O_RDONLY);
+        if(fd < 0) return mapping;
+        void *address = ::mmap(0,info.st_size,PROT_READ,MAP_SHARED,fd,0);
+        ::close(fd);
+        if(MAP_FAILED == address) return mapping;
+        mapping.reset(address,Unmapper(info.st_size));
+        // Only trust nValues if it fits in an int and exactly accounts for the rest of the
+        // mapped file. Checking the range first also keeps the size calculation from overflowing.
+        SidecarHeader const *header = static_cast<SidecarHeader const*>(address);
+        if(0 != std::memcmp(header->magic,sidecarMagic,sizeof(sidecarMagic)) ||
+            header->nValues > (boost::uint64_t)std::numeric_limits<int>::max() ||
+            sizeof(SidecarHeader) + 2*header->nValues*sizeof(double) != (boost::uint64_t)info.st_size) {
+            mapping.reset();
+            return mapping;
+        }
+        nValues = (int)header->nValues;
+        return mapping;
+    }
+}} // likely::table
+
+local::InterpolatorTableCPtr local::getInterpolatorTable(std::string const &filename,
+std::string const &algorithm, bool useSidecar) {
+    table::CacheLock lock;
+    struct stat info;
+    if(0 != ::stat(filename.c_str(),&info)) {
+        throw RuntimeError("getInterpolatorTable: cannot access '" + filename + "'.");
+    }
+    // Do we already have a table for this file that is still valid?
+    table::Cache &cache(table::getCache());
+    table::CacheEntry &entry(cache[std::make_pair(filename,algorithm)]);
+    if(entry.table && entry.mtime == info.st_mtime && entry.size == info.st_size &&
+        entry.mtimeNanosec == table::getModificationNanosec(info)) return entry.table;
+    entry.table.reset();
+    entry.mtime = info.st_mtime;
+    entry.mtimeNanosec = table::getModificationNanosec(info);
+    entry.size = info.st_size;
+    std::string sidecarName(filename + ".bin");
+    boost::shared_ptr<void> mapping;
+    int nValues;
+    if(useSidecar) mapping = table::mapSidecar(sidecarName,info,nValues);
+    if(!mapping) {
+        // Read the text file.
+        std::vector<std::vector<double> > columns(2);
+        std::ifstream input(filename.c_str());
+        readVectors(input, columns);
+        if(useSidecar) {
+            // Try to create a sidecar and map it, so that our memory can be shared.
+            table::writeSidecar(sidecarName,columns);
+            mapping = table::mapSidecar(sidecarName,info,nValues);
+        }
+        if(!mapping) {
+            entry.table.reset(new InterpolatorTable(columns[0],columns[1],algorithm));
+            return entry.table;
+        }
+    }
+    double const *x = reinterpret_cast<double const*>(
+        static_cast<table::SidecarHeader const*>(mapping.get()) + 1);
+    entry.table.reset(new InterpolatorTable(mapping,x,x+nValues,nValues,algorithm));
+    return entry.table;
+}
+
+void local::clearInterpolatorTableCache() {
+    table::CacheLock lock;
+    table::getCache().clear();
+}
+
 int local::readVectors(std::istream &input, std::vector<std::vector<double> > &vectors,
 bool ignoreExtra) {
     // Loop over input lines.
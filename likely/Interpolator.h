@@ -4,15 +4,19 @@
 #define LIKELY_INTERPOLATOR
 
 #include "likely/types.h"
+#include "likely/function.h"
 
 #include "boost/smart_ptr.hpp"
+#include "boost/utility.hpp"
 
 #include <vector>
 #include <string>
 #include <iosfwd>
 
 namespace likely {
-    // Implements interpolation algorithms.
+    // Implements interpolation algorithms. Interpolators that share the same table of
+    // control points can be used concurrently from different threads, but a single
+    // Interpolator should not be evaluated from more than one thread at a time.
 	class Interpolator {
 	public:
         typedef std::vector<double> CoordinateValues;
@@ -21,6 +25,9 @@ namespace likely {
         // (but with the gsl_interp_ prefix ommitted from the GSL function name).
         Interpolator(CoordinateValues const &x, CoordinateValues const &y,
             std::string const &algorithm);
+        // Creates a new interpolator that shares the control points and precomputed
+        // interpolation coefficients of the specified table.
+        explicit Interpolator(InterpolatorTableCPtr table);
         virtual ~Interpolator();
         // Returns the interpolated y value for the specified x value. Returns the
         // appropriate endpoint y value if x is outside the interpolation domain.
@@ -32,20 +39,106 @@ namespace likely {
         CoordinateValues getXGrid() const;
         // Returns a copy of the grid of y values that we interpolate on.
         CoordinateValues getYGrid() const;
+        // Replaces the y values that we interpolate on, keeping the same x grid, and
+        // recalculates our interpolation coefficients. The first call on an interpolator
+        // whose table is shared (or memory mapped) makes a private copy of the table, but
+        // subsequent calls reuse all existing allocations.
+        void setYValues(CoordinateValues const &y);
+        // Replaces the y values that we interpolate on with f(x) evaluated on our x grid,
+        // where f is any callable object, and recalculates our interpolation coefficients.
+        void setYValues(GenericFunctionRef f);
+        // Replaces each y value that we interpolate on with scale*y + offset. Since all of
+        // the supported algorithms are equivariant under this transform, it is applied
+        // to the interpolated values and does not recalculate any coefficients or modify a
+        // shared table. Transforms accumulate until the next call to setYValues.
+        void transformYValues(double scale, double offset = 0);
+        // Returns the table of control points that this interpolator uses. The returned table
+        // does not reflect any transform applied with transformYValues.
+        InterpolatorTableCPtr getTable() const;
 	private:
+        void _initialize();
+        void _useTable();
+        double *_getWritableYValues();
+        InterpolatorTableCPtr _table;
+        boost::shared_ptr<InterpolatorTable> _writableTable;
         int _nValues;
-        CoordinateValues _x, _y;
+        double const *_x, *_y;
+        double _scale, _offset;
         class Implementation;
         boost::scoped_ptr<Implementation> _pimpl;
 	}; // Interpolator
 	
-    inline Interpolator::CoordinateValues Interpolator::getXGrid() const { return _x; }
-    inline Interpolator::CoordinateValues Interpolator::getYGrid() const { return _y; }
+    inline Interpolator::CoordinateValues Interpolator::getXGrid() const {
+        return CoordinateValues(_x,_x+_nValues);
+    }
+    inline InterpolatorTableCPtr Interpolator::getTable() const { return _table; }
+
+    // Holds the immutable x,y values and precomputed interpolation coefficients that any
+    // number of Interpolator objects can share. A table is safe to share between threads
+    // since each Interpolator keeps its own lookup accelerator.
+	class InterpolatorTable : boost::noncopyable {
+	public:
+        typedef std::vector<double> CoordinateValues;
+        // Creates a new table from copies of the x,y vectors provided. Supported algorithms
+        // are the same as for Interpolator.
+        InterpolatorTable(CoordinateValues const &x, CoordinateValues const &y,
+            std::string const &algorithm);
+        virtual ~InterpolatorTable();
+        // Returns the number of tabulated values.
+        int getNValues() const;
+        // Returns pointers to the first tabulated x and y values.
+        double const *getX() const;
+        double const *getY() const;
+        // Returns the name of the interpolation algorithm used by this table.
+        std::string const &getAlgorithm() const;
+        // Returns true if our values are memory mapped from a binary sidecar file.
+        bool isMapped() const;
+	private:
+        friend class Interpolator;
+        friend InterpolatorTableCPtr getInterpolatorTable(std::string const &, std::string const &, bool);
+        // Creates a new table whose values are owned by the specified memory-mapped storage.
+        InterpolatorTable(boost::shared_ptr<void> mapping, double const *x, double const *y,
+            int nValues, std::string const &algorithm);
+        // Checks our values and precomputes our interpolation coefficients.
+        void _initialize();
+        // Recalculates our interpolation coefficients after our y values have changed.
+        void _updateCoefficients();
+        int _nValues;
+        std::string _algorithm;
+        CoordinateValues _values;
+        boost::shared_ptr<void> _mapping;
+        double const *_x, *_y;
+        class Implementation;
+        boost::scoped_ptr<Implementation> _pimpl;
+	}; // InterpolatorTable
+
+    inline int InterpolatorTable::getNValues() const { return _nValues; }
+    inline double const *InterpolatorTable::getX() const { return _x; }
+    inline double const *InterpolatorTable::getY() const { return _y; }
+    inline std::string const &InterpolatorTable::getAlgorithm() const { return _algorithm; }
+    inline bool InterpolatorTable::isMapped() const { return !!_mapping; }
+
+    // Returns a table of control points read from the specified file name and prepared for
+    // the specified algorithm. Tables are cached process-wide using the file name and algorithm
+    // as a key, so that repeated calls return the same shared table until the file is modified.
+    // When useSidecar is set, values are memory mapped from a binary copy of the file with
+    // ".bin" appended to its name, which is first written (if possible) when it is missing or
+    // older than the text file. A mapped sidecar is shared by all processes that use it.
+    // This function is thread safe.
+    InterpolatorTableCPtr getInterpolatorTable(std::string const &filename,
+        std::string const &algorithm, bool useSidecar = false);
+
+    // Releases the cache's references to all tables previously returned by
+    // getInterpolatorTable. Tables that are still in use are not affected.
+    void clearInterpolatorTableCache();
 
     // Returns a smart pointer to an interpolator based on control points read
-    // from the specified file name.
+    // from the specified file name. The control points and interpolation coefficients
+    // are shared with all other interpolators created from the same file and algorithm,
+    // and are only read once unless the file changes. See getInterpolatorTable for details
+    // of the optional binary sidecar.
 	InterpolatorPtr createInterpolator(std::string const &filename,
-        std::string const &algorithm);
+        std::string const &algorithm, bool useSidecar = false);
 
     // Fills the vectors provided from the columns of the specified input stream.
     // Returns the number of rows successfully read or throws a RuntimeError.
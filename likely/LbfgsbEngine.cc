@@ -0,0 +1,502 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/LbfgsbEngine.h"
+#include "likely/FunctionMinimum.h"
+#include "likely/EngineRegistry.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/math/special_functions/fpclassify.hpp"
+#include "boost/functional/factory.hpp"
+#include "boost/lexical_cast.hpp"
+#include "boost/bind.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+
+namespace local = likely;
+
+namespace likely {
+namespace lbfgsb {
+    double const infinity = std::numeric_limits<double>::infinity();
+    double const epsilon = std::numeric_limits<double>::epsilon();
+    // Inverts a square matrix in place by Gauss-Jordan elimination with partial pivoting.
+    // Returns false if the matrix is singular.
+    bool invert(std::vector<double> &matrix, int size) {
+        std::vector<int> pivot(size);
+        for(int col = 0; col < size; ++col) {
+            int best(col);
+            for(int row = col+1; row < size; ++row) {
+                if(std::fabs(matrix[row*size+col]) > std::fabs(matrix[best*size+col])) best = row;
+            }
+            if(0 == matrix[best*size+col]) return false;
+            pivot[col] = best;
+            if(best != col) {
+                for(int k = 0; k < size; ++k) std::swap(matrix[col*size+k],matrix[best*size+k]);
+            }
+            double scale(1/matrix[col*size+col]);
+            matrix[col*size+col] = 1;
+            for(int k = 0; k < size; ++k) matrix[col*size+k] *= scale;
+            for(int row = 0; row < size; ++row) {
+                if(row == col) continue;
+                double factor(matrix[row*size+col]);
+                if(0 == factor) continue;
+                matrix[row*size+col] = 0;
+                for(int k = 0; k < size; ++k) matrix[row*size+k] -= factor*matrix[col*size+k];
+            }
+        }
+        // Undo the row swaps as column swaps, in reverse order.
+        for(int col = size-1; col >= 0; --col) {
+            if(pivot[col] == col) continue;
+            for(int row = 0; row < size; ++row) {
+                std::swap(matrix[row*size+col],matrix[row*size+pivot[col]]);
+            }
+        }
+        return true;
+    }
+    double dot(std::vector<double> const &a, std::vector<double> const &b) {
+        double sum(0);
+        for(int i = 0; i < a.size(); ++i) sum += a[i]*b[i];
+        return sum;
+    }
+    // Stores the limited memory BFGS matrix B = theta*I - W.M.Wt in its compact form, with
+    // W = [Y, theta*S] built from the k most recent corrections s = dx and y = dg.
+    class Memory {
+    public:
+        Memory(int size) : theta(1), _size(size) { }
+        int getK() const { return S.size(); }
+        void reset() {
+            S.clear();
+            Y.clear();
+            theta = 1;
+            M.clear();
+        }
+        // Adds a new correction pair, if it satisfies the curvature condition.
+        void add(std::vector<double> const &s, std::vector<double> const &y) {
+            double sy(dot(s,y)), yy(dot(y,y));
+            if(sy <= epsilon*yy) return;
+            if(S.size() == _size) {
+                S.erase(S.begin());
+                Y.erase(Y.begin());
+            }
+            S.push_back(s);
+            Y.push_back(y);
+            theta = yy/sy;
+            // Build the 2k x 2k middle matrix [[-D,Lt],[L,theta*St.S]] and invert it.
+            int k(getK()), k2(2*k);
+            M.assign(k2*k2,0);
+            for(int i = 0; i < k; ++i) {
+                M[i*k2+i] = -dot(S[i],Y[i]);
+                for(int j = 0; j < i; ++j) {
+                    double sy(dot(S[i],Y[j]));
+                    M[(k+i)*k2+j] = sy;
+                    M[j*k2+k+i] = sy;
+                }
+                for(int j = 0; j <= i; ++j) {
+                    double ss(theta*dot(S[i],S[j]));
+                    M[(k+i)*k2+k+j] = ss;
+                    M[(k+j)*k2+k+i] = ss;
+                }
+            }
+            if(!invert(M,k2)) reset();
+        }
+        // Returns element [row,col] of W.
+        double w(int row, int col) const {
+            int k(getK());
+            return col < k ? Y[col][row] : theta*S[col-k][row];
+        }
+        // Fills result with Wt.v, restricted to the specified rows when rows is not null.
+        void multiplyWt(std::vector<double> const &v, std::vector<double> &result,
+        std::vector<int> const *rows = 0) const {
+            int k(getK());
+            result.assign(2*k,0);
+            for(int j = 0; j < k; ++j) {
+                double ysum(0), ssum(0);
+                if(rows) {
+                    for(int r = 0; r < rows->size(); ++r) {
+                        int i((*rows)[r]);
+                        ysum += Y[j][i]*v[r];
+                        ssum += S[j][i]*v[r];
+                    }
+                }
+                else {
+                    ysum = dot(Y[j],v);
+                    ssum = dot(S[j],v);
+                }
+                result[j] = ysum;
+                result[k+j] = theta*ssum;
+            }
+        }
+        // Fills result with M.v for a vector of length 2k.
+        void multiplyM(std::vector<double> const &v, std::vector<double> &result) const {
+            int k2(2*getK());
+            result.assign(k2,0);
+            for(int i = 0; i < k2; ++i) {
+                for(int j = 0; j < k2; ++j) result[i] += M[i*k2+j]*v[j];
+            }
+        }
+        std::vector<std::vector<double> > S, Y;
+        double theta;
+        std::vector<double> M;
+    private:
+        int _size;
+    }; // Memory
+    // Calculates the generalized Cauchy point xcp, the first local minimizer of the quadratic
+    // model along the projected steepest descent path from x, and fills c = Wt.(xcp - x).
+    void cauchyPoint(std::vector<double> const &x, std::vector<double> const &g,
+    std::vector<double> const &lower, std::vector<double> const &upper, Memory const &memory,
+    std::vector<double> &xcp, std::vector<double> &c) {
+        int n(x.size()), k2(2*memory.getK());
+        xcp = x;
+        std::vector<double> d(n);
+        std::vector<std::pair<double,int> > breaks;
+        for(int i = 0; i < n; ++i) {
+            double t(infinity);
+            if(g[i] < 0 && upper[i] < infinity) t = (x[i] - upper[i])/g[i];
+            else if(g[i] > 0 && lower[i] > -infinity) t = (x[i] - lower[i])/g[i];
+            d[i] = (t <= 0) ? 0 : -g[i];
+            if(t > 0 && t < infinity) breaks.push_back(std::make_pair(t,i));
+        }
+        std::sort(breaks.begin(),breaks.end());
+        std::vector<double> p, Mp, wb(k2), Mwb;
+        memory.multiplyWt(d,p);
+        c.assign(k2,0);
+        double fp(-dot(d,d));
+        if(0 == fp) return;
+        memory.multiplyM(p,Mp);
+        double fpp(-memory.theta*fp - dot(p,Mp)), fpp0(-memory.theta*fp);
+        double dtMin(-fp/fpp), tOld(0);
+        for(int b = 0; b < breaks.size(); ++b) {
+            double t(breaks[b].first);
+            int i(breaks[b].second);
+            double dt(t - tOld);
+            if(dtMin < dt) break;
+            // Move to this breakpoint, where variable i reaches its bound.
+            xcp[i] = d[i] > 0 ? upper[i] : lower[i];
+            double z(xcp[i] - x[i]), gb(g[i]);
+            for(int j = 0; j < k2; ++j) {
+                c[j] += dt*p[j];
+                wb[j] = memory.w(i,j);
+            }
+            memory.multiplyM(wb,Mwb);
+            fp += dt*fpp + gb*gb + memory.theta*gb*z - gb*dot(Mwb,c);
+            fpp += -memory.theta*gb*gb - 2*gb*dot(Mwb,p) - gb*gb*dot(Mwb,wb);
+            fpp = std::max(epsilon*fpp0,fpp);
+            for(int j = 0; j < k2; ++j) p[j] += gb*wb[j];
+            d[i] = 0;
+            dtMin = -fp/fpp;
+            tOld = t;
+        }
+        dtMin = std::max(0.,dtMin);
+        tOld += dtMin;
+        for(int i = 0; i < n; ++i) {
+            if(0 != d[i]) xcp[i] = std::min(upper[i],std::max(lower[i],x[i] + tOld*d[i]));
+        }
+        for(int j = 0; j < k2; ++j) c[j] += dtMin*p[j];
+    }
+    // Minimizes the quadratic model over the variables that are free at the Cauchy point,
+    // using the direct primal method, and returns the result truncated to the bounds in xbar.
+    void subspaceMinimum(std::vector<double> const &x, std::vector<double> const &g,
+    std::vector<double> const &lower, std::vector<double> const &upper, Memory const &memory,
+    std::vector<double> const &xcp, std::vector<double> const &c, std::vector<double> &xbar) {
+        int n(x.size()), k(memory.getK()), k2(2*k);
+        double theta(memory.theta);
+        xbar = xcp;
+        std::vector<int> free;
+        for(int i = 0; i < n; ++i) {
+            if(xcp[i] > lower[i] && xcp[i] < upper[i]) free.push_back(i);
+        }
+        int nFree(free.size());
+        if(0 == nFree) return;
+        // Calculate the reduced gradient r = Zt.(g + theta*(xcp-x) - W.M.c)
+        std::vector<double> Mc, r(nFree), v, Mv;
+        memory.multiplyM(c,Mc);
+        for(int f = 0; f < nFree; ++f) {
+            int i(free[f]);
+            double WMc(0);
+            for(int j = 0; j < k2; ++j) WMc += memory.w(i,j)*Mc[j];
+            r[f] = g[i] + theta*(xcp[i] - x[i]) - WMc;
+        }
+        std::vector<double> du(nFree);
+        for(int f = 0; f < nFree; ++f) du[f] = -r[f]/theta;
+        if(k > 0) {
+            // Solve with N = I - M.Wzt.Wz/theta using v = M.Wzt.r
+            memory.multiplyWt(r,v,&free);
+            memory.multiplyM(v,Mv);
+            std::vector<double> WtW(k2*k2,0), N(k2*k2);
+            for(int f = 0; f < nFree; ++f) {
+                int i(free[f]);
+                for(int a = 0; a < k2; ++a) {
+                    double wa(memory.w(i,a));
+                    for(int b = 0; b < k2; ++b) WtW[a*k2+b] += wa*memory.w(i,b);
+                }
+            }
+            for(int a = 0; a < k2; ++a) {
+                for(int b = 0; b < k2; ++b) {
+                    double sum(0);
+                    for(int j = 0; j < k2; ++j) sum += memory.M[a*k2+j]*WtW[j*k2+b];
+                    N[a*k2+b] = (a == b ? 1 : 0) - sum/theta;
+                }
+            }
+            if(invert(N,k2)) {
+                for(int a = 0; a < k2; ++a) {
+                    v[a] = 0;
+                    for(int b = 0; b < k2; ++b) v[a] += N[a*k2+b]*Mv[b];
+                }
+                for(int f = 0; f < nFree; ++f) {
+                    double Wv(0);
+                    for(int a = 0; a < k2; ++a) Wv += memory.w(free[f],a)*v[a];
+                    du[f] -= Wv/(theta*theta);
+                }
+            }
+        }
+        // Truncate the step so that it stays within the bounds.
+        double alpha(1);
+        for(int f = 0; f < nFree; ++f) {
+            int i(free[f]);
+            if(du[f] > 0) alpha = std::min(alpha,(upper[i] - xcp[i])/du[f]);
+            else if(du[f] < 0) alpha = std::min(alpha,(lower[i] - xcp[i])/du[f]);
+        }
+        for(int f = 0; f < nFree; ++f) {
+            int i(free[f]);
+            xbar[i] = std::min(upper[i],std::max(lower[i],xcp[i] + alpha*du[f]));
+        }
+    }
+    // Returns the largest component of the projected gradient.
+    double projectedGradientNorm(std::vector<double> const &x, std::vector<double> const &g,
+    std::vector<double> const &lower, std::vector<double> const &upper) {
+        double norm(0);
+        for(int i = 0; i < x.size(); ++i) {
+            double projected(std::min(upper[i],std::max(lower[i],x[i] - g[i])) - x[i]);
+            norm = std::max(norm,std::fabs(projected));
+        }
+        return norm;
+    }
+}} // likely::lbfgsb
+
+local::LbfgsbEngine::LbfgsbEngine(FunctionPtr f, GradientCalculatorPtr gc,
+FitParameters const &parameters, std::string const &algorithm)
+: _nPar(parameters.size()), _f(f), _gc(gc)
+{
+    if(_nPar <= 0) {
+        throw RuntimeError("LbfgsbEngine: number of parameters must be > 0.");
+    }
+    // Parse the number of correction pairs from our algorithm name.
+    _memorySize = 0;
+    if(0 == algorithm.find("m")) {
+        try {
+            _memorySize = boost::lexical_cast<int>(algorithm.substr(1));
+        }
+        catch(boost::bad_lexical_cast const &e) { }
+    }
+    if(_memorySize <= 0) {
+        throw RuntimeError("LbfgsbEngine: unknown algorithm '" + algorithm + "'");
+    }
+    // Use box priors as bounds.
+    _lower.resize(_nPar,-lbfgsb::infinity);
+    _upper.resize(_nPar,+lbfgsb::infinity);
+    for(int index = 0; index < _nPar; ++index) {
+        FitParameter const &parameter(parameters[index]);
+        if(parameter.getPriorType() != FitParameter::BoxPrior) continue;
+        if(parameter.getPriorMin() > parameter.getPriorMax()) {
+            throw RuntimeError("LbfgsbEngine: invalid box prior for " + parameter.getName());
+        }
+        _lower[index] = parameter.getPriorMin();
+        _upper[index] = parameter.getPriorMax();
+    }
+    minimumFinder = boost::bind(&LbfgsbEngine::minimize,this,_1,_2,_3);
+}
+
+local::LbfgsbEngine::~LbfgsbEngine() { }
+
+void local::LbfgsbEngine::_setParameters(std::vector<double> const &z) const {
+    // Clamp each value since scaling and unscaling a bound does not always round trip.
+    for(int i = 0; i < _floatingIndex.size(); ++i) {
+        int index(_floatingIndex[i]);
+        _params[index] = std::min(_upper[index],std::max(_lower[index],_scale[i]*z[i]));
+    }
+}
+
+double local::LbfgsbEngine::_evaluate(std::vector<double> const &z,
+std::vector<double> *gradient) const {
+    _setParameters(z);
+    double value;
+    incrementEvalCount();
+    if(gradient && functionAndGradient) {
+        int nFloating(_floatingIndex.size());
+        Gradient full(_nPar);
+        incrementGradCount();
+        value = (*functionAndGradient)(_params,full);
+        gradient->resize(nFloating);
+        for(int i = 0; i < nFloating; ++i) (*gradient)[i] = _scale[i]*full[_floatingIndex[i]];
+    }
+    else {
+        value = (*_f)(_params);
+        if(gradient) _calculateGradient(z,value,*gradient);
+    }
+    return (boost::math::isfinite)(value) ? value : lbfgsb::infinity;
+}
+
+void local::LbfgsbEngine::_calculateGradient(std::vector<double> const &z, double value,
+std::vector<double> &gradient) const {
+    int nFloating(_floatingIndex.size());
+    gradient.resize(nFloating);
+    if(_gc) {
+        Gradient full(_nPar);
+        _setParameters(z);
+        incrementGradCount();
+        (*_gc)(_params,full);
+        for(int i = 0; i < nFloating; ++i) gradient[i] = _scale[i]*full[_floatingIndex[i]];
+        return;
+    }
+    // Estimate the gradient with finite differences that stay within our bounds, using a
+    // step of 1e-4 initial errors, or less near a bound.
+    std::vector<double> shifted(z);
+    for(int i = 0; i < nFloating; ++i) {
+        double step(1e-4), up(std::min(z[i] + step,_zUpper[i])),
+            down(std::max(z[i] - step,_zLower[i]));
+        double fUp(value), fDown(value);
+        if(up > z[i]) {
+            shifted[i] = up;
+            fUp = _evaluate(shifted,0);
+        }
+        if(down < z[i]) {
+            shifted[i] = down;
+            fDown = _evaluate(shifted,0);
+        }
+        shifted[i] = z[i];
+        gradient[i] = (up > down) ? (fUp - fDown)/(up - down) : 0;
+    }
+    _setParameters(z);
+}
+
+void local::LbfgsbEngine::minimize(FunctionMinimumPtr fmin, double prec, long maxEvals) {
+    // Work with the floating parameters, scaled by their initial errors.
+    _params = fmin->getParameters();
+    Parameters errors(fmin->getErrors());
+    _floatingIndex.clear();
+    _scale.clear();
+    _zLower.clear();
+    _zUpper.clear();
+    for(int index = 0; index < _nPar; ++index) {
+        if(errors[index] <= 0) continue;
+        _floatingIndex.push_back(index);
+        _scale.push_back(errors[index]);
+        _zLower.push_back(_lower[index]/errors[index]);
+        _zUpper.push_back(_upper[index]/errors[index]);
+    }
+    int n(_floatingIndex.size());
+    if(0 == n) {
+        throw RuntimeError("LbfgsbEngine: number of floating parameters must be > 0.");
+    }
+    // Start from the initial parameter values, projected onto our bounds.
+    std::vector<double> x(n), g, xcp, c, xbar, d(n), xTrial(n), gTrial, s(n), y(n);
+    for(int i = 0; i < n; ++i) {
+        x[i] = std::min(_zUpper[i],std::max(_zLower[i],_params[_floatingIndex[i]]/_scale[i]));
+    }
+    double fval(_evaluate(x,&g));
+    if(fval == lbfgsb::infinity) {
+        throw RuntimeError("LbfgsbEngine: function is not finite at the initial parameters.");
+    }
+    double gradientTolerance(prec > 0 ? prec : 1e-3);
+    // Stop when an iteration reduces the function by less than this relative amount, which
+    // is the default "moderate accuracy" used by the original L-BFGS-B code.
+    double functionTolerance(1e7*lbfgsb::epsilon);
+    lbfgsb::Memory memory(_memorySize);
+    bool converged(false), failed(false);
+    while(!converged && !failed) {
+        if(lbfgsb::projectedGradientNorm(x,g,_zLower,_zUpper) <= gradientTolerance) {
+            converged = true;
+            break;
+        }
+        if(maxEvals > 0 && getEvalCount() >= maxEvals) break;
+        // Find a search direction from the Cauchy point and subspace minimization. If this
+        // is not a descent direction, forget our corrections and try again.
+        double slope(0);
+        for(int attempt = 0; attempt < 2; ++attempt) {
+            lbfgsb::cauchyPoint(x,g,_zLower,_zUpper,memory,xcp,c);
+            lbfgsb::subspaceMinimum(x,g,_zLower,_zUpper,memory,xcp,c,xbar);
+            for(int i = 0; i < n; ++i) d[i] = xbar[i] - x[i];
+            slope = lbfgsb::dot(g,d);
+            if(slope < 0 || 0 == memory.getK()) break;
+            memory.reset();
+        }
+        if(slope >= 0) {
+            converged = true;
+            break;
+        }
+        // Take at most a unit step in the scaled parameters until we have some curvature
+        // information, then start from the full quasi-Newton step.
+        double step(1);
+        if(0 == memory.getK()) step = std::min(1.,1/std::sqrt(lbfgsb::dot(d,d)));
+        // Backtrack until the Armijo sufficient decrease condition is met. Every trial point
+        // lies between x and xbar, so stays within our bounds. Only the first trial, which
+        // is usually accepted, uses any fused evaluator, and other trials only calculate a
+        // gradient once they are accepted.
+        double fTrial(0);
+        bool accepted(false);
+        for(int trial = 0; trial < 20; ++trial) {
+            for(int i = 0; i < n; ++i) {
+                xTrial[i] = std::min(_zUpper[i],std::max(_zLower[i],x[i] + step*d[i]));
+            }
+            bool fused(0 == trial && functionAndGradient);
+            fTrial = _evaluate(xTrial,fused ? &gTrial : 0);
+            if(fTrial <= fval + 1e-4*step*slope) {
+                if(!fused) _calculateGradient(xTrial,fTrial,gTrial);
+                accepted = true;
+                break;
+            }
+            if(maxEvals > 0 && getEvalCount() >= maxEvals) break;
+            // Use the minimum of a quadratic fit, limited to [0.1,0.5] of the current step.
+            double next(0.5*step);
+            if(fTrial < lbfgsb::infinity) {
+                double curvature(fTrial - fval - step*slope);
+                if(curvature > 0) next = -0.5*slope*step*step/curvature;
+            }
+            step = std::min(0.5*step,std::max(0.1*step,next));
+        }
+        if(!accepted) {
+            if(memory.getK() > 0) {
+                // Try again with steepest descent.
+                memory.reset();
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        for(int i = 0; i < n; ++i) {
+            s[i] = xTrial[i] - x[i];
+            y[i] = gTrial[i] - g[i];
+        }
+        double reduction(fval - fTrial);
+        x.swap(xTrial);
+        g.swap(gTrial);
+        fval = fTrial;
+        memory.add(s,y);
+        if(reduction <= functionTolerance*std::max(1.,std::max(std::fabs(fval),std::fabs(fval+reduction)))) {
+            converged = true;
+        }
+    }
+    // Save the best point found.
+    _setParameters(x);
+    fmin->updateParameterValues(fval,_params);
+    if(failed) {
+        fmin->setStatus(FunctionMinimum::WARNING,"Line search failed.");
+    }
+    else if(!converged) {
+        fmin->setStatus(FunctionMinimum::WARNING,"Maximum number of evaluations reached.");
+    }
+}
+
+void local::registerLbfgsbEngineMethods() {
+    static bool registered = false;
+    if(registered) return;
+    // Create a function object that constructs an LbfgsbEngine with parameters
+    // (FunctionPtr f, GradientCalculatorPtr gc, FitParameters const &parameters,
+    // std::string const &methodName).
+    EngineFactory factory = boost::bind(boost::factory<LbfgsbEngine*>(),_1,_2,_3,_4);
+    // Register our minimization methods.
+    getEngineRegistry()["lbfgsb"] = factory;
+    registered = true;
+}
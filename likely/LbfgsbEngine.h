@@ -0,0 +1,66 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_LBFGSB_ENGINE
+#define LIKELY_LBFGSB_ENGINE
+
+#include "likely/types.h"
+#include "likely/AbsEngine.h"
+
+#include <string>
+#include <vector>
+
+namespace likely {
+    // Implements the L-BFGS-B limited memory quasi-Newton method for minimization subject to
+    // bounds (Byrd, Lu, Nocedal & Zhu 1995), using the generalized Cauchy point and direct
+    // primal subspace minimization of the original paper, with a backtracking line search.
+    // Each floating parameter with a box prior is bounded by the prior's min and max, so the
+    // function is never evaluated outside of them, and other parameters are unbounded.
+    // Parameters are scaled by their initial errors. Gradients are calculated with the fused
+    // function and gradient evaluator or else the gradient calculator, when either is
+    // available, or else by finite differences. Algorithms are named m<N> to keep the N most
+    // recent correction pairs, e.g., "lbfgsb::m10", and use O(N*npar) memory.
+	class LbfgsbEngine : public AbsEngine {
+	public:
+	    // Creates a new engine for the specified function of the specified parameters.
+		LbfgsbEngine(FunctionPtr f, GradientCalculatorPtr gc, FitParameters const &parameters,
+            std::string const &algorithm);
+		virtual ~LbfgsbEngine();
+		// Searches for a minimum starting from the parameter values of the specified function
+		// minimum, which is then updated with the best point found. Stops when the largest
+		// projected gradient component, in units of function change per initial error, is
+		// at most prec, when an iteration no longer reduces the function significantly, or
+		// after maxEvals function evaluations (when maxEvals > 0).
+        void minimize(FunctionMinimumPtr fmin, double prec, long maxEvals);
+        // Returns the number of correction pairs kept by this engine.
+        int getMemorySize() const;
+	private:
+        int _nPar, _memorySize;
+        FunctionPtr _f;
+        GradientCalculatorPtr _gc;
+        // The lower and upper bound of each parameter, which are infinite for parameters
+        // without a box prior.
+        Parameters _lower, _upper;
+        // Sets _params to the specified scaled floating parameter values, clamped to our bounds.
+        void _setParameters(std::vector<double> const &z) const;
+        // Evaluates our function at the specified scaled floating parameter values, and
+        // fills the gradient with respect to them when it is not null. Returns +infinity if
+        // the function value is not finite.
+        double _evaluate(std::vector<double> const &z, std::vector<double> *gradient) const;
+        // Fills the gradient with respect to the specified scaled floating parameter values,
+        // where our function has the specified value, without using any fused evaluator.
+        void _calculateGradient(std::vector<double> const &z, double value,
+            std::vector<double> &gradient) const;
+        // State used by _evaluate during minimize.
+        mutable Parameters _params;
+        std::vector<int> _floatingIndex;
+        std::vector<double> _scale, _zLower, _zUpper;
+	}; // LbfgsbEngine
+
+    inline int LbfgsbEngine::getMemorySize() const { return _memorySize; }
+
+    // Registers our named methods.
+    void registerLbfgsbEngineMethods();
+
+} // likely
+
+#endif // LIKELY_LBFGSB_ENGINE
@@ -0,0 +1,185 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/LikelihoodSurrogate.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/math/special_functions/fpclassify.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+
+// Declare the LAPACK routines we use.
+// http://www.netlib.org/lapack/double/dpotrf.f
+// http://www.netlib.org/lapack/double/dpotrs.f
+extern "C" {
+    // Cholesky decomposition of a symmetric positive definite matrix
+    void dpotrf_(char const *uplo, int const *n, double *a, int const *lda, int *info);
+    // Solves A.X = B using the Cholesky decomposition of A from dpotrf
+    void dpotrs_(char const *uplo, int const *n, int const *nrhs, double const *a,
+        int const *lda, double *b, int const *ldb, int *info);
+}
+
+namespace local = likely;
+
+local::LikelihoodSurrogate::LikelihoodSurrogate(FitParameters const &parameters, int nNeighbors)
+: _parameters(parameters), _nNeighbors(nNeighbors)
+{
+    for(int index = 0; index < _parameters.size(); ++index) {
+        FitParameter const &par(_parameters[index]);
+        if(!par.isFloating()) continue;
+        _floatingIndex.push_back(index);
+        _errors.push_back(par.getError());
+    }
+    _nFloating = _floatingIndex.size();
+    if(0 == _nFloating) {
+        throw RuntimeError("LikelihoodSurrogate: no floating parameters.");
+    }
+    _nCoefs = 1 + _nFloating + (_nFloating*(_nFloating+1))/2;
+    if(0 == _nNeighbors) _nNeighbors = 2*_nCoefs;
+    if(_nNeighbors <= _nCoefs) {
+        throw RuntimeError("LikelihoodSurrogate: need more neighbors than quadratic coefficients.");
+    }
+}
+
+local::LikelihoodSurrogate::~LikelihoodSurrogate() { }
+
+void local::LikelihoodSurrogate::_scale(Parameters const &values,
+std::vector<double> &scaled) const {
+    if(values.size() != _parameters.size()) {
+        throw RuntimeError("LikelihoodSurrogate: got wrong number of parameter values.");
+    }
+    scaled.resize(_nFloating);
+    for(int k = 0; k < _nFloating; ++k) scaled[k] = values[_floatingIndex[k]]/_errors[k];
+}
+
+void local::LikelihoodSurrogate::addSample(Parameters const &values, double nll) {
+    if(!(boost::math::isfinite)(nll)) return;
+    std::vector<double> scaled;
+    _scale(values,scaled);
+    _points.insert(_points.end(),scaled.begin(),scaled.end());
+    _values.push_back(nll);
+}
+
+void local::LikelihoodSurrogate::addTrial(Parameters const &/*current*/, Parameters const &trial,
+double /*currentNLL*/, double trialNLL, bool /*accepted*/) {
+    addSample(trial,trialNLL);
+}
+
+double local::LikelihoodSurrogate::evaluate(Parameters const &values, double &error) const {
+    std::vector<double> query;
+    _scale(values,query);
+    int nSamples(_values.size());
+    error = std::numeric_limits<double>::infinity();
+    if(0 == nSamples) return 0;
+    // Sort our samples by their scaled distance from the query point.
+    std::vector<std::pair<double,int> > byDistance(nSamples);
+    for(int i = 0; i < nSamples; ++i) {
+        double const *point = &_points[i*_nFloating];
+        double dsq(0);
+        for(int k = 0; k < _nFloating; ++k) {
+            double delta(point[k] - query[k]);
+            dsq += delta*delta;
+        }
+        byDistance[i] = std::make_pair(dsq,i);
+    }
+    int nFit(std::min(_nNeighbors,nSamples));
+    std::nth_element(byDistance.begin(),byDistance.begin()+nFit-1,byDistance.end());
+    double nearestValue = _values[std::min_element(byDistance.begin(),byDistance.begin()+nFit)->second];
+    if(nSamples < getMinSamples()) return nearestValue;
+    // Calculate tricube weights out to just beyond our most distant neighbor, normalized
+    // to a mean weight of one.
+    double rmax(1.01*std::sqrt(byDistance[nFit-1].first));
+    if(0 == rmax) return nearestValue;
+    std::vector<double> weights(nFit);
+    double wsum(0);
+    for(int i = 0; i < nFit; ++i) {
+        double r(std::sqrt(byDistance[i].first)/rmax);
+        double t(1 - r*r*r);
+        weights[i] = t*t*t;
+        wsum += weights[i];
+    }
+    for(int i = 0; i < nFit; ++i) weights[i] *= nFit/wsum;
+    // Build the quadratic design matrix using coordinates relative to the query point, so
+    // that the first coefficient is the emulated value.
+    std::vector<double> design(nFit*_nCoefs);
+    for(int i = 0; i < nFit; ++i) {
+        double const *point = &_points[byDistance[i].second*_nFloating];
+        double *row = &design[i*_nCoefs];
+        int col(0);
+        row[col++] = 1;
+        for(int k = 0; k < _nFloating; ++k) row[col++] = point[k] - query[k];
+        for(int k1 = 0; k1 < _nFloating; ++k1) {
+            for(int k2 = 0; k2 <= k1; ++k2) row[col++] = row[1+k1]*row[1+k2];
+        }
+    }
+    // Build the weighted normal equations with a small ridge term for stability. The
+    // right-hand side has two columns, for the coefficients and for the variance of the
+    // emulated value.
+    std::vector<double> normal(_nCoefs*_nCoefs,0), rhs(2*_nCoefs,0);
+    for(int i = 0; i < nFit; ++i) {
+        double const *row = &design[i*_nCoefs];
+        double wy(weights[i]*_values[byDistance[i].second]);
+        for(int c1 = 0; c1 < _nCoefs; ++c1) {
+            double wa(weights[i]*row[c1]);
+            rhs[c1] += wy*row[c1];
+            for(int c2 = c1; c2 < _nCoefs; ++c2) normal[c1*_nCoefs + c2] += wa*row[c2];
+        }
+    }
+    double maxDiag(0);
+    for(int c = 0; c < _nCoefs; ++c) maxDiag = std::max(maxDiag,normal[c*_nCoefs + c]);
+    for(int c = 0; c < _nCoefs; ++c) normal[c*_nCoefs + c] += 1e-12*maxDiag;
+    rhs[_nCoefs] = 1;
+    // Solve the normal equations. We have filled the upper triangle in row-major order,
+    // which is the lower triangle in LAPACK's column-major order.
+    char uplo('L');
+    int nrhs(2), info(0);
+    dpotrf_(&uplo,&_nCoefs,&normal[0],&_nCoefs,&info);
+    if(0 != info) return nearestValue;
+    dpotrs_(&uplo,&_nCoefs,&nrhs,&normal[0],&_nCoefs,&rhs[0],&_nCoefs,&info);
+    if(0 != info) return nearestValue;
+    // Estimate the residual variance of the fit.
+    if(nFit > _nCoefs) {
+        double wrsq(0);
+        for(int i = 0; i < nFit; ++i) {
+            double const *row = &design[i*_nCoefs];
+            double residual(_values[byDistance[i].second]);
+            for(int c = 0; c < _nCoefs; ++c) residual -= row[c]*rhs[c];
+            wrsq += weights[i]*residual*residual;
+        }
+        double variance(wrsq/(nFit - _nCoefs)*rhs[_nCoefs]);
+        if(variance >= 0) error = std::sqrt(variance);
+    }
+    return rhs[0];
+}
+
+namespace likely {
+namespace surrogate {
+    // Evaluates a surrogate where it is precise enough and otherwise the true function.
+    class ScreenedFunction {
+    public:
+        ScreenedFunction(LikelihoodSurrogatePtr surrogate, FunctionPtr f, double maxError)
+        : _surrogate(surrogate), _f(f), _maxError(maxError) { }
+        double operator()(Parameters const &values) const {
+            double error, value(_surrogate->evaluate(values,error));
+            if(error <= _maxError) return value;
+            value = (*_f)(values);
+            _surrogate->addSample(values,value);
+            return value;
+        }
+    private:
+        LikelihoodSurrogatePtr _surrogate;
+        FunctionPtr _f;
+        double _maxError;
+    }; // ScreenedFunction
+}} // likely::surrogate
+
+local::FunctionPtr local::createScreenedFunction(LikelihoodSurrogatePtr surrogate,
+FunctionPtr f, double maxError) {
+    if(!surrogate || !f) {
+        throw RuntimeError("createScreenedFunction: missing surrogate or function.");
+    }
+    FunctionPtr screened(new Function(surrogate::ScreenedFunction(surrogate,f,maxError)));
+    return screened;
+}
@@ -0,0 +1,68 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_LIKELIHOOD_SURROGATE
+#define LIKELY_LIKELIHOOD_SURROGATE
+
+#include "likely/types.h"
+#include "likely/FitParameter.h"
+
+#include <vector>
+
+namespace likely {
+    // Emulates an expensive -log(likelihood) function using a history of previous evaluations.
+    // The emulated value at any point is obtained from a weighted quadratic least-squares fit
+    // to the nearest previous evaluations, measuring distances in the space of floating
+    // parameters scaled by their errors. An estimated uncertainty is provided with each
+    // emulated value, so that the true function only needs to be called where the emulator
+    // is uncertain (see createScreenedFunction below).
+	class LikelihoodSurrogate {
+	public:
+	    // Creates a new surrogate for a function of the specified parameters. Only floating
+	    // parameters are emulated, and fixed parameters are assumed to keep their values.
+	    // Each emulated value is fit to nNeighbors previous evaluations, or else twice the
+	    // number of quadratic coefficients when nNeighbors is zero.
+		LikelihoodSurrogate(FitParameters const &parameters, int nNeighbors = 0);
+		virtual ~LikelihoodSurrogate();
+        // Records the function value at the specified point, which includes values for
+        // all parameters (floating and fixed). Non-finite values are ignored.
+        void addSample(Parameters const &values, double nll);
+        // Records a trial from a MarkovChainEngine::generate callback. Use this method
+        // with boost::bind(&LikelihoodSurrogate::addTrial,surrogate,_1,_2,_3,_4,_5).
+        void addTrial(Parameters const &current, Parameters const &trial,
+            double currentNLL, double trialNLL, bool accepted);
+        // Returns the number of function values recorded so far.
+        int getNSamples() const;
+        // Returns the minimum number of recorded samples needed for emulated values.
+        int getMinSamples() const;
+        // Returns the emulated function value at the specified point and sets error to
+        // its estimated uncertainty. When too few samples are available or the fit fails,
+        // returns the value at the nearest sample (or zero if there are none) with an
+        // infinite error.
+        double evaluate(Parameters const &values, double &error) const;
+        // Returns the emulated function value at the specified point, so that this object
+        // can be used as a Function.
+        double operator()(Parameters const &values) const;
+	private:
+        void _scale(Parameters const &values, std::vector<double> &scaled) const;
+        FitParameters _parameters;
+        int _nFloating, _nCoefs, _nNeighbors;
+        std::vector<int> _floatingIndex;
+        std::vector<double> _errors, _points, _values;
+	}; // LikelihoodSurrogate
+
+    inline int LikelihoodSurrogate::getNSamples() const { return _values.size(); }
+    inline int LikelihoodSurrogate::getMinSamples() const { return _nCoefs + 1; }
+    inline double LikelihoodSurrogate::operator()(Parameters const &values) const {
+        double error;
+        return evaluate(values,error);
+    }
+
+    // Returns a function that uses the specified surrogate wherever its estimated uncertainty
+    // is at most maxError, and otherwise evaluates the true function f and records the
+    // result in the surrogate. The returned function keeps the surrogate and f alive.
+    FunctionPtr createScreenedFunction(LikelihoodSurrogatePtr surrogate, FunctionPtr f,
+        double maxError);
+
+} // likely
+
+#endif // LIKELY_LIKELIHOOD_SURROGATE
@@ -15,6 +15,7 @@
 #include "boost/functional/factory.hpp"
 #include "boost/bind.hpp"
 
+#include <limits>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -53,11 +54,22 @@ FitParameters const &parameters, std::string const &algorithm, RandomPtr random)
 
 local::MarkovChainEngine::~MarkovChainEngine() { }
 
+void local::MarkovChainEngine::setApproximateFunction(FunctionPtr approx) {
+    _approx = approx;
+}
+
+void local::MarkovChainEngine::setThresholdFunction(ThresholdFunction thresholdFunction) {
+    _thresholdFunction = thresholdFunction;
+}
+
 int local::MarkovChainEngine::generate(FunctionMinimumPtr fmin, int nAccepts,
 int maxTrials, Callback callback, int callbackInterval) const {
     // Set our initial parameters to the estimated function minimum.
     Parameters current(fmin->getParameters());
     double currentNLL(fmin->getMinValue());
+    // Evaluate our approximate function at the starting point, if necessary.
+    double currentApprox(0), trialApprox(0);
+    if(_approx) currentApprox = (*_approx)(current);
     
     // Our starting point is our current best guess at the minimum.
     Parameters minParams(current);
@@ -76,22 +88,55 @@ int maxTrials, Callback callback, int callbackInterval) const {
         nTrials++;
         // Take a trial step sampled from the estimated function minimum's covariance.
         fmin->setRandomParameters(current, trial);
-        // Evaluate the true NLL at this trial point.
-        double trialNLL((*_f)(trial));
-        incrementEvalCount();
-        // Is this a new minimum?
-        if(trialNLL < minNLL) {
-            minParams = trial;
-            minNLL = trialNLL;
+        double logProbRatio(0);
+        bool screened(true);
+        if(_approx) {
+            // Screen this trial step using our approximate function.
+            trialApprox = (*_approx)(trial);
+            logProbRatio = currentApprox - trialApprox;
+            screened = (logProbRatio >= 0 || _random->getUniform() < std::exp(logProbRatio));
         }
-	    double logProbRatio(currentNLL-trialNLL);
-	    // Do we accept this trial step?
+        double trialNLL(std::numeric_limits<double>::quiet_NaN());
         bool accepted(false);
-        if(logProbRatio >= 0 || _random->getUniform() < std::exp(logProbRatio)) {
-            current = trial;
-            currentNLL = trialNLL;
-            accepted = true;
-            remaining--;
+        if(screened && _thresholdFunction) {
+            // Draw our uniform random number first to calculate the NLL threshold above
+            // which this trial will be rejected, correcting for the screening probability
+            // of the approximate function, if any.
+            double threshold(currentNLL - logProbRatio - std::log(_random->getUniform()));
+            trialNLL = _thresholdFunction(trial,threshold);
+            incrementEvalCount();
+            // Only accepted trials are guaranteed to have their exact NLL value.
+            if(trialNLL < threshold) {
+                if(trialNLL < minNLL) {
+                    minParams = trial;
+                    minNLL = trialNLL;
+                }
+                current = trial;
+                currentNLL = trialNLL;
+                currentApprox = trialApprox;
+                accepted = true;
+                remaining--;
+            }
+        }
+        else if(screened) {
+            // Evaluate the true NLL at this trial point.
+            trialNLL = (*_f)(trial);
+            incrementEvalCount();
+            // Is this a new minimum?
+            if(trialNLL < minNLL) {
+                minParams = trial;
+                minNLL = trialNLL;
+            }
+            // Correct for the screening probability of the approximate function, if any.
+            logProbRatio = (currentNLL - trialNLL) - logProbRatio;
+            // Do we accept this trial step?
+            if(logProbRatio >= 0 || _random->getUniform() < std::exp(logProbRatio)) {
+                current = trial;
+                currentNLL = trialNLL;
+                currentApprox = trialApprox;
+                accepted = true;
+                remaining--;
+            }
         }
         // Invoke the callback now, if any.
         if(callback && (0 == nTrials%callbackInterval)) {
@@ -145,6 +190,55 @@ int acceptsPerParam, int maxTrialsPerParam) {
     }
 }
 
+namespace likely {
+namespace mcmc {
+    // Evaluates a quadratic approximation to a function using the eigenmodes of a covariance.
+    class GaussianApproximation {
+    public:
+        GaussianApproximation(FunctionMinimumCPtr fmin, int nModes)
+        : _fmin(fmin), _minValue(fmin->getMinValue()), _center(fmin->getParameters(true))
+        {
+            if(!fmin->hasCovariance()) {
+                throw RuntimeError("createGaussianApproximation: no covariance matrix available.");
+            }
+            _size = _center.size();
+            if(nModes < 0 || nModes > _size) {
+                throw RuntimeError("createGaussianApproximation: invalid number of modes.");
+            }
+            if(0 == nModes) nModes = _size;
+            // Keep the best constrained modes, which are listed last.
+            std::vector<double> eigenvalues, eigenvectors;
+            fmin->getCovariance()->getEigenModes(eigenvalues,eigenvectors);
+            _eigenvalues.assign(eigenvalues.end()-nModes,eigenvalues.end());
+            _eigenvectors.assign(eigenvectors.end()-nModes*_size,eigenvectors.end());
+        }
+        double operator()(Parameters const &values) const {
+            _fmin->filterParameterValues(values,_delta);
+            for(int j = 0; j < _size; ++j) _delta[j] -= _center[j];
+            double chi2(0);
+            std::vector<double>::const_iterator next(_eigenvectors.begin());
+            for(int i = 0; i < _eigenvalues.size(); ++i) {
+                double dotprod(0);
+                for(int j = 0; j < _size; ++j) dotprod += (*next++)*_delta[j];
+                chi2 += dotprod*dotprod*_eigenvalues[i];
+            }
+            return _minValue + 0.5*chi2;
+        }
+    private:
+        FunctionMinimumCPtr _fmin;
+        double _minValue;
+        int _size;
+        Parameters _center;
+        std::vector<double> _eigenvalues, _eigenvectors;
+        mutable Parameters _delta;
+    }; // GaussianApproximation
+}} // likely::mcmc
+
+local::FunctionPtr local::createGaussianApproximation(FunctionMinimumCPtr fmin, int nModes) {
+    FunctionPtr approx(new Function(mcmc::GaussianApproximation(fmin,nModes)));
+    return approx;
+}
+
 void local::registerMarkovChainEngineMethods() {
     static bool registered = false;
     if(registered) return;
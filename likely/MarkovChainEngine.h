@@ -28,15 +28,43 @@ namespace likely {
 	    // are the current and trial parameters, the function values at these parameters,
 	    // and a boolean to flag if the trial is accepted. The callback is invoked every
 	    // callbackInterval steps, with the first call after callbackInterval steps.
+	    // When an approximate function is being used (see below), trials that are rejected
+	    // without evaluating the true function are passed to the callback with a NaN value.
         typedef boost::function<void (Parameters const&, Parameters const&, double, double, bool)> Callback;
         int generate(FunctionMinimumPtr fmin, int nAccepts, int maxTrials,
             Callback callback = Callback(), int callbackInterval = 1) const;
+        // Uses the specified cheap approximation to our function to screen each trial
+        // before evaluating the true function (delayed-acceptance Metropolis). A trial is
+        // first accepted with probability min(1,exp(approx(current)-approx(trial))) and,
+        // only if it passes, the true function is evaluated and the trial is then accepted
+        // with probability min(1,exp(dNLL-dApprox)) which preserves detailed balance with
+        // respect to the true function. The approximation should track the true function
+        // up to a constant offset. Pass an empty pointer to revert to normal Metropolis.
+        void setApproximateFunction(FunctionPtr approx);
+        // Uses the specified threshold-aware function in place of our function to evaluate
+        // trials in generate(). A ThresholdFunction is called with parameter values and a
+        // threshold, and must return the same value as our function if it is <= threshold,
+        // or else any value > threshold. The uniform random number for each Metropolis test
+        // is drawn first to determine the threshold above which a trial will be rejected,
+        // so that the evaluation can stop early (see BinnedData::chiSquareWithThreshold).
+        // In this mode, rejected trials may be passed to the generate callback with a lower
+        // bound on their function value. Pass an empty function to revert to normal mode.
+        typedef boost::function<double (Parameters const&, double)> ThresholdFunction;
+        void setThresholdFunction(ThresholdFunction thresholdFunction);
 	private:
         int _nParam,_nFloating;
-        FunctionPtr _f;
+        FunctionPtr _f, _approx;
+        ThresholdFunction _thresholdFunction;
         mutable RandomPtr _random;
 	}; // MarkovChainEngine
 
+    // Returns a quadratic approximation to the function that a FunctionMinimum describes,
+    // using its minimum value and covariance. When nModes > 0, only the nModes best
+    // constrained eigenmodes of the covariance contribute, which is cheaper to evaluate
+    // when there are many floating parameters. The returned function is suitable for
+    // MarkovChainEngine::setApproximateFunction and does not track later changes to fmin.
+    FunctionPtr createGaussianApproximation(FunctionMinimumCPtr fmin, int nModes = 0);
+
     // Registers our named methods.
     void registerMarkovChainEngineMethods();
 
@@ -28,7 +28,8 @@ namespace mn = ROOT::Minuit2;
 
 local::MinuitEngine::MinuitEngine(FunctionPtr f, GradientCalculatorPtr gc,
 FitParameters const &parameters, std::string const &algorithm)
-: _nPar(parameters.size()), _f(f), _gc(gc), _initialState(new mn::MnUserParameterState())
+: _nPar(parameters.size()), _f(f), _gc(gc), _useGradient(false),
+_initialState(new mn::MnUserParameterState())
 {
     if(_nPar <= 0) {
         throw RuntimeError("MinuitEngine: number of parameters must be > 0.");
@@ -82,6 +83,7 @@ FitParameters const &parameters, std::string const &algorithm)
                 "MinuitEngine: selected algorithm needs a gradient calculator.");
         }
     }
+    _useGradient = useGradient;
 }
 
 local::MinuitEngine::~MinuitEngine() { }
@@ -98,7 +100,12 @@ double local::MinuitEngine::operator()(Parameters const &pValues) const {
 local::Gradient local::MinuitEngine::Gradient(Parameters const& pValues) const {
     local::Gradient grad(_nPar);
     incrementGradCount();
-    (*_gc)(pValues,grad);
+    if(_useGradient && functionAndGradient) {
+        (*functionAndGradient)(pValues,grad);
+    }
+    else {
+        (*_gc)(pValues,grad);
+    }
     return grad;
 }
 
@@ -28,7 +28,11 @@ namespace likely {
 		virtual ~MinuitEngine();
 		// Evaluates the engine's function for the specified input parameter values.
         virtual double operator()(Parameters const& pValues) const;
-        // Evaluates the function gradient for the specified input parameters.
+        // Evaluates the function gradient for the specified input parameters. When a
+        // gradient algorithm has a fused function and gradient evaluator, this uses it and
+        // discards the function value. Minuit2 always asks for the value at a point before
+        // its gradient, so the fused value is never reused and the fused evaluator simply
+        // replaces the gradient calculator.
         // (Use likely::Gradient below to distinguish from the method name)
         virtual likely::Gradient Gradient(Parameters const& pValues) const;
         virtual bool CheckGradient() const;
@@ -46,6 +50,7 @@ namespace likely {
         int _nPar;
         FunctionPtr _f;
         GradientCalculatorPtr _gc;
+        bool _useGradient;
         StatePtr _initialState;
         void _setInitialState(FunctionMinimumPtr fmin);
 	}; // MinuitEngine
@@ -0,0 +1,328 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/NestedSamplingEngine.h"
+#include "likely/FunctionMinimum.h"
+#include "likely/Random.h"
+#include "likely/ThreadPool.h"
+#include "likely/ChainReweighter.h"
+#include "likely/EngineRegistry.h"
+#include "likely/CovarianceMatrix.h"
+#include "likely/CovarianceAccumulator.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/math/distributions/normal.hpp"
+#include "boost/math/special_functions/fpclassify.hpp"
+#include "boost/functional/factory.hpp"
+#include "boost/lexical_cast.hpp"
+#include "boost/bind.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+
+namespace local = likely;
+
+namespace likely {
+namespace nested {
+    // Returns log(exp(a) + exp(b)) without overflow.
+    double logAddExp(double a, double b) {
+        if(a < b) std::swap(a,b);
+        if(b == -std::numeric_limits<double>::infinity()) return a;
+        return a + std::log1p(std::exp(b - a));
+    }
+    // Accumulates the evidence and information using Skilling's update formulas.
+    void updateEvidence(double logL, double logWeight, double &logZ, double &information) {
+        if(logWeight == -std::numeric_limits<double>::infinity()) return;
+        double logZnew(logAddExp(logZ,logWeight));
+        if(logZ == -std::numeric_limits<double>::infinity()) {
+            information = std::exp(logWeight - logZnew)*logL - logZnew;
+        }
+        else {
+            information = std::exp(logWeight - logZnew)*logL +
+                std::exp(logZ - logZnew)*(information + logZ) - logZnew;
+        }
+        logZ = logZnew;
+    }
+    // Records a discarded point with its parameter values, log(L) and log(weight).
+    struct DeadPoint {
+        DeadPoint(Parameters const &v, double l, double w) : values(v), logL(l), logWeight(w) { }
+        Parameters values;
+        double logL, logWeight;
+    };
+}} // likely::nested
+
+local::NestedSamplingEngine::NestedSamplingEngine(FunctionPtr f, GradientCalculatorPtr gc,
+FitParameters const &parameters, std::string const &algorithm, RandomPtr random, ThreadPoolPtr pool)
+: _f(f), _parameters(parameters), _random(random), _pool(pool),
+_logZ(-std::numeric_limits<double>::infinity()), _logZError(0), _information(0)
+{
+    // Build our transform from the unit hypercube using the prior of each floating parameter.
+    for(int index = 0; index < _parameters.size(); ++index) {
+        FitParameter const &par(_parameters[index]);
+        if(!par.isFloating()) continue;
+        double pmin(par.getPriorMin()), pmax(par.getPriorMax());
+        if(par.getPriorType() == FitParameter::BoxPrior) {
+            _center.push_back(pmin);
+            _width.push_back(pmax - pmin);
+            _gaussian.push_back(false);
+        }
+        else if(par.getPriorType() == FitParameter::GaussPrior) {
+            _center.push_back(0.5*(pmin + pmax));
+            _width.push_back(0.5*par.getPriorScale()*(pmax - pmin));
+            _gaussian.push_back(true);
+        }
+        else {
+            throw RuntimeError("NestedSamplingEngine: floating parameter '" + par.getName() +
+                "' has no prior.");
+        }
+        _floatingIndex.push_back(index);
+    }
+    _nFloating = _floatingIndex.size();
+    if(0 == _nFloating) {
+        throw RuntimeError("NestedSamplingEngine: number of floating parameters must be > 0.");
+    }
+    // Parse the number of live points from our algorithm name.
+    _nLive = 0;
+    if(0 == algorithm.find("live")) {
+        try {
+            _nLive = boost::lexical_cast<int>(algorithm.substr(4));
+        }
+        catch(boost::bad_lexical_cast const &e) { }
+    }
+    if(_nLive <= 0) {
+        throw RuntimeError("NestedSamplingEngine: unknown algorithm '" + algorithm + "'");
+    }
+    if(_nLive <= 2*_nFloating) {
+        throw RuntimeError("NestedSamplingEngine: need more than 2 live points per floating parameter.");
+    }
+    _nSteps = std::max(20,3*_nFloating);
+    if(!_random) _random = Random::instance();
+    if(!_pool) _pool = getDefaultThreadPool();
+    minimumFinder = boost::bind(&NestedSamplingEngine::sample,this,_1,_2,_3);
+}
+
+local::NestedSamplingEngine::~NestedSamplingEngine() { }
+
+void local::NestedSamplingEngine::_transform(double const *unit, Parameters &values) const {
+    static boost::math::normal gauss;
+    for(int k = 0; k < _nFloating; ++k) {
+        double u(unit[k]);
+        double offset = _gaussian[k] ? boost::math::quantile(gauss,u) : u;
+        values[_floatingIndex[k]] = _center[k] + _width[k]*offset;
+    }
+}
+
+double local::NestedSamplingEngine::_evaluate(double const *unit, Parameters &values) const {
+    _transform(unit,values);
+    double logL(-(*_f)(values));
+    // Treat any invalid function value as zero likelihood.
+    return (boost::math::isnan)(logL) ? -std::numeric_limits<double>::infinity() : logL;
+}
+
+void local::NestedSamplingEngine::_evaluateRange(int first, int last) {
+    Parameters values;
+    getFitParameterValues(_parameters,values);
+    for(int index = first; index < last; ++index) {
+        _logL[index] = _evaluate(&_unit[index*_nFloating],values);
+    }
+}
+
+void local::NestedSamplingEngine::_walk(int slot, int start, double logLmin,
+CovarianceMatrixCPtr proposal, double scale) {
+    RandomPtr random(_walkRandom[slot]);
+    Parameters values;
+    getFitParameterValues(_parameters,values);
+    double *current(&_walkUnit[slot*_nFloating]);
+    std::copy(&_unit[start*_nFloating],&_unit[(start+1)*_nFloating],current);
+    double currentLogL(_logL[start]);
+    std::vector<double> trial(_nFloating), delta;
+    int nAccepted(0), nEvals(0);
+    for(int step = 0; step < _nSteps; ++step) {
+        // Propose a step using the live point covariance and reject it immediately if it
+        // falls outside the unit hypercube.
+        proposal->sample(delta,random);
+        bool inside(true);
+        for(int k = 0; k < _nFloating; ++k) {
+            trial[k] = current[k] + scale*delta[k];
+            if(trial[k] <= 0 || trial[k] >= 1) inside = false;
+        }
+        if(!inside) continue;
+        // Accept any step that satisfies our likelihood constraint.
+        double trialLogL(_evaluate(&trial[0],values));
+        nEvals++;
+        if(trialLogL > logLmin) {
+            std::copy(trial.begin(),trial.end(),current);
+            currentLogL = trialLogL;
+            nAccepted++;
+        }
+    }
+    _walkLogL[slot] = currentLogL;
+    _walkAccepted[slot] = nAccepted;
+    _walkEvals[slot] = nEvals;
+}
+
+void local::NestedSamplingEngine::sample(FunctionMinimumPtr fmin, double tolerance, long maxEvals) {
+    if(tolerance <= 0) {
+        throw RuntimeError("NestedSamplingEngine::sample: expected tolerance > 0.");
+    }
+    // Replace up to one live point per thread in each iteration, but few enough that
+    // the shrinkage of the prior volume remains well estimated.
+    int nSlots(std::max(1,std::min(_pool->getNThreads(),_nLive/10)));
+    _walkUnit.resize(nSlots*_nFloating);
+    _walkLogL.resize(nSlots);
+    _walkAccepted.resize(nSlots);
+    _walkEvals.resize(nSlots);
+    // Give each slot its own random generator so that results do not depend on the order
+    // in which threads run.
+    _walkRandom.resize(nSlots);
+    for(int slot = 0; slot < nSlots; ++slot) {
+        _walkRandom[slot].reset(new Random());
+        _walkRandom[slot]->setSeed(_random->getInteger(1,std::numeric_limits<int>::max()));
+    }
+    // Sample our initial live points from the prior and evaluate them in parallel.
+    _unit.resize(_nLive*_nFloating);
+    for(int index = 0; index < _unit.size(); ++index) {
+        double u;
+        do { u = _random->getUniform(); } while(u <= 0);
+        _unit[index] = u;
+    }
+    _logL.resize(_nLive);
+    _pool->parallelFor(0,_nLive,boost::bind(&NestedSamplingEngine::_evaluateRange,this,_1,_2));
+    long nEvals(_nLive);
+    for(int index = 0; index < _nLive; ++index) incrementEvalCount();
+
+    // Initialize our running estimates.
+    Parameters values;
+    getFitParameterValues(_parameters,values);
+    std::vector<nested::DeadPoint> dead;
+    double logX(0), logZ(-std::numeric_limits<double>::infinity()), information(0);
+    double scale(1);
+    CovarianceMatrixPtr proposal;
+    int sinceUpdate(_nLive);
+    std::vector<std::pair<double,int> > order(_nLive);
+    std::vector<bool> removed(_nLive);
+
+    while(maxEvals <= 0 || nEvals < maxEvals) {
+        // Update our proposal covariance from the live points periodically.
+        if(sinceUpdate >= _nLive/10) {
+            CovarianceAccumulator accumulator(_nFloating);
+            for(int index = 0; index < _nLive; ++index) accumulator.accumulate(&_unit[index*_nFloating]);
+            try {
+                CovarianceMatrixPtr C = accumulator.getCovariance();
+                C->getLogDeterminant();
+                proposal = C;
+            }
+            catch(RuntimeError const &e) {
+                if(!proposal) {
+                    // Use the covariance of the full unit hypercube.
+                    proposal.reset(new CovarianceMatrix(_nFloating));
+                    for(int k = 0; k < _nFloating; ++k) proposal->setCovariance(k,k,1./12.);
+                }
+            }
+            // Make sure the Cholesky decomposition is cached before we share this matrix
+            // between threads.
+            std::vector<double> delta;
+            proposal->sample(delta,_random);
+            sinceUpdate = 0;
+        }
+        // Find our nSlots lowest likelihood live points.
+        for(int index = 0; index < _nLive; ++index) order[index] = std::make_pair(_logL[index],index);
+        std::partial_sort(order.begin(),order.begin()+nSlots,order.end());
+        // Check if the remaining live points can still change our evidence significantly.
+        double logLmax(std::max_element(order.begin(),order.end())->first);
+        if(logZ > -std::numeric_limits<double>::infinity() &&
+            logLmax + logX - logZ < std::log(tolerance)) break;
+        // Discard the lowest points, in order, shrinking the prior volume by the expected
+        // fraction for each.
+        std::fill(removed.begin(),removed.end(),false);
+        for(int slot = 0; slot < nSlots; ++slot) {
+            int index(order[slot].second);
+            double logXnext(logX - 1./(_nLive - slot));
+            double logWeight(_logL[index] + logX + std::log1p(-std::exp(logXnext - logX)));
+            nested::updateEvidence(_logL[index],logWeight,logZ,information);
+            _transform(&_unit[index*_nFloating],values);
+            dead.push_back(nested::DeadPoint(values,_logL[index],logWeight));
+            logX = logXnext;
+            removed[index] = true;
+        }
+        // Replace the discarded points in parallel with constrained random walks starting
+        // from randomly chosen surviving points.
+        double logLmin(order[nSlots-1].first);
+        ThreadPool::TaskGroup group(*_pool);
+        for(int slot = 0; slot < nSlots; ++slot) {
+            int start;
+            do { start = _random->getInteger(0,_nLive-1); } while(removed[start]);
+            group.submit(boost::bind(&NestedSamplingEngine::_walk,this,slot,start,logLmin,
+                CovarianceMatrixCPtr(proposal),scale));
+        }
+        group.wait();
+        int nAccepted(0), nTried(0);
+        for(int slot = 0; slot < nSlots; ++slot) {
+            int index(order[slot].second);
+            std::copy(&_walkUnit[slot*_nFloating],&_walkUnit[(slot+1)*_nFloating],
+                &_unit[index*_nFloating]);
+            _logL[index] = _walkLogL[slot];
+            nAccepted += _walkAccepted[slot];
+            nTried += _walkEvals[slot];
+            for(int eval = 0; eval < _walkEvals[slot]; ++eval) incrementEvalCount();
+        }
+        nEvals += nTried;
+        sinceUpdate += nSlots;
+        // Adjust our step size towards a 50% acceptance rate.
+        double acceptance(nTried > 0 ? (double)nAccepted/nTried : 0);
+        scale *= std::exp(acceptance - 0.5);
+        scale = std::min(scale,1.);
+    }
+    // Add the remaining live points, which share the remaining prior volume equally.
+    for(int index = 0; index < _nLive; ++index) {
+        double logWeight(_logL[index] + logX - std::log((double)_nLive));
+        nested::updateEvidence(_logL[index],logWeight,logZ,information);
+        _transform(&_unit[index*_nFloating],values);
+        dead.push_back(nested::DeadPoint(values,_logL[index],logWeight));
+    }
+    if(!(boost::math::isfinite)(logZ)) {
+        throw RuntimeError("NestedSamplingEngine::sample: likelihood is zero everywhere.");
+    }
+    _logZ = logZ;
+    _information = information;
+    _logZError = std::sqrt(std::max(0.,information)/_nLive);
+
+    // Build our weighted posterior samples and find the best point.
+    _posterior.reset(new ChainReweighter(_parameters));
+    double minNLL(fmin->getMinValue());
+    Parameters minParams(fmin->getParameters());
+    for(std::vector<nested::DeadPoint>::const_iterator iter = dead.begin(); iter != dead.end(); ++iter) {
+        double weight(std::exp(iter->logWeight - logZ));
+        if(weight > 0) _posterior->addSample(iter->values,-iter->logL,weight);
+        if(-iter->logL < minNLL) {
+            minNLL = -iter->logL;
+            minParams = iter->values;
+        }
+    }
+    // Record the posterior covariance, if it is valid, before updating the parameter values,
+    // so that the updated errors are available.
+    try {
+        CovarianceAccumulator accumulator(_nFloating);
+        _posterior->accumulate(accumulator);
+        CovarianceMatrixCPtr C = accumulator.getCovariance();
+        C->getLogDeterminant();
+        fmin->updateCovariance(C);
+    }
+    catch(RuntimeError const &e) {
+        // Keep any previous covariance estimate.
+    }
+    fmin->updateParameterValues(minNLL,minParams);
+}
+
+void local::registerNestedSamplingEngineMethods() {
+    static bool registered = false;
+    if(registered) return;
+    // Create a function object that constructs a NestedSamplingEngine with parameters
+    // (FunctionPtr f, GradientCalculatorPtr gc, FitParameters const &parameters,
+    // std::string const &methodName).
+    EngineFactory factory = boost::bind(boost::factory<NestedSamplingEngine*>(),_1,_2,_3,_4);
+    // Register our sampling methods.
+    getEngineRegistry()["ns"] = factory;
+    registered = true;
+}
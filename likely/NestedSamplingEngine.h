@@ -0,0 +1,81 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_NESTED_SAMPLING_ENGINE
+#define LIKELY_NESTED_SAMPLING_ENGINE
+
+#include "likely/types.h"
+#include "likely/AbsEngine.h"
+
+#include <string>
+#include <vector>
+
+namespace likely {
+    // Estimates the Bayesian evidence Z = Integral[L(p) prior(p) dp] and samples the posterior
+    // using nested sampling (Skilling 2006). The prior is specified by the prior of each floating
+    // fit parameter, which must be a box prior (uniform between its min and max) or a Gaussian
+    // prior. The engine's function is interpreted as -log(L) and so should not include any
+    // prior penalty. Several live points are replaced concurrently on a thread pool, so the
+    // function must be safe to call from multiple threads. Algorithms are named live<N> to use
+    // N live points, e.g., "ns::live400".
+	class NestedSamplingEngine : public AbsEngine {
+	public:
+	    // Creates a new engine for the specified function of the specified parameters, using
+	    // the specified random generator and thread pool or else the defaults.
+		NestedSamplingEngine(FunctionPtr f, GradientCalculatorPtr gc, FitParameters const &parameters,
+            std::string const &algorithm, RandomPtr random = RandomPtr(),
+            ThreadPoolPtr pool = ThreadPoolPtr());
+		virtual ~NestedSamplingEngine();
+		// Runs nested sampling until the estimated evidence in the remaining live points is
+		// less than the specified fraction of the accumulated evidence, or until maxEvals
+		// function evaluations have been used (when maxEvals > 0). Updates the function
+		// minimum with the best point found and the covariance of the posterior samples.
+		// Results are available from the methods below until the next call.
+        void sample(FunctionMinimumPtr fmin, double tolerance, long maxEvals);
+        // Returns the number of live points used by this engine.
+        int getNLive() const;
+        // Returns the estimated log(Z) and its statistical uncertainty from the last call
+        // to sample(). Z is normalized to the prior volume.
+        double getLogEvidence() const;
+        double getLogEvidenceError() const;
+        // Returns the estimated information H = Integral[P log(P/prior)] in nats from the
+        // last call to sample(), where P is the normalized posterior.
+        double getInformation() const;
+        // Returns the weighted posterior samples generated by the last call to sample().
+        ChainReweighterPtr getPosterior() const;
+	private:
+        // Transforms floating parameter values in the unit hypercube to parameter values.
+        void _transform(double const *unit, Parameters &values) const;
+        // Evaluates log(L) for the specified floating parameter values in the unit hypercube.
+        double _evaluate(double const *unit, Parameters &values) const;
+        void _evaluateRange(int first, int last);
+        // Performs a constrained random walk from a live point to replace the point in slot.
+        void _walk(int slot, int start, double logLmin, CovarianceMatrixCPtr proposal, double scale);
+        int _nLive, _nFloating, _nSteps;
+        FunctionPtr _f;
+        FitParameters _parameters;
+        std::vector<int> _floatingIndex;
+        std::vector<double> _center, _width;
+        std::vector<bool> _gaussian;
+        RandomPtr _random;
+        ThreadPoolPtr _pool;
+        // Live points and replacement walk results.
+        std::vector<double> _unit, _logL, _walkUnit, _walkLogL;
+        std::vector<int> _walkAccepted, _walkEvals;
+        std::vector<RandomPtr> _walkRandom;
+        // Results of our last call to sample().
+        double _logZ, _logZError, _information;
+        ChainReweighterPtr _posterior;
+	}; // NestedSamplingEngine
+
+    inline int NestedSamplingEngine::getNLive() const { return _nLive; }
+    inline double NestedSamplingEngine::getLogEvidence() const { return _logZ; }
+    inline double NestedSamplingEngine::getLogEvidenceError() const { return _logZError; }
+    inline double NestedSamplingEngine::getInformation() const { return _information; }
+    inline ChainReweighterPtr NestedSamplingEngine::getPosterior() const { return _posterior; }
+
+    // Registers our named methods.
+    void registerNestedSamplingEngineMethods();
+
+} // likely
+
+#endif // LIKELY_NESTED_SAMPLING_ENGINE
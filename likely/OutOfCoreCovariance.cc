@@ -0,0 +1,246 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/OutOfCoreCovariance.h"
+#include "likely/RuntimeError.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Declare bindings to BLAS,LAPACK routines we need
+extern "C" {
+    // http://www.netlib.org/lapack/double/dpotrf.f
+    void dpotrf_(char const *uplo, int const *n, double *a, int const *lda, int *info);
+    // http://www.netlib.org/blas/dtrsm.f
+    void dtrsm_(char const *side, char const *uplo, char const *transa, const char *diag,
+        int const *m, int const *n, double const *alpha, double const *a, int const *lda,
+        double *b, int const *ldb);
+    // http://www.netlib.org/blas/dsyrk.f
+    void dsyrk_(char const *uplo, char const *trans, int const *n, int const *k,
+        double const *alpha, double const *a, int const *lda, double const *beta,
+        double *c, int const *ldc);
+    // http://www.netlib.org/blas/dgemm.f
+    void dgemm_(char const *transa, char const *transb, int const *m, int const *n,
+        int const *k, double const *alpha, double const *a, int const *lda, double const *b,
+        int const *ldb, double const *beta, double *c, int const *ldc);
+    // http://www.netlib.org/blas/dgemv.f
+    void dgemv_(char const *trans, int const *m, int const *n, double const *alpha,
+        double const *a, int const *lda, double const *x, int const *incx, double const *beta,
+        double *y, int const *incy);
+    // http://www.netlib.org/blas/dtrsv.f
+    void dtrsv_(char const *uplo, char const *trans, char const *diag, int const *n,
+        double const *a, int const *lda, double *x, int const *incx);
+}
+
+namespace local = likely;
+
+local::OutOfCoreCovariance::OutOfCoreCovariance(std::string const &filename, long size, int tileSize)
+: _filename(filename), _size(size), _tileSize(tileSize), _fd(-1), _decomposed(false)
+{
+    if(_size <= 0) {
+        throw RuntimeError("OutOfCoreCovariance: expected size > 0.");
+    }
+    if(_tileSize < 0) {
+        throw RuntimeError("OutOfCoreCovariance: invalid tile size.");
+    }
+    // The default tile size of 1024 uses 8Mb per tile.
+    if(0 == _tileSize) _tileSize = 1024;
+    if(_tileSize > _size) _tileSize = _size;
+    _nTiles = (_size + _tileSize - 1)/_tileSize;
+    // Create a new file and extend it to its final size so that unwritten tiles read as zeros.
+    _fd = open(_filename.c_str(),O_RDWR|O_CREAT|O_EXCL,0600);
+    if(_fd < 0) {
+        throw RuntimeError("OutOfCoreCovariance: unable to create " + _filename);
+    }
+    if(0 != ftruncate(_fd,_getOffset(0,_nTiles))) {
+        close(_fd);
+        unlink(_filename.c_str());
+        throw RuntimeError("OutOfCoreCovariance: unable to allocate " + _filename);
+    }
+}
+
+local::OutOfCoreCovariance::~OutOfCoreCovariance() {
+    close(_fd);
+    unlink(_filename.c_str());
+}
+
+int local::OutOfCoreCovariance::getTileDim(int index) const {
+    if(index < 0 || index >= _nTiles) {
+        throw RuntimeError("OutOfCoreCovariance::getTileDim: invalid tile index.");
+    }
+    return (int)std::min((long)_tileSize,_size - (long)index*_tileSize);
+}
+
+long local::OutOfCoreCovariance::_getOffset(int row, int col) const {
+    // Tiles are stored column by column, with each tile padded to the full tile size.
+    long index(row + ((long)col*(col+1))/2);
+    return index*_tileSize*_tileSize*(long)sizeof(double);
+}
+
+void local::OutOfCoreCovariance::_readTile(int row, int col, double *tile) const {
+    std::size_t remaining((std::size_t)getTileDim(row)*getTileDim(col)*sizeof(double));
+    char *buffer(reinterpret_cast<char*>(tile));
+    off_t offset(_getOffset(row,col));
+    while(remaining > 0) {
+        ssize_t nread = pread(_fd,buffer,remaining,offset);
+        if(nread < 0 && errno == EINTR) continue;
+        if(nread <= 0) {
+            throw RuntimeError("OutOfCoreCovariance: unable to read " + _filename);
+        }
+        buffer += nread;
+        offset += nread;
+        remaining -= nread;
+    }
+}
+
+void local::OutOfCoreCovariance::_writeTile(int row, int col, double const *tile) {
+    std::size_t remaining((std::size_t)getTileDim(row)*getTileDim(col)*sizeof(double));
+    char const *buffer(reinterpret_cast<char const*>(tile));
+    off_t offset(_getOffset(row,col));
+    while(remaining > 0) {
+        ssize_t nwrite = pwrite(_fd,buffer,remaining,offset);
+        if(nwrite < 0 && errno == EINTR) continue;
+        if(nwrite <= 0) {
+            throw RuntimeError("OutOfCoreCovariance: unable to write " + _filename);
+        }
+        buffer += nwrite;
+        offset += nwrite;
+        remaining -= nwrite;
+    }
+}
+
+void local::OutOfCoreCovariance::_prefetchTile(int row, int col) const {
+    posix_fadvise(_fd,_getOffset(row,col),
+        (off_t)getTileDim(row)*getTileDim(col)*sizeof(double),POSIX_FADV_WILLNEED);
+}
+
+void local::OutOfCoreCovariance::setTile(int row, int col, double const *tile) {
+    if(_decomposed) {
+        throw RuntimeError("OutOfCoreCovariance::setTile: matrix is already decomposed.");
+    }
+    if(row < 0 || row > col || col >= _nTiles) {
+        throw RuntimeError("OutOfCoreCovariance::setTile: invalid tile row or column.");
+    }
+    _writeTile(row,col,tile);
+}
+
+void local::OutOfCoreCovariance::getTile(int row, int col, double *tile) const {
+    if(row < 0 || row > col || col >= _nTiles) {
+        throw RuntimeError("OutOfCoreCovariance::getTile: invalid tile row or column.");
+    }
+    _readTile(row,col,tile);
+}
+
+void local::OutOfCoreCovariance::setCovariance(long row, long col, double value) {
+    if(_decomposed) {
+        throw RuntimeError("OutOfCoreCovariance::setCovariance: matrix is already decomposed.");
+    }
+    if(row < 0 || row >= _size || col < 0 || col >= _size) {
+        throw RuntimeError("OutOfCoreCovariance::setCovariance: invalid row or col.");
+    }
+    if(row > col) std::swap(row,col);
+    int tileRow(row/_tileSize), tileCol(col/_tileSize);
+    long index((col % _tileSize)*getTileDim(tileRow) + row % _tileSize);
+    off_t offset(_getOffset(tileRow,tileCol) + index*(long)sizeof(double));
+    while(pwrite(_fd,&value,sizeof(double),offset) != sizeof(double)) {
+        if(errno != EINTR) {
+            throw RuntimeError("OutOfCoreCovariance: unable to write " + _filename);
+        }
+    }
+}
+
+double local::OutOfCoreCovariance::decompose() {
+    if(_decomposed) {
+        throw RuntimeError("OutOfCoreCovariance::decompose: matrix is already decomposed.");
+    }
+    // Calculate each column of tiles of U in turn from the previous columns using
+    //
+    //   U[i,j] = U[i,i]*^-1.(C[i,j] - Sum[U[k,i]*.U[k,j],{k,0,i-1}])
+    //
+    // with U[j,j] obtained from the Cholesky decomposition of the bracketed term for i = j.
+    // The tiles U[k,j] of the column being calculated are kept in memory and the tiles
+    // U[k,i] of previous columns are streamed from our file.
+    std::size_t tileElements((std::size_t)_tileSize*_tileSize);
+    std::vector<double> panel(_nTiles*tileElements), other(tileElements);
+    double logdet(0), alpha(-1), beta(1), one(1);
+    char uplo('U'), transT('T'), transN('N'), side('L'), diag('N');
+    for(int j = 0; j < _nTiles; ++j) {
+        int nj(getTileDim(j));
+        for(int i = 0; i <= j; ++i) {
+            int ni(getTileDim(i));
+            double *tile(&panel[i*tileElements]);
+            _readTile(i,j,tile);
+            for(int k = 0; k < i; ++k) {
+                int nk(getTileDim(k));
+                double const *Ukj(&panel[k*tileElements]);
+                if(i == j) {
+                    dsyrk_(&uplo,&transT,&nj,&nk,&alpha,Ukj,&nk,&beta,tile,&nj);
+                    continue;
+                }
+                // Start reading the next tile of column i (or U[i,i]) while we use this one.
+                _readTile(k,i,&other[0]);
+                _prefetchTile(k+1,i);
+                dgemm_(&transT,&transN,&ni,&nj,&nk,&alpha,&other[0],&nk,Ukj,&nk,&beta,tile,&ni);
+            }
+            if(i == j) {
+                int info(0);
+                dpotrf_(&uplo,&nj,tile,&nj,&info);
+                if(0 != info) {
+                    throw RuntimeError("OutOfCoreCovariance::decompose: matrix is not positive definite.");
+                }
+                for(int k = 0; k < nj; ++k) logdet += 2*std::log(tile[k*nj + k]);
+            }
+            else {
+                // U[i,i] was calculated with an earlier column (and prefetched above if i > 0).
+                _readTile(i,i,&other[0]);
+                dtrsm_(&side,&uplo,&transT,&diag,&ni,&nj,&one,&other[0],&ni,tile,&ni);
+            }
+            _writeTile(i,j,tile);
+        }
+    }
+    _decomposed = true;
+    _logDeterminant = logdet;
+    return logdet;
+}
+
+double local::OutOfCoreCovariance::getLogDeterminant() const {
+    if(!_decomposed) {
+        throw RuntimeError("OutOfCoreCovariance::getLogDeterminant: matrix is not decomposed yet.");
+    }
+    return _logDeterminant;
+}
+
+double local::OutOfCoreCovariance::chiSquare(std::vector<double> const &delta) const {
+    if(!_decomposed) {
+        throw RuntimeError("OutOfCoreCovariance::chiSquare: matrix is not decomposed yet.");
+    }
+    if(delta.size() != _size) {
+        throw RuntimeError("OutOfCoreCovariance::chiSquare: delta has wrong size.");
+    }
+    // Solve U*.z = delta by forward substitution, one column of tiles at a time, so that
+    // tiles are read in the order they are stored, then chi-square = z.z.
+    posix_fadvise(_fd,0,0,POSIX_FADV_SEQUENTIAL);
+    std::vector<double> z(delta), tile((std::size_t)_tileSize*_tileSize);
+    double alpha(-1), beta(1);
+    int incr(1);
+    char uplo('U'), trans('T'), diag('N');
+    for(int j = 0; j < _nTiles; ++j) {
+        int nj(getTileDim(j));
+        double *zj(&z[(long)j*_tileSize]);
+        for(int k = 0; k < j; ++k) {
+            int nk(getTileDim(k));
+            _readTile(k,j,&tile[0]);
+            dgemv_(&trans,&nk,&nj,&alpha,&tile[0],&nk,&z[(long)k*_tileSize],&incr,&beta,zj,&incr);
+        }
+        _readTile(j,j,&tile[0]);
+        dtrsv_(&uplo,&trans,&diag,&nj,&tile[0],&nj,zj,&incr);
+    }
+    double chi2(0);
+    for(long index = 0; index < _size; ++index) chi2 += z[index]*z[index];
+    return chi2;
+}
@@ -0,0 +1,76 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_OUT_OF_CORE_COVARIANCE
+#define LIKELY_OUT_OF_CORE_COVARIANCE
+
+#include "boost/utility.hpp"
+
+#include <string>
+#include <vector>
+
+namespace likely {
+    // Represents a covariance matrix that is too large to hold in memory, by storing the
+    // square tiles of its upper triangle in a file. The Cholesky decomposition replaces the
+    // matrix tiles in the same file and is calculated with a left-looking tiled algorithm
+    // that holds one column of tiles in memory, i.e., about getSize()*getTileSize() values,
+    // and streams the tiles of previous columns from the file. Chi-square values are then
+    // calculated by streaming each tile of the decomposition once, in file order. The file
+    // is created by the constructor and removed by the destructor.
+	class OutOfCoreCovariance : boost::noncopyable {
+	public:
+	    // Creates a new covariance matrix of the specified size whose elements are all zero,
+	    // stored in a new file with the specified name using tiles of the specified size, or
+	    // else a default size when tileSize is zero. Throws a RuntimeError if the file cannot
+	    // be created or its name refers to an existing file.
+		OutOfCoreCovariance(std::string const &filename, long size, int tileSize = 0);
+		virtual ~OutOfCoreCovariance();
+		// Returns the size of this matrix, its tile size, and its number of tile rows.
+        long getSize() const;
+        int getTileSize() const;
+        int getNTiles() const;
+        // Returns the number of rows (or columns) in the specified tile row (or column).
+        int getTileDim(int index) const;
+        // Sets/gets the tile in the specified row and column >= row, stored in column-major
+        // order in an array with getTileDim(row)*getTileDim(col) elements. Elements below the
+        // diagonal of a diagonal tile are ignored. Tiles cannot be set after decompose().
+        void setTile(int row, int col, double const *tile);
+        void getTile(int row, int col, double *tile) const;
+        // Sets one element of this matrix, which is much slower than setting a whole tile.
+        void setCovariance(long row, long col, double value);
+        // Replaces the contents of our file with the upper-diagonal Cholesky decomposition U
+        // of this matrix, C = U*.U, and returns log(determinant) of the matrix. Throws a
+        // RuntimeError if the matrix is not positive definite or the decomposition has
+        // already been calculated.
+        double decompose();
+        // Returns true if our file contains the Cholesky decomposition.
+        bool isDecomposed() const;
+        // Returns log(determinant) of this matrix, or throws a RuntimeError unless
+        // decompose() has been called.
+        double getLogDeterminant() const;
+        // Calculates the chi-square = delta.Cinv.delta for the specified residuals vector,
+        // using a single pass through the tiles of our Cholesky decomposition. Throws a
+        // RuntimeError unless decompose() has been called. Safe to call from multiple threads.
+        double chiSquare(std::vector<double> const &delta) const;
+	private:
+        // Returns the file offset of the tile in the specified row and column >= row.
+        long _getOffset(int row, int col) const;
+        // Reads/writes the tile in the specified row and column >= row.
+        void _readTile(int row, int col, double *tile) const;
+        void _writeTile(int row, int col, double const *tile);
+        // Advises the kernel that the specified tile will be read soon.
+        void _prefetchTile(int row, int col) const;
+        std::string _filename;
+        long _size;
+        int _tileSize, _nTiles, _fd;
+        bool _decomposed;
+        double _logDeterminant;
+	}; // OutOfCoreCovariance
+
+    inline long OutOfCoreCovariance::getSize() const { return _size; }
+    inline int OutOfCoreCovariance::getTileSize() const { return _tileSize; }
+    inline int OutOfCoreCovariance::getNTiles() const { return _nTiles; }
+    inline bool OutOfCoreCovariance::isDecomposed() const { return _decomposed; }
+
+} // likely
+
+#endif // LIKELY_OUT_OF_CORE_COVARIANCE
@@ -0,0 +1,314 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/PackedKernels.h"
+#include "likely/RuntimeError.h"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "config.h" // propagates HAVE_BUILTIN_CPU_SUPPORTS from configure
+
+// The SIMD kernels are selected at run time, so they need a compiler that supports both
+// AVX-512 target attributes and __builtin_cpu_supports.
+#if defined(HAVE_BUILTIN_CPU_SUPPORTS) && (defined(__x86_64__) || defined(__i386__))
+#define LIKELY_PACKED_SIMD
+#include <immintrin.h>
+#endif
+
+// Declare bindings to BLAS routines we need
+extern "C" {
+    // http://www.netlib.org/blas/dspmv.f
+    void dspmv_(char const *uplo, int const *n, double const *alpha, double const *ap,
+        double const *x, int const *incx, double const *beta, double *y, int const *incy);
+    // http://www.netlib.org/blas/dtpmv.f
+    void dtpmv_(char const *uplo, char const *trans, char const *diag, int const *n,
+        double const *ap, double *x, int const *incx);
+    // http://www.netlib.org/blas/dtpsv.f
+    void dtpsv_(char const *uplo, char const *trans, char const *diag, int const *n,
+        double const *ap, double *x, int const *incx);
+    // http://www.netlib.org/blas/ddot.f
+    double ddot_(int const *n, double const *x, int const *incx, double const *y, int const *incy);
+}
+
+namespace local = likely;
+
+namespace likely {
+namespace packed {
+    // Each kernel is built from these operations on contiguous vectors of length n:
+    //   dot:     returns a.b
+    //   axpy:    y += scale*a
+    //   dotAxpy: returns a.x and does y += scale*a, reading a only once
+    struct Operations {
+        double (*dot)(double const *a, double const *b, int n);
+        void (*axpy)(double const *a, double scale, double *y, int n);
+        double (*dotAxpy)(double const *a, double const *x, double *y, double scale, int n);
+        char const *name;
+    };
+
+    double dotScalar(double const *a, double const *b, int n) {
+        double sum(0);
+        for(int i = 0; i < n; ++i) sum += a[i]*b[i];
+        return sum;
+    }
+    void axpyScalar(double const *a, double scale, double *y, int n) {
+        for(int i = 0; i < n; ++i) y[i] += scale*a[i];
+    }
+    double dotAxpyScalar(double const *a, double const *x, double *y, double scale, int n) {
+        double sum(0);
+        for(int i = 0; i < n; ++i) {
+            sum += a[i]*x[i];
+            y[i] += scale*a[i];
+        }
+        return sum;
+    }
+    // Used instead of BLAS for matrices whose packed elements cannot be indexed with an int.
+    Operations const scalarOperations = { dotScalar, axpyScalar, dotAxpyScalar, "scalar" };
+    // Identifies the BLAS routines, which are not built from these operations.
+    Operations const blasOperations = { 0, 0, 0, "blas" };
+
+#ifdef LIKELY_PACKED_SIMD
+    __attribute__((target("avx2,fma")))
+    double sumAvx2(__m256d sum) {
+        __m128d pair(_mm_add_pd(_mm256_castpd256_pd128(sum),_mm256_extractf128_pd(sum,1)));
+        return _mm_cvtsd_f64(_mm_add_sd(pair,_mm_unpackhi_pd(pair,pair)));
+    }
+    __attribute__((target("avx2,fma")))
+    double dotAvx2(double const *a, double const *b, int n) {
+        __m256d sum0(_mm256_setzero_pd()), sum1(_mm256_setzero_pd());
+        int i(0);
+        for(; i+8 <= n; i += 8) {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i),_mm256_loadu_pd(b+i),sum0);
+            sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i+4),_mm256_loadu_pd(b+i+4),sum1);
+        }
+        if(i+4 <= n) {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i),_mm256_loadu_pd(b+i),sum0);
+            i += 4;
+        }
+        double sum(sumAvx2(_mm256_add_pd(sum0,sum1)));
+        for(; i < n; ++i) sum += a[i]*b[i];
+        return sum;
+    }
+    __attribute__((target("avx2,fma")))
+    void axpyAvx2(double const *a, double scale, double *y, int n) {
+        __m256d factor(_mm256_set1_pd(scale));
+        int i(0);
+        for(; i+4 <= n; i += 4) {
+            _mm256_storeu_pd(y+i,_mm256_fmadd_pd(_mm256_loadu_pd(a+i),factor,_mm256_loadu_pd(y+i)));
+        }
+        for(; i < n; ++i) y[i] += scale*a[i];
+    }
+    __attribute__((target("avx2,fma")))
+    double dotAxpyAvx2(double const *a, double const *x, double *y, double scale, int n) {
+        __m256d factor(_mm256_set1_pd(scale)), sum0(_mm256_setzero_pd());
+        int i(0);
+        for(; i+4 <= n; i += 4) {
+            __m256d column(_mm256_loadu_pd(a+i));
+            sum0 = _mm256_fmadd_pd(column,_mm256_loadu_pd(x+i),sum0);
+            _mm256_storeu_pd(y+i,_mm256_fmadd_pd(column,factor,_mm256_loadu_pd(y+i)));
+        }
+        double sum(sumAvx2(sum0));
+        for(; i < n; ++i) {
+            sum += a[i]*x[i];
+            y[i] += scale*a[i];
+        }
+        return sum;
+    }
+    Operations const avx2Operations = { dotAvx2, axpyAvx2, dotAxpyAvx2, "avx2" };
+
+    // The AVX-512 versions handle the remainder of each vector with masked loads and stores.
+    __attribute__((target("avx512f")))
+    double dotAvx512(double const *a, double const *b, int n) {
+        __m512d sum0(_mm512_setzero_pd()), sum1(_mm512_setzero_pd());
+        int i(0);
+        for(; i+16 <= n; i += 16) {
+            sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i),_mm512_loadu_pd(b+i),sum0);
+            sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i+8),_mm512_loadu_pd(b+i+8),sum1);
+        }
+        for(; i < n; i += 8) {
+            __mmask8 mask(n-i >= 8 ? 0xff : (1 << (n-i)) - 1);
+            sum0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask,a+i),
+                _mm512_maskz_loadu_pd(mask,b+i),sum0);
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(sum0,sum1));
+    }
+    __attribute__((target("avx512f")))
+    void axpyAvx512(double const *a, double scale, double *y, int n) {
+        __m512d factor(_mm512_set1_pd(scale));
+        for(int i = 0; i < n; i += 8) {
+            __mmask8 mask(n-i >= 8 ? 0xff : (1 << (n-i)) - 1);
+            _mm512_mask_storeu_pd(y+i,mask,_mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask,a+i),
+                factor,_mm512_maskz_loadu_pd(mask,y+i)));
+        }
+    }
+    __attribute__((target("avx512f")))
+    double dotAxpyAvx512(double const *a, double const *x, double *y, double scale, int n) {
+        __m512d factor(_mm512_set1_pd(scale)), sum0(_mm512_setzero_pd());
+        for(int i = 0; i < n; i += 8) {
+            __mmask8 mask(n-i >= 8 ? 0xff : (1 << (n-i)) - 1);
+            __m512d column(_mm512_maskz_loadu_pd(mask,a+i));
+            sum0 = _mm512_fmadd_pd(column,_mm512_maskz_loadu_pd(mask,x+i),sum0);
+            _mm512_mask_storeu_pd(y+i,mask,
+                _mm512_fmadd_pd(column,factor,_mm512_maskz_loadu_pd(mask,y+i)));
+        }
+        return _mm512_reduce_add_pd(sum0);
+    }
+    Operations const avx512Operations = { dotAvx512, axpyAvx512, dotAxpyAvx512, "avx512" };
+#endif
+
+    // Returns true if the running CPU supports the specified operations.
+    bool isSupported(Operations const *ops) {
+#ifdef LIKELY_PACKED_SIMD
+        __builtin_cpu_init();
+        if(ops == &avx512Operations) return __builtin_cpu_supports("avx512f");
+        if(ops == &avx2Operations) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        return ops == &scalarOperations || ops == &blasOperations;
+    }
+    // Returns the fastest operations supported by the running CPU.
+    Operations const *selectOperations() {
+#ifdef LIKELY_PACKED_SIMD
+        if(isSupported(&avx512Operations)) return &avx512Operations;
+        if(isSupported(&avx2Operations)) return &avx2Operations;
+#endif
+        return &blasOperations;
+    }
+    // The operations selected with setPackedKernels, or zero to use selectOperations().
+    Operations const *forced = 0;
+    // Returns the operations to use for a packed matrix of the specified size, or zero
+    // if BLAS should be used instead.
+    Operations const *getOperations(int size) {
+        static Operations const *best = selectOperations();
+        Operations const *ops(forced ? forced : best);
+        if(ops != &blasOperations) return ops;
+        // BLAS indexes packed elements with an int.
+        if(((std::size_t)size*(size+1))/2 > (std::size_t)std::numeric_limits<int>::max()) {
+            return &scalarOperations;
+        }
+        return 0;
+    }
+} // packed
+} // likely
+
+void local::packedSymmetricMultiply(double const *matrix, double const *vector, double *result,
+int size) {
+    packed::Operations const *ops(packed::getOperations(size));
+    if(0 == ops) {
+        char uplo('U');
+        int incr(1);
+        double alpha(1), beta(0);
+        dspmv_(&uplo,&size,&alpha,matrix,vector,&incr,&beta,result,&incr);
+        return;
+    }
+    // Column j contributes A[j,j]*x[j] plus the dot product of its elements above the
+    // diagonal with x to result[j], and adds x[j] times those elements to result[0:j-1],
+    // which were already initialized by the previous columns.
+    double const *column(matrix);
+    for(int col = 0; col < size; ++col) {
+        double value(vector[col]);
+        result[col] = ops->dotAxpy(column,vector,result,value,col) + column[col]*value;
+        column += col+1;
+    }
+}
+
+double local::packedQuadraticForm(double const *matrix, double const *vector, int size) {
+    packed::Operations const *ops(packed::getOperations(size));
+    if(0 == ops) {
+        std::vector<double> product(size);
+        packedSymmetricMultiply(matrix,vector,&product[0],size);
+        int incr(1);
+        return ddot_(&size,vector,&incr,&product[0],&incr);
+    }
+    double result(0);
+    double const *column(matrix);
+    for(int col = 0; col < size; ++col) {
+        double value(vector[col]);
+        result += value*(2*ops->dot(column,vector,col) + column[col]*value);
+        column += col+1;
+    }
+    return result;
+}
+
+void local::packedTriangularMultiply(double const *matrix, double const *vector, double *result,
+int size, bool transpose) {
+    packed::Operations const *ops(packed::getOperations(size));
+    if(0 == ops) {
+        char uplo('U'), trans(transpose ? 'T' : 'N'), diag('N');
+        int incr(1);
+        std::copy(vector,vector+size,result);
+        dtpmv_(&uplo,&trans,&diag,&size,matrix,result,&incr);
+        return;
+    }
+    double const *column(matrix);
+    for(int col = 0; col < size; ++col) {
+        if(transpose) {
+            result[col] = ops->dot(column,vector,col+1);
+        }
+        else {
+            ops->axpy(column,vector[col],result,col);
+            result[col] = column[col]*vector[col];
+        }
+        column += col+1;
+    }
+}
+
+void local::packedTriangularSolve(double const *matrix, double *vector, int size, bool transpose) {
+    packed::Operations const *ops(packed::getOperations(size));
+    if(0 == ops) {
+        char uplo('U'), trans(transpose ? 'T' : 'N'), diag('N');
+        int incr(1);
+        dtpsv_(&uplo,&trans,&diag,&size,matrix,vector,&incr);
+        return;
+    }
+    if(transpose) {
+        // Forward substitution using the dot product of each column with the solution so far.
+        double const *column(matrix);
+        for(int col = 0; col < size; ++col) {
+            vector[col] = (vector[col] - ops->dot(column,vector,col))/column[col];
+            column += col+1;
+        }
+    }
+    else {
+        // Back substitution, removing each solved element from the remaining equations.
+        for(int col = size-1; col >= 0; --col) {
+            double const *column(matrix + ((std::size_t)col*(col+1))/2);
+            double value(vector[col] /= column[col]);
+            ops->axpy(column,-value,vector,col);
+        }
+    }
+}
+
+double local::vectorDotProduct(double const *a, double const *b, int size) {
+    packed::Operations const *ops(packed::getOperations(0));
+    if(0 == ops) {
+        int incr(1);
+        return ddot_(&size,a,&incr,b,&incr);
+    }
+    return ops->dot(a,b,size);
+}
+
+std::string local::getPackedKernelsName() {
+    packed::Operations const *ops(packed::getOperations(0));
+    return ops ? ops->name : packed::blasOperations.name;
+}
+
+void local::setPackedKernels(std::string const &name) {
+    if(name.empty()) {
+        packed::forced = 0;
+        return;
+    }
+    packed::Operations const *candidates[] = { &packed::scalarOperations, &packed::blasOperations
+#ifdef LIKELY_PACKED_SIMD
+        , &packed::avx2Operations, &packed::avx512Operations
+#endif
+    };
+    for(int k = 0; k < sizeof(candidates)/sizeof(candidates[0]); ++k) {
+        if(name != candidates[k]->name) continue;
+        if(!packed::isSupported(candidates[k])) {
+            throw RuntimeError("setPackedKernels: \"" + name + "\" is not supported by this CPU.");
+        }
+        packed::forced = candidates[k];
+        return;
+    }
+    throw RuntimeError("setPackedKernels: unknown kernels \"" + name + "\".");
+}
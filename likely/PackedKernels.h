@@ -0,0 +1,43 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_PACKED_KERNELS
+#define LIKELY_PACKED_KERNELS
+
+#include <string>
+
+namespace likely {
+    // Kernels for matrices of the specified size stored in the BLAS packed 'U' format
+    // implied by symmetricMatrixIndex(row,col,size) (see CovarianceMatrix.h), where column j
+    // is stored contiguously. Each kernel makes a single pass through the packed matrix,
+    // one column at a time, using AVX-512 or AVX2 instructions when the running CPU supports
+    // them, so that large matrices are processed at memory bandwidth. Otherwise, the
+    // equivalent BLAS routine is used, or else portable scalar loops for matrices too large
+    // for BLAS to index. The vectors provided must not overlap the matrix.
+
+    // Calculates result = A.vector for a symmetric matrix A (like BLAS DSPMV).
+    void packedSymmetricMultiply(double const *matrix, double const *vector, double *result, int size);
+    // Returns the quadratic form vector.A.vector for a symmetric matrix A, without forming
+    // the intermediate product A.vector.
+    double packedQuadraticForm(double const *matrix, double const *vector, int size);
+    // Calculates result = U.vector, or U*.vector if transpose is true, for an upper-triangular
+    // matrix U (like BLAS DTPMV). The result must not overlap the input vector.
+    void packedTriangularMultiply(double const *matrix, double const *vector, double *result,
+        int size, bool transpose = false);
+    // Solves U.x = vector, or U*.x = vector if transpose is true, for an upper-triangular
+    // matrix U (like BLAS DTPSV). The solution overwrites the input vector.
+    void packedTriangularSolve(double const *matrix, double *vector, int size, bool transpose = false);
+    // Returns the dot product of two vectors of the specified size using the same
+    // instructions as the kernels above.
+    double vectorDotProduct(double const *a, double const *b, int size);
+    // Returns the name of the kernels above that are currently used: "avx512", "avx2",
+    // "blas" or "scalar".
+    std::string getPackedKernelsName();
+    // Forces the kernels above to use the named implementation, or restores the automatic
+    // selection for an empty name. Throws a RuntimeError for an unknown name or for
+    // instructions that the running CPU does not support. This is intended for testing and
+    // benchmarks, and must not be called while other threads are using the kernels.
+    void setPackedKernels(std::string const &name);
+
+} // likely
+
+#endif // LIKELY_PACKED_KERNELS
@@ -0,0 +1,318 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/ProcessFarm.h"
+#include "likely/FunctionMinimum.h"
+#include "likely/FitParameter.h"
+#include "likely/CovarianceMatrix.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/cstdint.hpp"
+
+#include <exception>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace local = likely;
+
+namespace likely {
+namespace farm {
+    // Appends the raw bytes of a plain-old-data value to a buffer.
+    template <class T> void put(std::string &buffer, T const &value) {
+        buffer.append(reinterpret_cast<char const*>(&value),sizeof(T));
+    }
+    void putString(std::string &buffer, std::string const &value) {
+        put(buffer,(boost::uint64_t)value.size());
+        buffer.append(value);
+    }
+    // Reads values from a buffer created with put and putString.
+    class Reader {
+    public:
+        Reader(std::string const &buffer) : _buffer(buffer), _pos(0) { }
+        template <class T> T get() {
+            T value;
+            _check(sizeof(T));
+            std::memcpy(&value,_buffer.data() + _pos,sizeof(T));
+            _pos += sizeof(T);
+            return value;
+        }
+        std::string getString() {
+            boost::uint64_t size(get<boost::uint64_t>());
+            _check(size);
+            std::string value(_buffer,_pos,size);
+            _pos += size;
+            return value;
+        }
+    private:
+        void _check(std::size_t size) const {
+            if(_pos + size > _buffer.size()) {
+                throw RuntimeError("deserializeFunctionMinimum: buffer is truncated.");
+            }
+        }
+        std::string const &_buffer;
+        std::size_t _pos;
+    }; // Reader
+    // Writes all of the specified bytes to a file descriptor, or returns false.
+    bool writeAll(int fd, char const *data, std::size_t size) {
+        while(size > 0) {
+            ssize_t nwrite = ::write(fd,data,size);
+            if(nwrite < 0) {
+                if(errno == EINTR) continue;
+                return false;
+            }
+            data += nwrite;
+            size -= nwrite;
+        }
+        return true;
+    }
+    // Header for each result record sent from a worker, followed by its payload.
+    struct Record {
+        boost::int32_t index, failed;
+        boost::uint64_t size;
+    };
+    // Accumulates bytes received from one worker and extracts complete records.
+    struct Channel {
+        int fd;
+        pid_t pid;
+        std::string pending;
+    };
+}} // likely::farm
+
+std::string local::serializeFunctionMinimum(FunctionMinimumCPtr fmin) {
+    std::string buffer;
+    farm::put(buffer,fmin->getMinValue());
+    farm::put(buffer,(boost::int64_t)fmin->getNEvalCount());
+    farm::put(buffer,(boost::int64_t)fmin->getNGradCount());
+    farm::put(buffer,(boost::int32_t)fmin->getStatus());
+    farm::putString(buffer,fmin->getStatusMessage());
+    FitParameters parameters(fmin->getFitParameters());
+    farm::put(buffer,(boost::uint64_t)parameters.size());
+    for(FitParameters::const_iterator iter = parameters.begin(); iter != parameters.end(); ++iter) {
+        // Save the error of a temporarily fixed parameter, so it can be released later.
+        FitParameter released(*iter);
+        released.release();
+        farm::putString(buffer,iter->getName());
+        farm::put(buffer,iter->getValue());
+        farm::put(buffer,released.getError());
+        farm::put(buffer,(boost::int32_t)iter->isFloating());
+        farm::put(buffer,(boost::int32_t)iter->getPriorType());
+        farm::put(buffer,iter->getPriorMin());
+        farm::put(buffer,iter->getPriorMax());
+        farm::put(buffer,iter->getPriorScale());
+    }
+    // Save the packed upper triangle of any covariance matrix.
+    CovarianceMatrixCPtr covariance(fmin->getCovariance());
+    int size(covariance ? covariance->getSize() : 0);
+    farm::put(buffer,(boost::int32_t)size);
+    for(int col = 0; col < size; ++col) {
+        for(int row = 0; row <= col; ++row) farm::put(buffer,covariance->getCovariance(row,col));
+    }
+    return buffer;
+}
+
+local::FunctionMinimumPtr local::deserializeFunctionMinimum(std::string const &buffer) {
+    farm::Reader reader(buffer);
+    double minValue(reader.get<double>());
+    long nEval(reader.get<boost::int64_t>()), nGrad(reader.get<boost::int64_t>());
+    FunctionMinimum::Status status((FunctionMinimum::Status)reader.get<boost::int32_t>());
+    std::string message(reader.getString());
+    FitParameters parameters;
+    boost::uint64_t nParameters(reader.get<boost::uint64_t>());
+    for(boost::uint64_t index = 0; index < nParameters; ++index) {
+        std::string name(reader.getString());
+        double value(reader.get<double>()), error(reader.get<double>());
+        bool floating(0 != reader.get<boost::int32_t>());
+        FitParameter::PriorType priorType((FitParameter::PriorType)reader.get<boost::int32_t>());
+        double priorMin(reader.get<double>()), priorMax(reader.get<double>());
+        double priorScale(reader.get<double>());
+        FitParameter parameter(name,value,error);
+        if(!floating) parameter.fix();
+        if(priorType != FitParameter::NoPrior) {
+            parameter.setPrior(priorMin,priorMax,priorScale,priorType);
+        }
+        parameters.push_back(parameter);
+    }
+    FunctionMinimumPtr fmin;
+    int size(reader.get<boost::int32_t>());
+    if(size > 0) {
+        CovarianceMatrixPtr covariance(new CovarianceMatrix(size));
+        for(int col = 0; col < size; ++col) {
+            for(int row = 0; row <= col; ++row) {
+                covariance->setCovariance(row,col,reader.get<double>());
+            }
+        }
+        fmin.reset(new FunctionMinimum(minValue,parameters,covariance));
+    }
+    else {
+        fmin.reset(new FunctionMinimum(minValue,parameters));
+    }
+    fmin->setCounts(nEval,nGrad);
+    fmin->setStatus(status,message);
+    return fmin;
+}
+
+local::ProcessFarm::ProcessFarm(int nWorkers)
+: _nWorkers(nWorkers)
+{
+    if(_nWorkers < 0) {
+        throw RuntimeError("ProcessFarm: invalid number of workers.");
+    }
+    if(0 == _nWorkers) {
+        long nProcessors(sysconf(_SC_NPROCESSORS_ONLN));
+        _nWorkers = nProcessors > 0 ? (int)nProcessors : 1;
+    }
+}
+
+local::ProcessFarm::~ProcessFarm() { }
+
+std::string local::ProcessFarm::getFailure(int index) const {
+    if(index < 0 || index >= _failures.size()) {
+        throw RuntimeError("ProcessFarm::getFailure: invalid task index.");
+    }
+    return _failures[index];
+}
+
+std::vector<local::FunctionMinimumPtr> local::ProcessFarm::run(FitTask task, int nTasks) {
+    if(!task) {
+        throw RuntimeError("ProcessFarm::run: no task provided.");
+    }
+    if(nTasks < 0) {
+        throw RuntimeError("ProcessFarm::run: invalid number of tasks.");
+    }
+    std::vector<FunctionMinimumPtr> results(nTasks);
+    _failures.assign(nTasks,"worker exited before returning a result.");
+    if(0 == nTasks) return results;
+    // Allocate a task counter that is shared with our workers.
+    void *shared = mmap(0,sizeof(long),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if(MAP_FAILED == shared) {
+        throw RuntimeError("ProcessFarm::run: unable to allocate shared memory.");
+    }
+    volatile long *nextTask(static_cast<long*>(shared));
+    *nextTask = 0;
+    // Start our workers, each with its own pipe for returning results.
+    int nWorkers(std::min(_nWorkers,nTasks));
+    std::vector<farm::Channel> channels;
+    for(int worker = 0; worker < nWorkers; ++worker) {
+        int fds[2];
+        if(0 != pipe(fds)) break;
+        pid_t pid = fork();
+        if(pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            break;
+        }
+        if(0 == pid) {
+            // We are a worker: close the read ends of all pipes, then claim and run tasks
+            // until none are left.
+            close(fds[0]);
+            for(std::vector<farm::Channel>::iterator iter = channels.begin(); iter != channels.end(); ++iter) {
+                close(iter->fd);
+            }
+            while(true) {
+                long index = __sync_fetch_and_add(nextTask,1);
+                if(index >= nTasks) break;
+                farm::Record record;
+                record.index = index;
+                record.failed = 0;
+                std::string payload;
+                try {
+                    FunctionMinimumPtr fmin(task(index));
+                    if(!fmin) throw RuntimeError("task returned no result.");
+                    payload = serializeFunctionMinimum(fmin);
+                }
+                catch(std::exception const &e) {
+                    record.failed = 1;
+                    payload = e.what();
+                }
+                catch(...) {
+                    record.failed = 1;
+                    payload = "unknown exception.";
+                }
+                record.size = payload.size();
+                if(!farm::writeAll(fds[1],reinterpret_cast<char const*>(&record),sizeof(record)) ||
+                    !farm::writeAll(fds[1],payload.data(),payload.size())) _exit(1);
+            }
+            close(fds[1]);
+            // Exit without running any of our parent's exit handlers or destructors.
+            _exit(0);
+        }
+        close(fds[1]);
+        farm::Channel channel;
+        channel.fd = fds[0];
+        channel.pid = pid;
+        channels.push_back(channel);
+    }
+    // Collect results from our workers until all of their pipes are closed.
+    std::vector<struct pollfd> polled;
+    std::vector<int> open;
+    for(int worker = 0; worker < channels.size(); ++worker) open.push_back(worker);
+    char chunk[65536];
+    while(!open.empty()) {
+        polled.resize(open.size());
+        for(int k = 0; k < open.size(); ++k) {
+            polled[k].fd = channels[open[k]].fd;
+            polled[k].events = POLLIN;
+            polled[k].revents = 0;
+        }
+        if(poll(&polled[0],polled.size(),-1) < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+        std::vector<int> stillOpen;
+        for(int k = 0; k < open.size(); ++k) {
+            farm::Channel &channel(channels[open[k]]);
+            if(0 == polled[k].revents) {
+                stillOpen.push_back(open[k]);
+                continue;
+            }
+            ssize_t nread = read(channel.fd,chunk,sizeof(chunk));
+            if(nread < 0 && errno == EINTR) {
+                stillOpen.push_back(open[k]);
+                continue;
+            }
+            if(nread <= 0) {
+                close(channel.fd);
+                continue;
+            }
+            channel.pending.append(chunk,nread);
+            stillOpen.push_back(open[k]);
+            // Extract any complete records we now have.
+            while(channel.pending.size() >= sizeof(farm::Record)) {
+                farm::Record record;
+                std::memcpy(&record,channel.pending.data(),sizeof(record));
+                if(channel.pending.size() < sizeof(record) + record.size) break;
+                std::string payload(channel.pending,sizeof(record),record.size);
+                channel.pending.erase(0,sizeof(record) + record.size);
+                if(record.index < 0 || record.index >= nTasks) continue;
+                if(record.failed) {
+                    _failures[record.index] = payload;
+                    continue;
+                }
+                try {
+                    results[record.index] = deserializeFunctionMinimum(payload);
+                    _failures[record.index].clear();
+                }
+                catch(RuntimeError const &e) {
+                    _failures[record.index] = e.what();
+                }
+            }
+        }
+        open.swap(stillOpen);
+    }
+    // Wait for our workers to exit.
+    for(std::vector<farm::Channel>::iterator iter = channels.begin(); iter != channels.end(); ++iter) {
+        int status;
+        while(waitpid(iter->pid,&status,0) < 0 && errno == EINTR) { }
+    }
+    munmap(shared,sizeof(long));
+    if(channels.empty()) {
+        throw RuntimeError("ProcessFarm::run: unable to start any workers.");
+    }
+    return results;
+}
@@ -0,0 +1,59 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_PROCESS_FARM
+#define LIKELY_PROCESS_FARM
+
+#include "likely/types.h"
+
+#include "boost/function.hpp"
+#include "boost/utility.hpp"
+
+#include <string>
+#include <vector>
+
+namespace likely {
+    // Runs independent fit tasks in forked worker processes, for objective functions that are
+    // not safe to call from multiple threads. Workers are forked from the calling process so
+    // they share its memory copy-on-write, including any BinnedData and CovarianceMatrix objects
+    // that a task uses, and only pages that a worker modifies are copied. Call any methods that
+    // cache derived data (e.g., CovarianceMatrix::getInverseCovariance) before run(), so that
+    // the cached data is shared rather than recalculated in each worker. Workers claim tasks
+    // from a shared counter and return their results through a pipe. Only the calling thread
+    // is present in a worker, so any ThreadPool created before run, including the default
+    // pool, runs its tasks serially in the worker. Tasks that use random numbers should seed
+    // their generator from their index, since every worker starts with a copy of the caller's
+    // generator state.
+	class ProcessFarm : boost::noncopyable {
+	public:
+	    // Creates a new farm that uses the specified number of worker processes, or else one
+	    // worker per online processor when nWorkers is zero.
+		explicit ProcessFarm(int nWorkers = 0);
+		virtual ~ProcessFarm();
+		// Returns the number of worker processes used by this farm.
+        int getNWorkers() const;
+        // Runs task(index) for each index in [0,nTasks) and returns the resulting function
+        // minima in index order. Any task that throws an exception, or whose worker dies,
+        // has an empty result and a non-empty failure message. Returned function minima
+        // include each parameter's name, value, error and prior, the covariance, status and
+        // evaluation counts, but not any parameter binning.
+        typedef boost::function<FunctionMinimumPtr (int)> FitTask;
+        std::vector<FunctionMinimumPtr> run(FitTask task, int nTasks);
+        // Returns the failure message for the task with the specified index during the last
+        // call to run(), or an empty string if the task succeeded.
+        std::string getFailure(int index) const;
+	private:
+        int _nWorkers;
+        std::vector<std::string> _failures;
+	}; // ProcessFarm
+
+    inline int ProcessFarm::getNWorkers() const { return _nWorkers; }
+
+    // Serializes a FunctionMinimum to a binary string, or creates a new FunctionMinimum from
+    // a string created by this function. These are used to return results from worker
+    // processes and are only portable between processes running the same binary.
+    std::string serializeFunctionMinimum(FunctionMinimumCPtr fmin);
+    FunctionMinimumPtr deserializeFunctionMinimum(std::string const &buffer);
+
+} // likely
+
+#endif // LIKELY_PROCESS_FARM
@@ -2,6 +2,7 @@
 
 #include "likely/Random.h"
 #include "likely/RuntimeError.h"
+#include "likely/AlignedAllocator.h"
 
 #include "boost/random/uniform_01.hpp"
 #include "boost/random/normal_distribution.hpp"
@@ -82,11 +83,11 @@ void *local::allocateAlignedArray(std::size_t byteSize) {
         throw RuntimeError("allocateAlignedArray: Apple malloc failed.");
     }
 #elif defined(_POSIX_C_SOURCE)
-    if (posix_memalign((void **)&array, 16, byteSize) != 0) {
+    if ((array = allocateAlignedMemory(byteSize)) == NULL) {
         throw RuntimeError("allocateAlignedArray: posix_memalign failed.");
     }
 #elif defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 3))
-    array = (uint32_t*)memalign(16, byteSize);
+    array = (uint32_t*)memalign(alignedMemoryAlignment, byteSize);
     if (array == NULL) {
         throw RuntimeError("allocateAlignedArray: GNUC memalign failed.");
     }
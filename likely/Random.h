@@ -87,8 +87,9 @@ namespace likely {
     inline double Random::getNormal() { return _gauss(); }
     inline boost::mt19937 &Random::getGenerator() { return _generator; }
 	
-    // Allocates an array with the 128-bit alignment required by the Random::fillArrayX methods
-    // where size is in bytes.
+    // Allocates an array with at least the 128-bit alignment required by the Random::fillArrayX
+    // methods where size is in bytes. Uses allocateAlignedMemory (see AlignedAllocator.h) when
+    // available, for cache-line alignment and huge pages.
     void *allocateAlignedArray(std::size_t byteSize);
     
     // Wraps the result of calling allocateAlignedArray into a smart array pointer with a
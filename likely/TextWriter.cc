@@ -0,0 +1,165 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/TextWriter.h"
+#include "likely/ThreadPool.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/bind.hpp"
+#include "boost/smart_ptr.hpp"
+
+#include <ostream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+namespace local = likely;
+
+namespace likely {
+namespace textwriter {
+    // The number of rows per block used by writeRows when none is specified.
+    int const defaultBlockSize = 16;
+    // The initial buffer size of an in-memory writer.
+    std::size_t const initialSize = 4096;
+    // Writes the decimal digits of value and returns the number of characters written.
+    int formatUnsigned(unsigned long value, char *buffer) {
+        char digits[24];
+        int n(0);
+        do {
+            digits[n++] = '0' + value % 10;
+            value /= 10;
+        } while(value);
+        for(int k = 0; k < n; ++k) buffer[k] = digits[n-1-k];
+        return n;
+    }
+    // Writes the decimal digits of value, with a minus sign if it is negative.
+    int formatSigned(long value, char *buffer) {
+        if(value >= 0) return formatUnsigned(value,buffer);
+        buffer[0] = '-';
+        return 1 + formatUnsigned(0UL - (unsigned long)value,buffer + 1);
+    }
+}} // likely::textwriter
+
+int local::formatDouble(double value, char *buffer) {
+#ifdef __cpp_lib_to_chars
+    return std::to_chars(buffer,buffer + maxFormattedDoubleSize,value,
+        std::chars_format::general,17).ptr - buffer;
+#else
+    return snprintf(buffer,maxFormattedDoubleSize,"%.17g",value);
+#endif
+}
+
+local::TextWriter::TextWriter(std::ostream &os, std::size_t chunkSize)
+: _os(&os), _chunkSize(chunkSize), _size(0)
+{
+    _buffer.resize(chunkSize + maxFormattedDoubleSize);
+}
+
+local::TextWriter::TextWriter()
+: _os(0), _chunkSize(0), _size(0)
+{
+    _buffer.resize(textwriter::initialSize);
+}
+
+local::TextWriter::~TextWriter() {
+    flush();
+}
+
+char *local::TextWriter::_reserve(std::size_t size) {
+    if(_buffer.size() < _size + size) _buffer.resize(std::max(2*_buffer.size(),_size + size));
+    return &_buffer[_size];
+}
+
+void local::TextWriter::_written(char *end) {
+    _size = end - &_buffer[0];
+    if(_os && _size >= _chunkSize) flush();
+}
+
+local::TextWriter &local::TextWriter::operator<<(double value) {
+    char *next(_reserve(maxFormattedDoubleSize));
+    _written(next + formatDouble(value,next));
+    return *this;
+}
+
+local::TextWriter &local::TextWriter::operator<<(int value) {
+    return *this << (long)value;
+}
+
+local::TextWriter &local::TextWriter::operator<<(long value) {
+    char *next(_reserve(24));
+    _written(next + textwriter::formatSigned(value,next));
+    return *this;
+}
+
+local::TextWriter &local::TextWriter::operator<<(unsigned long value) {
+    char *next(_reserve(24));
+    _written(next + textwriter::formatUnsigned(value,next));
+    return *this;
+}
+
+local::TextWriter &local::TextWriter::operator<<(char value) {
+    char *next(_reserve(1));
+    *next++ = value;
+    _written(next);
+    return *this;
+}
+
+local::TextWriter &local::TextWriter::operator<<(char const *text) {
+    std::size_t size(std::strlen(text));
+    char *next(_reserve(size));
+    std::memcpy(next,text,size);
+    _written(next + size);
+    return *this;
+}
+
+void local::TextWriter::append(TextWriter &other) {
+    if(0 == other._size) return;
+    if(_os) {
+        // Write the other buffer directly instead of copying it into ours.
+        flush();
+        _os->write(&other._buffer[0],other._size);
+    }
+    else {
+        char *next(_reserve(other._size));
+        std::memcpy(next,&other._buffer[0],other._size);
+        _written(next + other._size);
+    }
+    other._size = 0;
+}
+
+void local::TextWriter::flush() {
+    if(_os && _size > 0) {
+        _os->write(&_buffer[0],_size);
+        _size = 0;
+    }
+}
+
+void local::writeRows(TextWriter &writer, int nRows, RowFormatter format, ThreadPoolPtr pool,
+int blockSize) {
+    if(!pool) {
+        throw RuntimeError("writeRows: no thread pool provided.");
+    }
+    if(blockSize < 0) {
+        throw RuntimeError("writeRows: invalid block size.");
+    }
+    if(0 == blockSize) blockSize = textwriter::defaultBlockSize;
+    // Reuse the same in-memory writers for each batch, so their buffers only grow once.
+    int batchSize(pool->getNThreads());
+    std::vector<boost::shared_ptr<TextWriter> > blocks;
+    for(int first = 0; first < nRows; first += batchSize*blockSize) {
+        int nBlocks(0);
+        ThreadPool::TaskGroup group(*pool);
+        for(int begin = first; nBlocks < batchSize && begin < nRows; begin += blockSize) {
+            if(nBlocks == (int)blocks.size()) blocks.push_back(boost::shared_ptr<TextWriter>(new TextWriter()));
+            group.submit(boost::bind(format,boost::ref(*blocks[nBlocks++]),begin,
+                std::min(begin + blockSize,nRows)));
+        }
+        group.wait();
+        for(int block = 0; block < nBlocks; ++block) writer.append(*blocks[block]);
+    }
+}
@@ -0,0 +1,74 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_TEXT_WRITER
+#define LIKELY_TEXT_WRITER
+
+#include "likely/types.h"
+
+#include "boost/function.hpp"
+#include "boost/utility.hpp"
+
+#include <vector>
+#include <iosfwd>
+#include <cstddef>
+
+namespace likely {
+    // The maximum number of characters written by formatDouble.
+    int const maxFormattedDoubleSize = 32;
+    // Writes the specified value to a buffer with room for maxFormattedDoubleSize characters,
+    // using exactly the same characters as boost::lexical_cast<std::string>(value), i.e.,
+    // printf("%.17g"), which can always be read back as the same value. Returns the number
+    // of characters written, without any terminating null. Uses std::to_chars when the
+    // compiler provides it, which is about four times faster than printf.
+    int formatDouble(double value, char *buffer);
+
+    // Accumulates text in a large buffer that is written to a stream in chunks, with numbers
+    // formatted the same as std::ostream (integers) or boost::lexical_cast (doubles, with
+    // full precision), but without allocating any memory per number or flushing per line.
+	class TextWriter : boost::noncopyable {
+	public:
+	    // Creates a new writer for the specified stream that writes its buffered text
+	    // whenever it exceeds chunkSize bytes, and when it is flushed or destroyed. The
+	    // stream should have its default formatting flags.
+		explicit TextWriter(std::ostream &os, std::size_t chunkSize = 1 << 20);
+		// Creates a new writer that keeps all of its text in memory until it is appended
+		// to another writer.
+		TextWriter();
+		// Writes any buffered text to our stream.
+		virtual ~TextWriter();
+		// Appends a value or text to our buffer.
+        TextWriter &operator<<(double value);
+        TextWriter &operator<<(int value);
+        TextWriter &operator<<(long value);
+        TextWriter &operator<<(unsigned long value);
+        TextWriter &operator<<(char value);
+        TextWriter &operator<<(char const *text);
+        // Appends the text buffered by another writer, and then clears the other writer.
+        void append(TextWriter &other);
+        // Writes our buffered text to our stream, if we have one.
+        void flush();
+	private:
+	    // Makes room for at least size more characters and returns a pointer to them.
+	    char *_reserve(std::size_t size);
+	    // Writes our buffer if it now exceeds our chunk size.
+	    void _written(char *end);
+        std::ostream *_os;
+        std::size_t _chunkSize, _size;
+        std::vector<char> _buffer;
+	}; // TextWriter
+
+    // Calls format(writer,first,last) for consecutive blocks of rows [first,last) of the
+    // range [0,nRows), each with its own in-memory writer, and appends the text of each
+    // block to the specified writer in row order, so the result is the same as calling
+    // format(writer,0,nRows). Blocks have the specified number of rows, or else 16 rows
+    // when blockSize is zero, and are formatted in parallel on the specified pool, in
+    // batches of one block per thread, so that only one batch is held in memory at a time.
+    // The format function must be safe to call from several threads at once. Must not be
+    // called from within a thread pool task.
+    typedef boost::function<void (TextWriter &writer, int first, int last)> RowFormatter;
+    void writeRows(TextWriter &writer, int nRows, RowFormatter format, ThreadPoolPtr pool,
+        int blockSize = 0);
+
+} // likely
+
+#endif // LIKELY_TEXT_WRITER
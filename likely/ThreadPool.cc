@@ -0,0 +1,501 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/ThreadPool.h"
+#include "likely/RuntimeError.h"
+
+#include "config.h" // propagates HAVE_PTHREAD_SETAFFINITY_NP, HAVE_THREAD_LOCAL etc from configure
+
+#include "boost/bind.hpp"
+#include "boost/lexical_cast.hpp"
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <exception>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace likely {
+namespace threadpool {
+    // Flags the worker threads of all pools.
+#ifdef HAVE_THREAD_LOCAL
+    __thread bool isWorker = false;
+    void setWorker() { isWorker = true; }
+    bool getWorker() { return isWorker; }
+#else
+    pthread_key_t isWorkerKey;
+    pthread_once_t isWorkerKeyOnce = PTHREAD_ONCE_INIT;
+    void createIsWorkerKey() { pthread_key_create(&isWorkerKey,0); }
+    // Any non-zero value flags a worker.
+    void setWorker() {
+        pthread_once(&isWorkerKeyOnce,createIsWorkerKey);
+        pthread_setspecific(isWorkerKey,&isWorkerKey);
+    }
+    bool getWorker() {
+        pthread_once(&isWorkerKeyOnce,createIsWorkerKey);
+        return 0 != pthread_getspecific(isWorkerKey);
+    }
+#endif
+    // Counts the fork() calls that created this process, so that pools created before a
+    // fork can tell that their worker threads do not exist in the child process.
+    int forkGeneration = 0;
+    pthread_once_t atForkOnce = PTHREAD_ONCE_INIT;
+    void forked() { ++forkGeneration; }
+    void registerAtFork() { pthread_atfork(0,0,&forked); }
+    // The chunk size used by parallelSum in deterministic mode when none is specified.
+    int const defaultReductionChunkSize = 256;
+    // Saves the partial sum of one chunk.
+    void sumChunk(ThreadPool::RangeSum body, int first, int last, double *sum) {
+        *sum = body(first,last);
+    }
+    // Returns the pairwise sum of n > 0 values.
+    double pairwiseSum(double const *values, std::size_t n) {
+        if(n <= 8) {
+            double sum(values[0]);
+            for(std::size_t k = 1; k < n; ++k) sum += values[k];
+            return sum;
+        }
+        std::size_t half(n/2);
+        return pairwiseSum(values,half) + pairwiseSum(values + half,n - half);
+    }
+}} // likely::threadpool
+
+namespace likely {
+namespace threadpool {
+    // Parses a kernel cpu or node list like "0-3,8,10-11".
+    std::vector<int> parseList(std::string const &list) {
+        std::vector<int> values;
+        std::istringstream is(list);
+        std::string range;
+        while(std::getline(is,range,',')) {
+            int first, last;
+            char dash;
+            std::istringstream rs(range);
+            if(!(rs >> first)) continue;
+            if(!(rs >> dash >> last)) last = first;
+            for(int value = first; value <= last; ++value) values.push_back(value);
+        }
+        return values;
+    }
+    // Reads the first line of a file, or returns an empty string.
+    std::string readLine(std::string const &filename) {
+        std::ifstream in(filename.c_str());
+        std::string line;
+        std::getline(in,line);
+        return line;
+    }
+    // Removes any processors that the calling process is not allowed to run on, e.g.,
+    // because of taskset or a cgroup cpuset, from the specified list.
+    void removeDisallowed(std::vector<int> &cpus) {
+#ifdef HAVE_SCHED_GETAFFINITY
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if(0 != sched_getaffinity(0,sizeof(allowed),&allowed)) return;
+        std::vector<int> kept;
+        for(std::vector<int>::const_iterator cpu = cpus.begin(); cpu != cpus.end(); ++cpu) {
+            if(*cpu < CPU_SETSIZE && CPU_ISSET(*cpu,&allowed)) kept.push_back(*cpu);
+        }
+        cpus.swap(kept);
+#endif
+    }
+    // The allowed online processors of each NUMA node, and the node of each processor.
+    std::vector<std::vector<int> > nodeCpus;
+    std::vector<int> cpuNode;
+    pthread_once_t topologyOnce = PTHREAD_ONCE_INIT;
+    // Reads the NUMA topology reported by the kernel, or else assumes a single node, and
+    // skips nodes without any processors that we are allowed to run on.
+    void readTopology() {
+        std::vector<int> nodes(parseList(readLine("/sys/devices/system/node/online")));
+        for(std::vector<int>::const_iterator node = nodes.begin(); node != nodes.end(); ++node) {
+            std::vector<int> cpus(parseList(readLine("/sys/devices/system/node/node" +
+                boost::lexical_cast<std::string>(*node) + "/cpulist")));
+            removeDisallowed(cpus);
+            if(!cpus.empty()) nodeCpus.push_back(cpus);
+        }
+        if(nodeCpus.empty()) {
+            long nProcessors(sysconf(_SC_NPROCESSORS_ONLN));
+            std::vector<int> cpus;
+            for(int cpu = 0; cpu < nProcessors; ++cpu) cpus.push_back(cpu);
+            removeDisallowed(cpus);
+            if(cpus.empty()) cpus.push_back(0);
+            nodeCpus.push_back(cpus);
+        }
+        for(int node = 0; node < nodeCpus.size(); ++node) {
+            for(std::vector<int>::const_iterator cpu = nodeCpus[node].begin();
+            cpu != nodeCpus[node].end(); ++cpu) {
+                if(*cpu >= cpuNode.size()) cpuNode.resize(*cpu + 1,0);
+                cpuNode[*cpu] = node;
+            }
+        }
+    }
+    void initTopology() {
+        pthread_once(&topologyOnce,&readTopology);
+    }
+}} // likely::threadpool
+
+namespace likely {
+    class ThreadPool::TaskGroup::Implementation {
+    public:
+        Implementation() : pending(0) {
+            pthread_mutex_init(&mutex,0);
+            pthread_cond_init(&allDone,0);
+        }
+        ~Implementation() {
+            pthread_cond_destroy(&allDone);
+            pthread_mutex_destroy(&mutex);
+        }
+        // Records that one of our tasks has completed, with the specified error message
+        // if it failed. We must not be accessed after the last task has completed, since
+        // a waiting thread may then destroy us.
+        void done(std::string const &message) {
+            pthread_mutex_lock(&mutex);
+            if(!message.empty() && error.empty()) error = message;
+            if(0 == --pending) pthread_cond_broadcast(&allDone);
+            pthread_mutex_unlock(&mutex);
+        }
+        pthread_mutex_t mutex;
+        pthread_cond_t allDone;
+        int pending;
+        std::string error;
+    }; // ThreadPool::TaskGroup::Implementation
+    class ThreadPool::Implementation {
+    public:
+        Implementation()
+        : generation(threadpool::forkGeneration), stopping(false), deterministic(true) {
+            pthread_mutex_init(&mutex,0);
+            pthread_cond_init(&taskAvailable,0);
+        }
+        ~Implementation() {
+            // Our mutex might have been locked by one of our workers when this process was
+            // forked, so leave it alone in a child process.
+            if(isForked()) return;
+            pthread_cond_destroy(&taskAvailable);
+            pthread_mutex_destroy(&mutex);
+        }
+        // Returns true if we were created before the fork() that created this process, so
+        // none of our worker threads exist.
+        bool isForked() const { return generation != threadpool::forkGeneration; }
+        // Stops and joins all of our worker threads, after they finish any queued tasks.
+        void stop() {
+            if(isForked()) return;
+            pthread_mutex_lock(&mutex);
+            stopping = true;
+            pthread_cond_broadcast(&taskAvailable);
+            pthread_mutex_unlock(&mutex);
+            for(std::vector<pthread_t>::iterator iter = threads.begin(); iter != threads.end(); ++iter) {
+                pthread_join(*iter,0);
+            }
+            threads.clear();
+        }
+        // Runs a task and returns its error message, or an empty string if it succeeded.
+        static std::string run(Task const &task) {
+            std::string message;
+            try {
+                task();
+            }
+            catch(std::exception const &e) {
+                message = e.what();
+                if(message.empty()) message = "unknown error";
+            }
+            catch(...) {
+                message = "unknown exception";
+            }
+            return message;
+        }
+        // Identifies one worker thread and the processor it is pinned to, if any.
+        struct Worker {
+            Implementation *self;
+            int index, cpu, node;
+        };
+        // A queued task and the group it belongs to.
+        struct Entry {
+            Task task;
+            TaskGroup::Implementation *group;
+        };
+        // Runs tasks from our queues until we are stopped, taking tasks submitted to this
+        // worker before tasks that any worker can run.
+        static void *work(void *arg) {
+            Worker const *worker(static_cast<Worker*>(arg));
+            Implementation *self(worker->self);
+            threadpool::setWorker();
+            std::deque<Entry> &own(self->workerTasks[worker->index]);
+            while(true) {
+                Entry entry;
+                pthread_mutex_lock(&self->mutex);
+                while(own.empty() && self->tasks.empty() && !self->stopping) {
+                    pthread_cond_wait(&self->taskAvailable,&self->mutex);
+                }
+                std::deque<Entry> &queue(own.empty() ? self->tasks : own);
+                if(queue.empty()) {
+                    pthread_mutex_unlock(&self->mutex);
+                    break;
+                }
+                entry.task.swap(queue.front().task);
+                entry.group = queue.front().group;
+                queue.pop_front();
+                pthread_mutex_unlock(&self->mutex);
+                // Run this task without holding our lock, and report it to its group.
+                std::string message(run(entry.task));
+                entry.task.clear();
+                entry.group->done(message);
+            }
+            return 0;
+        }
+        pthread_mutex_t mutex;
+        pthread_cond_t taskAvailable;
+        std::deque<Entry> tasks;
+        std::vector<std::deque<Entry> > workerTasks;
+        std::vector<Worker> workers;
+        std::vector<pthread_t> threads;
+        int generation;
+        bool stopping, deterministic;
+    }; // ThreadPool::Implementation
+} // likely
+
+namespace local = likely;
+
+local::ThreadPool::ThreadPool(int nThreads, bool pinWorkers)
+: _pimpl(new Implementation())
+{
+    if(nThreads < 0) {
+        throw RuntimeError("ThreadPool: invalid number of threads.");
+    }
+    if(0 == nThreads) {
+        long nProcessors(sysconf(_SC_NPROCESSORS_ONLN));
+        nThreads = nProcessors > 0 ? (int)nProcessors : 1;
+    }
+    // Assign pinned workers to NUMA nodes in turn, so that any number of workers is spread
+    // evenly over the nodes.
+    pthread_once(&threadpool::atForkOnce,&threadpool::registerAtFork);
+    if(pinWorkers) threadpool::initTopology();
+    std::vector<std::vector<int> > const &nodeCpus(threadpool::nodeCpus);
+    _pimpl->workerTasks.resize(nThreads);
+    _pimpl->workers.resize(nThreads);
+    for(int k = 0; k < nThreads; ++k) {
+        Implementation::Worker &worker(_pimpl->workers[k]);
+        worker.self = _pimpl.get();
+        worker.index = k;
+        worker.cpu = worker.node = -1;
+        if(pinWorkers) {
+            worker.node = k % nodeCpus.size();
+            std::vector<int> const &cpus(nodeCpus[worker.node]);
+            worker.cpu = cpus[(k/nodeCpus.size()) % cpus.size()];
+        }
+    }
+    _pimpl->threads.reserve(nThreads);
+    for(int k = 0; k < nThreads; ++k) {
+        pthread_t thread;
+        if(0 != pthread_create(&thread,0,&Implementation::work,&_pimpl->workers[k])) {
+            // Stop any threads we already started before giving up.
+            _pimpl->stop();
+            throw RuntimeError("ThreadPool: unable to create worker thread.");
+        }
+        _pimpl->threads.push_back(thread);
+        // Pin this worker before any tasks are submitted, or else record that it is not
+        // pinned, e.g., because its processor is no longer available.
+        Implementation::Worker &worker(_pimpl->workers[k]);
+        if(worker.cpu < 0) continue;
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(worker.cpu,&cpus);
+        if(0 == pthread_setaffinity_np(thread,sizeof(cpus),&cpus)) continue;
+#endif
+        worker.cpu = worker.node = -1;
+    }
+}
+
+local::ThreadPool::~ThreadPool() {
+    _pimpl->stop();
+}
+
+int local::ThreadPool::getNThreads() const {
+    return _pimpl->threads.size();
+}
+
+bool local::ThreadPool::isPinned() const {
+    for(int k = 0; k < _pimpl->workers.size(); ++k) {
+        if(_pimpl->workers[k].cpu < 0) return false;
+    }
+    return !_pimpl->workers.empty();
+}
+
+int local::ThreadPool::getWorkerNode(int worker) const {
+    if(worker < 0 || worker >= _pimpl->workers.size()) {
+        throw RuntimeError("ThreadPool::getWorkerNode: invalid worker.");
+    }
+    return _pimpl->workers[worker].node;
+}
+
+local::ThreadPool::TaskGroup::TaskGroup(ThreadPool &pool)
+: _pool(pool), _pimpl(new Implementation())
+{ }
+
+local::ThreadPool::TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    }
+    catch(RuntimeError const &e) { }
+}
+
+void local::ThreadPool::TaskGroup::submit(Task task) {
+    if(!task) {
+        throw RuntimeError("ThreadPool::TaskGroup::submit: got empty task.");
+    }
+    ThreadPool::Implementation &pool(*_pool._pimpl);
+    ThreadPool::Implementation::Entry entry;
+    entry.task = task;
+    entry.group = _pimpl.get();
+    pthread_mutex_lock(&_pimpl->mutex);
+    _pimpl->pending++;
+    pthread_mutex_unlock(&_pimpl->mutex);
+    if(pool.isForked()) {
+        // Run this task now, since our pool has no worker threads in this process.
+        _pimpl->done(ThreadPool::Implementation::run(task));
+        return;
+    }
+    pthread_mutex_lock(&pool.mutex);
+    pool.tasks.push_back(entry);
+    pthread_cond_signal(&pool.taskAvailable);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+void local::ThreadPool::TaskGroup::submit(Task task, int worker) {
+    if(!task) {
+        throw RuntimeError("ThreadPool::TaskGroup::submit: got empty task.");
+    }
+    ThreadPool::Implementation &pool(*_pool._pimpl);
+    if(worker < 0 || worker >= pool.workerTasks.size()) {
+        throw RuntimeError("ThreadPool::TaskGroup::submit: invalid worker.");
+    }
+    ThreadPool::Implementation::Entry entry;
+    entry.task = task;
+    entry.group = _pimpl.get();
+    pthread_mutex_lock(&_pimpl->mutex);
+    _pimpl->pending++;
+    pthread_mutex_unlock(&_pimpl->mutex);
+    if(pool.isForked()) {
+        // Run this task now, since our pool has no worker threads in this process.
+        _pimpl->done(ThreadPool::Implementation::run(task));
+        return;
+    }
+    pthread_mutex_lock(&pool.mutex);
+    pool.workerTasks[worker].push_back(entry);
+    // Wake all workers since we cannot signal a specific one.
+    pthread_cond_broadcast(&pool.taskAvailable);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+void local::ThreadPool::TaskGroup::wait() {
+    std::string error;
+    pthread_mutex_lock(&_pimpl->mutex);
+    while(_pimpl->pending > 0) pthread_cond_wait(&_pimpl->allDone,&_pimpl->mutex);
+    error.swap(_pimpl->error);
+    pthread_mutex_unlock(&_pimpl->mutex);
+    if(!error.empty()) {
+        throw RuntimeError("ThreadPool::wait: task failed: " + error);
+    }
+}
+
+bool local::ThreadPool::isWorkerThread() {
+    return threadpool::getWorker();
+}
+
+void local::ThreadPool::parallelFor(int begin, int end, RangeTask body, int chunkSize) {
+    if(chunkSize < 0) {
+        throw RuntimeError("ThreadPool::parallelFor: invalid chunk size.");
+    }
+    if(end <= begin) return;
+    if(0 == chunkSize) {
+        int nChunks(4*getNThreads());
+        chunkSize = (end - begin + nChunks - 1)/nChunks;
+    }
+    TaskGroup group(*this);
+    for(int first = begin; first < end; first += chunkSize) {
+        group.submit(boost::bind(body,first,std::min(first + chunkSize,end)));
+    }
+    group.wait();
+}
+
+void local::ThreadPool::parallelForPartitioned(int begin, int end, RangeTask body) {
+    if(end <= begin) return;
+    int nThreads(getNThreads());
+    TaskGroup group(*this);
+    for(int worker = 0; worker < nThreads; ++worker) {
+        int first(begin + ((long)end - begin)*worker/nThreads);
+        int last(begin + ((long)end - begin)*(worker+1)/nThreads);
+        if(last > first) group.submit(boost::bind(body,first,last),worker);
+    }
+    group.wait();
+}
+
+double local::ThreadPool::parallelSum(int begin, int end, RangeSum body, int chunkSize) {
+    if(chunkSize < 0) {
+        throw RuntimeError("ThreadPool::parallelSum: invalid chunk size.");
+    }
+    if(end <= begin) return 0;
+    if(0 == chunkSize) {
+        if(isDeterministic()) {
+            chunkSize = threadpool::defaultReductionChunkSize;
+        }
+        else {
+            int nChunks(4*getNThreads());
+            chunkSize = (end - begin + nChunks - 1)/nChunks;
+        }
+    }
+    std::vector<double> partial(((std::size_t)end - begin + chunkSize - 1)/chunkSize);
+    TaskGroup group(*this);
+    for(std::size_t chunk = 0; chunk < partial.size(); ++chunk) {
+        int first(begin + chunk*chunkSize);
+        group.submit(boost::bind(threadpool::sumChunk,body,first,std::min(first + chunkSize,end),
+            &partial[chunk]));
+    }
+    group.wait();
+    return pairwiseSum(partial);
+}
+
+void local::ThreadPool::setDeterministic(bool deterministic) {
+    _pimpl->deterministic = deterministic;
+}
+
+bool local::ThreadPool::isDeterministic() const {
+    return _pimpl->deterministic;
+}
+
+int local::getNumaNodeCount() {
+    threadpool::initTopology();
+    return threadpool::nodeCpus.size();
+}
+
+int local::getCurrentNumaNode() {
+    threadpool::initTopology();
+#ifdef HAVE_SCHED_GETCPU
+    int cpu(sched_getcpu());
+#else
+    int cpu(-1);
+#endif
+    return (cpu >= 0 && cpu < threadpool::cpuNode.size()) ? threadpool::cpuNode[cpu] : 0;
+}
+
+double local::pairwiseSum(std::vector<double> const &values) {
+    return values.empty() ? 0 : threadpool::pairwiseSum(&values[0],values.size());
+}
+
+namespace likely {
+namespace threadpool {
+    ThreadPoolPtr defaultPool;
+    pthread_once_t defaultPoolOnce = PTHREAD_ONCE_INIT;
+    void createDefaultPool() {
+        defaultPool.reset(new ThreadPool());
+    }
+}} // likely::threadpool
+
+local::ThreadPoolPtr local::getDefaultThreadPool() {
+    pthread_once(&threadpool::defaultPoolOnce,&threadpool::createDefaultPool);
+    return threadpool::defaultPool;
+}
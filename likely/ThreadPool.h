@@ -0,0 +1,119 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_THREAD_POOL
+#define LIKELY_THREAD_POOL
+
+#include "likely/types.h"
+
+#include "boost/function.hpp"
+#include "boost/smart_ptr.hpp"
+#include "boost/utility.hpp"
+
+#include <vector>
+
+namespace likely {
+    // Runs tasks on a fixed set of worker threads. Tasks are run in the order they are
+    // submitted, but may complete in any order. Any task that needs to share data with
+    // other tasks is responsible for its own locking. A child process created with fork()
+    // has none of the worker threads of the pools created before the fork, so these pools
+    // run every task in the submitting thread of the child instead.
+	class ThreadPool : boost::noncopyable {
+	public:
+	    // Creates a new pool of the specified number of worker threads, or else one
+	    // thread per online processor when nThreads is zero. Use pinWorkers = true to pin
+	    // each worker to one processor, with workers assigned to NUMA nodes in turn (worker k
+	    // runs on node k % getNumaNodeCount()), so that data first touched by a worker
+	    // stays local to the processor that uses it (see parallelForPartitioned). Only
+	    // processors that this process is allowed to run on are used. Pinning is skipped
+	    // for any worker that cannot be pinned, and on platforms without thread affinity.
+		explicit ThreadPool(int nThreads = 0, bool pinWorkers = false);
+		// Waits for any unfinished tasks to complete before stopping our worker threads.
+		virtual ~ThreadPool();
+		// Returns the number of worker threads in this pool.
+        int getNThreads() const;
+        // Returns true if all of our workers are pinned to processors.
+        bool isPinned() const;
+        // Returns the NUMA node that the specified worker is pinned to, or -1 if it is
+        // not pinned.
+        int getWorkerNode(int worker) const;
+        typedef boost::function<void ()> Task;
+        // Tracks the completion of one batch of tasks run by a pool, with its own count of
+        // unfinished tasks and its own saved error, so that several threads can share a
+        // pool without waiting for each other's tasks or receiving each other's errors.
+        class TaskGroup : boost::noncopyable {
+        public:
+            // Creates a new empty group of tasks to run on the specified pool.
+            explicit TaskGroup(ThreadPool &pool);
+            // Waits for any unfinished tasks of this group, ignoring their errors.
+            virtual ~TaskGroup();
+            // Submits a task of this group to run on the next available worker thread and
+            // returns immediately. Can be called from within a task of this group.
+            void submit(Task task);
+            // Submits a task of this group to run on the specified worker thread,
+            // 0 <= worker < getNThreads(), and returns immediately.
+            void submit(Task task, int worker);
+            // Waits until all tasks submitted to this group so far have completed. Throws
+            // a RuntimeError if any of them threw an exception, after all have completed.
+            // Must not be called from within a task.
+            void wait();
+            // Implementation details shared with our pool.
+            class Implementation;
+        private:
+            ThreadPool &_pool;
+            boost::scoped_ptr<Implementation> _pimpl;
+        }; // TaskGroup
+        // Calls body(first,last) for consecutive chunks [first,last) of the range [begin,end)
+        // using our worker threads, and waits until all chunks have completed. Chunks have
+        // the specified size (except for the last), or else a size that gives about four
+        // chunks per thread when chunkSize is zero. Must not be called from within a task.
+        typedef boost::function<void (int,int)> RangeTask;
+        void parallelFor(int begin, int end, RangeTask body, int chunkSize = 0);
+        // Calls body(first,last) for getNThreads() consecutive partitions [first,last) of the
+        // range [begin,end) of equal size, with partition k always run by worker k, and waits
+        // until all partitions have completed. Use this to first touch large buffers with
+        // pinned workers and then process them, so that each worker reads memory on its own
+        // NUMA node. Must not be called from within a task.
+        void parallelForPartitioned(int begin, int end, RangeTask body);
+        // Returns the sum of body(first,last) over consecutive chunks [first,last) of the range
+        // [begin,end), calculated using our worker threads. In deterministic mode (the
+        // default), chunks have the specified size, or else 256 when chunkSize is zero, which
+        // does not depend on the number of threads, and the partial sums are combined with
+        // pairwiseSum in a fixed order, so the result is bit-identical for any number of
+        // threads. Otherwise, chunks are sized like parallelFor, which has less overhead but
+        // gives a result that depends on the number of threads. Must not be called from
+        // within a task.
+        typedef boost::function<double (int,int)> RangeSum;
+        double parallelSum(int begin, int end, RangeSum body, int chunkSize = 0);
+        // Enables or disables the deterministic mode of parallelSum for this pool.
+        void setDeterministic(bool deterministic);
+        bool isDeterministic() const;
+        // Returns true if the calling thread is a worker thread of any pool, so that code
+        // which might be called from within a task can avoid calling TaskGroup::wait() or parallelFor().
+        static bool isWorkerThread();
+	private:
+        class Implementation;
+        boost::scoped_ptr<Implementation> _pimpl;
+        friend class TaskGroup;
+	}; // ThreadPool
+
+    // Returns a shared pool with one thread per online processor that is created the
+    // first time it is requested. A forked child process gets the pool of its parent, if
+    // any, which then runs its tasks serially (see above), so that forked workers do not
+    // compete with each other for processors.
+    ThreadPoolPtr getDefaultThreadPool();
+
+    // Returns the number of NUMA nodes with online processors that this process is allowed
+    // to run on, as reported by the kernel, or one if this is not available. Nodes are
+    // numbered from zero in the order reported.
+    int getNumaNodeCount();
+    // Returns the NUMA node of the processor running the calling thread, or zero if unknown.
+    int getCurrentNumaNode();
+
+    // Returns the sum of the specified values calculated by recursively summing each half,
+    // which gives a result that only depends on the values and their order, with a rounding
+    // error that grows as log(n) instead of n.
+    double pairwiseSum(std::vector<double> const &values);
+
+} // likely
+
+#endif // LIKELY_THREAD_POOL
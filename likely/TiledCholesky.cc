@@ -0,0 +1,402 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#include "likely/TiledCholesky.h"
+#include "likely/CovarianceMatrix.h"
+#include "likely/ThreadPool.h"
+#include "likely/RuntimeError.h"
+
+#include "boost/bind.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Declare bindings to BLAS,LAPACK routines we need
+extern "C" {
+    // http://www.netlib.org/lapack/double/dpotrf.f
+    void dpotrf_(char const *uplo, int const *n, double *a, int const *lda, int *info);
+    // http://www.netlib.org/lapack/double/dtrtri.f
+    void dtrtri_(char const *uplo, char const *diag, int const *n, double *a, int const *lda,
+        int *info);
+    // http://www.netlib.org/lapack/double/dlauum.f
+    void dlauum_(char const *uplo, int const *n, double *a, int const *lda, int *info);
+    // http://www.netlib.org/blas/dtrsm.f
+    void dtrsm_(char const *side, char const *uplo, char const *transa, const char *diag,
+        int const *m, int const *n, double const *alpha, double const *a, int const *lda,
+        double *b, int const *ldb);
+    // http://www.netlib.org/blas/dtrmm.f
+    void dtrmm_(char const *side, char const *uplo, char const *transa, const char *diag,
+        int const *m, int const *n, double const *alpha, double const *a, int const *lda,
+        double *b, int const *ldb);
+    // http://www.netlib.org/blas/dsyrk.f
+    void dsyrk_(char const *uplo, char const *trans, int const *n, int const *k,
+        double const *alpha, double const *a, int const *lda, double const *beta,
+        double *c, int const *ldc);
+    // http://www.netlib.org/blas/dgemm.f
+    void dgemm_(char const *transa, char const *transb, int const *m, int const *n,
+        int const *k, double const *alpha, double const *a, int const *lda, double const *b,
+        int const *ldb, double const *beta, double *c, int const *ldc);
+}
+
+namespace local = likely;
+
+namespace likely {
+namespace tiled {
+    // The tile size used when none is specified.
+    int const defaultTileSize = 128;
+    // The minimum matrix size for using tiles in choleskyDecompose and invertCholesky.
+    int minSize = 512;
+    // The maximum size of a packed matrix whose elements can be indexed with an int, as
+    // required by the LAPACK packed routines.
+    int const maxPackedSize = 65535;
+    // Returns the default pool, or else no pool when called from within a task, since
+    // waiting for the default pool from one of its tasks could deadlock.
+    ThreadPoolPtr getPool() {
+        return ThreadPool::isWorkerThread() ? ThreadPoolPtr() : getDefaultThreadPool();
+    }
+    // Stores the upper triangle of a symmetric or upper-triangular matrix as square tiles,
+    // each in column-major order. Tiles below the diagonal are not stored and elements below
+    // the diagonal of a diagonal tile are zero.
+    class Tiles {
+    public:
+        Tiles(int size, int tileSize) : _size(size), _tileSize(tileSize) {
+            _nTiles = (size + tileSize - 1)/tileSize;
+            Index offset(0);
+            for(int j = 0; j < _nTiles; ++j) {
+                for(int i = 0; i <= j; ++i) {
+                    _offset.push_back(offset);
+                    offset += (Index)getDim(i)*getDim(j);
+                }
+            }
+            _data.resize(offset,0);
+        }
+        int getNTiles() const { return _nTiles; }
+        // Returns the number of rows (or columns) in the i-th row (or column) of tiles.
+        int getDim(int i) const { return std::min(_tileSize,_size - i*_tileSize); }
+        // Returns a pointer to the first element of the tile in row i and column j >= i.
+        double *get(int i, int j) { return &_data[_offset[i + (j*(j+1))/2]]; }
+        // Copies the tile in row i and column j >= i from/to a packed matrix in the
+        // BLAS packed 'U' format implied by symmetricMatrixIndex.
+        void unpack(double const *packed, int i, int j) {
+            double *tile(get(i,j));
+            int rows(getDim(i)), cols(getDim(j));
+            for(int b = 0; b < cols; ++b) {
+                int col(j*_tileSize + b);
+                double const *column(&packed[((Index)col*(col+1))/2]);
+                for(int a = 0; a < rows; ++a) {
+                    int row(i*_tileSize + a);
+                    tile[b*rows + a] = (row <= col) ? column[row] : 0;
+                }
+            }
+        }
+        void pack(double *packed, int i, int j) {
+            double const *tile(get(i,j));
+            int rows(getDim(i)), cols(getDim(j));
+            for(int b = 0; b < cols; ++b) {
+                int col(j*_tileSize + b);
+                double *column(&packed[((Index)col*(col+1))/2]);
+                for(int a = 0; a < rows; ++a) {
+                    int row(i*_tileSize + a);
+                    if(row <= col) column[row] = tile[b*rows + a];
+                }
+            }
+        }
+        void unpack(double const *packed) {
+            for(int j = 0; j < _nTiles; ++j) {
+                for(int i = 0; i <= j; ++i) unpack(packed,i,j);
+            }
+        }
+        void pack(double *packed) {
+            for(int j = 0; j < _nTiles; ++j) {
+                for(int i = 0; i <= j; ++i) pack(packed,i,j);
+            }
+        }
+    private:
+        int _size, _tileSize, _nTiles;
+        std::vector<Index> _offset;
+        AlignedVector _data;
+    }; // Tiles
+    // Runs a graph of tasks on a thread pool, starting each task as soon as all of the
+    // tasks it depends on have completed, or else runs them in the calling thread, in an
+    // order that respects their dependencies, when no pool is provided.
+    class TaskGraph {
+    public:
+        TaskGraph(ThreadPoolPtr pool) : _pool(pool), _group(0) { }
+        // Adds a new task and returns its index.
+        int add(ThreadPool::Task task) {
+            _nodes.push_back(Node());
+            _nodes.back().task = task;
+            return _nodes.size()-1;
+        }
+        // Records that the task with index node cannot start until the task with index
+        // other has completed, where other must have been added before node. Does nothing
+        // if other < 0.
+        void depends(int node, int other) {
+            if(other < 0) return;
+            std::vector<int> &successors(_nodes[other].successors);
+            if(std::find(successors.begin(),successors.end(),node) != successors.end()) return;
+            successors.push_back(node);
+            _nodes[node].nPending++;
+        }
+        // Runs all tasks and waits for them to complete. Any task that throws an exception
+        // prevents the tasks that depend on it from running.
+        void run() {
+            std::vector<int> ready;
+            for(int node = 0; node < _nodes.size(); ++node) {
+                if(0 == _nodes[node].nPending) ready.push_back(node);
+            }
+            if(!_pool) {
+                // Run each task after the tasks it depends on, since they were all
+                // added before it.
+                for(int node = 0; node < _nodes.size(); ++node) _nodes[node].task();
+                return;
+            }
+            ThreadPool::TaskGroup group(*_pool);
+            _group = &group;
+            for(std::vector<int>::const_iterator iter = ready.begin(); iter != ready.end(); ++iter) {
+                group.submit(boost::bind(&TaskGraph::_run,this,*iter));
+            }
+            group.wait();
+        }
+    private:
+        struct Node {
+            Node() : nPending(0) { }
+            ThreadPool::Task task;
+            std::vector<int> successors;
+            int nPending;
+        };
+        void _run(int node) {
+            _nodes[node].task();
+            std::vector<int> const &successors(_nodes[node].successors);
+            for(std::vector<int>::const_iterator iter = successors.begin(); iter != successors.end(); ++iter) {
+                if(0 == __sync_sub_and_fetch(&_nodes[*iter].nPending,1)) {
+                    _group->submit(boost::bind(&TaskGraph::_run,this,*iter));
+                }
+            }
+        }
+        ThreadPoolPtr _pool;
+        ThreadPool::TaskGroup *_group;
+        std::vector<Node> _nodes;
+    }; // TaskGraph
+    // Tile kernels for the Cholesky decomposition A = U*.U
+    void potrf(Tiles *A, int k) {
+        int n(A->getDim(k)), info(0);
+        char uplo('U');
+        dpotrf_(&uplo,&n,A->get(k,k),&n,&info);
+        if(0 != info) throw RuntimeError("matrix is not positive definite.");
+    }
+    void trsm(Tiles *A, int k, int j) {
+        // A[k,j] -> Ukk*^-1.A[k,j]
+        int m(A->getDim(k)), n(A->getDim(j));
+        double alpha(1);
+        char side('L'), uplo('U'), transa('T'), diag('N');
+        dtrsm_(&side,&uplo,&transa,&diag,&m,&n,&alpha,A->get(k,k),&m,A->get(k,j),&m);
+    }
+    void update(Tiles *A, int k, int i, int j) {
+        // A[i,j] -> A[i,j] - U[k,i]*.U[k,j]
+        int m(A->getDim(i)), n(A->getDim(j)), nk(A->getDim(k));
+        double alpha(-1), beta(1);
+        if(i == j) {
+            char uplo('U'), trans('T');
+            dsyrk_(&uplo,&trans,&m,&nk,&alpha,A->get(k,i),&nk,&beta,A->get(i,i),&m);
+        }
+        else {
+            char transa('T'), transb('N');
+            dgemm_(&transa,&transb,&m,&n,&nk,&alpha,A->get(k,i),&nk,A->get(k,j),&nk,
+                &beta,A->get(i,j),&m);
+        }
+    }
+    // Tile kernels for the triangular inverse W = Uinv
+    void trtri(Tiles *U, Tiles *W, int j) {
+        int n(W->getDim(j)), info(0);
+        std::copy(U->get(j,j),U->get(j,j) + n*n,W->get(j,j));
+        char uplo('U'), diag('N');
+        dtrtri_(&uplo,&diag,&n,W->get(j,j),&n,&info);
+        if(0 != info) throw RuntimeError("symmetric matrix inversion failed.");
+    }
+    void accumulate(Tiles *U, Tiles *W, int i, int k, int j) {
+        // W[i,j] -> W[i,j] - U[i,k].W[k,j]
+        int m(W->getDim(i)), n(W->getDim(j)), nk(W->getDim(k));
+        double alpha(-1), beta(1);
+        char transa('N'), transb('N');
+        dgemm_(&transa,&transb,&m,&n,&nk,&alpha,U->get(i,k),&m,W->get(k,j),&nk,
+            &beta,W->get(i,j),&m);
+    }
+    void solve(Tiles *U, Tiles *W, int i, int j) {
+        // W[i,j] -> Uii^-1.W[i,j]
+        int m(W->getDim(i)), n(W->getDim(j));
+        double alpha(1);
+        char side('L'), uplo('U'), transa('N'), diag('N');
+        dtrsm_(&side,&uplo,&transa,&diag,&m,&n,&alpha,U->get(i,i),&m,W->get(i,j),&m);
+    }
+    // Calculates the tile [i,j] of W.W* and saves it in a packed matrix.
+    void product(Tiles *W, Tiles *result, double *packed, int i, int j) {
+        int m(W->getDim(i)), n(W->getDim(j)), nTiles(W->getNTiles());
+        double *tile(result->get(i,j)), alpha(1), beta(1);
+        std::copy(W->get(i,j),W->get(i,j) + m*n,tile);
+        if(i == j) {
+            int info(0);
+            char uplo('U');
+            dlauum_(&uplo,&m,tile,&m,&info);
+        }
+        else {
+            char side('R'), uplo('U'), transa('T'), diag('N');
+            dtrmm_(&side,&uplo,&transa,&diag,&m,&n,&alpha,W->get(j,j),&n,tile,&m);
+        }
+        for(int k = j+1; k < nTiles; ++k) {
+            int nk(W->getDim(k));
+            if(i == j) {
+                char uplo('U'), trans('N');
+                dsyrk_(&uplo,&trans,&m,&nk,&alpha,W->get(i,k),&m,&beta,tile,&m);
+            }
+            else {
+                char transa('N'), transb('T');
+                dgemm_(&transa,&transb,&m,&n,&nk,&alpha,W->get(i,k),&m,W->get(j,k),&n,
+                    &beta,tile,&m);
+            }
+        }
+        result->pack(packed,i,j);
+    }
+    // Implements tiledCholeskyDecompose for both vector types.
+    template <class Vector> double decompose(Vector &matrix, int size, ThreadPoolPtr pool,
+    int tileSize) {
+        if(size <= 0 || (Index)matrix.size() != symmetricMatrixElements(size)) {
+            throw RuntimeError("tiledCholeskyDecompose: matrix has wrong size.");
+        }
+        if(tileSize < 0) {
+            throw RuntimeError("tiledCholeskyDecompose: invalid tile size.");
+        }
+        if(0 == tileSize) tileSize = defaultTileSize;
+        if(!pool) pool = getPool();
+        Tiles A(size,tileSize);
+        A.unpack(&matrix[0]);
+        // Build the graph of tile tasks, using last[i+j*(j+1)/2] to track the last task
+        // that updates the tile [i,j].
+        int nTiles(A.getNTiles());
+        TaskGraph graph(pool);
+        std::vector<int> last((nTiles*(nTiles+1))/2,-1);
+        for(int k = 0; k < nTiles; ++k) {
+            int kk(k + (k*(k+1))/2);
+            int factor = graph.add(boost::bind(potrf,&A,k));
+            graph.depends(factor,last[kk]);
+            last[kk] = factor;
+            for(int j = k+1; j < nTiles; ++j) {
+                int kj(k + (j*(j+1))/2);
+                int task = graph.add(boost::bind(trsm,&A,k,j));
+                graph.depends(task,factor);
+                graph.depends(task,last[kj]);
+                last[kj] = task;
+            }
+            for(int j = k+1; j < nTiles; ++j) {
+                for(int i = k+1; i <= j; ++i) {
+                    int ij(i + (j*(j+1))/2);
+                    int task = graph.add(boost::bind(update,&A,k,i,j));
+                    graph.depends(task,last[k + (i*(i+1))/2]);
+                    graph.depends(task,last[k + (j*(j+1))/2]);
+                    graph.depends(task,last[ij]);
+                    last[ij] = task;
+                }
+            }
+        }
+        try {
+            graph.run();
+        }
+        catch(RuntimeError const &e) {
+            throw RuntimeError("tiledCholeskyDecompose: matrix is not positive definite.");
+        }
+        A.pack(&matrix[0]);
+        // Calculate the log of the product of diagonal Cholesky matrix elements squared.
+        double logdet(0);
+        for(int index = 0; index < size; ++index) {
+            logdet += 2*std::log(matrix[symmetricMatrixIndex(index,index,size)]);
+        }
+        return logdet;
+    }
+    // Implements tiledInvertCholesky for both vector types.
+    template <class Vector> void invert(Vector &matrix, int size, ThreadPoolPtr pool,
+    int tileSize) {
+        if(size <= 0 || (Index)matrix.size() != symmetricMatrixElements(size)) {
+            throw RuntimeError("tiledInvertCholesky: matrix has wrong size.");
+        }
+        if(tileSize < 0) {
+            throw RuntimeError("tiledInvertCholesky: invalid tile size.");
+        }
+        if(0 == tileSize) tileSize = defaultTileSize;
+        if(!pool) pool = getPool();
+        Tiles U(size,tileSize), W(size,tileSize);
+        U.unpack(&matrix[0]);
+        // Build the graph of tasks to solve U.W = 1 one column of tiles at a time, using
+        // last[i+j*(j+1)/2] to track the last task that updates the tile [i,j] of W.
+        int nTiles(U.getNTiles());
+        TaskGraph graph(pool);
+        std::vector<int> last((nTiles*(nTiles+1))/2,-1);
+        for(int j = 0; j < nTiles; ++j) {
+            last[j + (j*(j+1))/2] = graph.add(boost::bind(trtri,&U,&W,j));
+            for(int i = j-1; i >= 0; --i) {
+                int ij(i + (j*(j+1))/2);
+                for(int k = i+1; k <= j; ++k) {
+                    int task = graph.add(boost::bind(accumulate,&U,&W,i,k,j));
+                    graph.depends(task,last[k + (j*(j+1))/2]);
+                    graph.depends(task,last[ij]);
+                    last[ij] = task;
+                }
+                int task = graph.add(boost::bind(solve,&U,&W,i,j));
+                graph.depends(task,last[ij]);
+                last[ij] = task;
+            }
+        }
+        // Add the tasks to calculate the tiles of Uinv.Uinv* = W.W*. Tile [i,j] of the result
+        // needs the tiles [i,k] and [j,k] of W with k >= j. Tile [i,j] of U is only needed to
+        // calculate the tiles [i,k] of W with k >= j, so we can reuse its storage for the result.
+        for(int j = 0; j < nTiles; ++j) {
+            for(int i = 0; i <= j; ++i) {
+                int task = graph.add(boost::bind(product,&W,&U,&matrix[0],i,j));
+                for(int k = j; k < nTiles; ++k) {
+                    graph.depends(task,last[i + (k*(k+1))/2]);
+                    graph.depends(task,last[j + (k*(k+1))/2]);
+                }
+            }
+        }
+        try {
+            graph.run();
+        }
+        catch(RuntimeError const &e) {
+            throw RuntimeError("tiledInvertCholesky: symmetric matrix inversion failed.");
+        }
+    }
+}} // likely::tiled
+
+double local::tiledCholeskyDecompose(std::vector<double> &matrix, int size,
+ThreadPoolPtr pool, int tileSize) {
+    return tiled::decompose(matrix,size,pool,tileSize);
+}
+
+double local::tiledCholeskyDecompose(AlignedVector &matrix, int size,
+ThreadPoolPtr pool, int tileSize) {
+    return tiled::decompose(matrix,size,pool,tileSize);
+}
+
+void local::tiledInvertCholesky(std::vector<double> &matrix, int size,
+ThreadPoolPtr pool, int tileSize) {
+    tiled::invert(matrix,size,pool,tileSize);
+}
+
+void local::tiledInvertCholesky(AlignedVector &matrix, int size,
+ThreadPoolPtr pool, int tileSize) {
+    tiled::invert(matrix,size,pool,tileSize);
+}
+
+int local::getTiledCholeskyMinSize() {
+    return tiled::minSize;
+}
+
+void local::setTiledCholeskyMinSize(int size) {
+    if(size < 0) {
+        throw RuntimeError("setTiledCholeskyMinSize: invalid size.");
+    }
+    tiled::minSize = size;
+}
+
+bool local::useTiledCholesky(int size) {
+    if(size > tiled::maxPackedSize) return true;
+    return tiled::minSize > 0 && size >= tiled::minSize && !ThreadPool::isWorkerThread();
+}
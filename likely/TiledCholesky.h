@@ -0,0 +1,43 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+
+#ifndef LIKELY_TILED_CHOLESKY
+#define LIKELY_TILED_CHOLESKY
+
+#include "likely/types.h"
+#include "likely/AlignedAllocator.h"
+
+#include <vector>
+
+namespace likely {
+    // Performs the same operation as choleskyDecompose (see CovarianceMatrix.h) by dividing the
+    // matrix into square tiles of the specified size, or else a default size when tileSize is
+    // zero, and running the factorization of each tile (POTRF), the triangular solves (TRSM)
+    // and the updates of the trailing tiles (SYRK, GEMM) as a graph of dependent tasks on the
+    // specified thread pool, or else the default pool. This gives multi-core scaling for large
+    // matrices even when the linked BLAS and LAPACK libraries are single threaded. When no pool
+    // is specified and this is called from within a thread pool task, the tiles are processed
+    // in the calling thread instead. Returns log(determinant) of the input matrix.
+    double tiledCholeskyDecompose(std::vector<double> &matrix, int size,
+        ThreadPoolPtr pool = ThreadPoolPtr(), int tileSize = 0);
+    double tiledCholeskyDecompose(AlignedVector &matrix, int size,
+        ThreadPoolPtr pool = ThreadPoolPtr(), int tileSize = 0);
+    // Performs the same operation as invertCholesky (see CovarianceMatrix.h) using tiles,
+    // by first inverting the triangular Cholesky decomposition U with a graph of triangular
+    // solve and update tasks, then calculating the tiles of Uinv.Uinv* in parallel.
+    void tiledInvertCholesky(std::vector<double> &matrix, int size,
+        ThreadPoolPtr pool = ThreadPoolPtr(), int tileSize = 0);
+    void tiledInvertCholesky(AlignedVector &matrix, int size,
+        ThreadPoolPtr pool = ThreadPoolPtr(), int tileSize = 0);
+    // Gets/sets the minimum matrix size for which choleskyDecompose and invertCholesky use
+    // the tiled versions above with the default thread pool, unless they are called from
+    // within a thread pool task. Use a size of zero to disable the tiled versions, except
+    // for matrices with more than 65535 rows, which are always tiled since the LAPACK
+    // packed routines index their elements with an int.
+    int getTiledCholeskyMinSize();
+    void setTiledCholeskyMinSize(int size);
+    // Returns true if the tiled versions should be used for a matrix of the specified size.
+    bool useTiledCholesky(int size);
+
+} // likely
+
+#endif // LIKELY_TILED_CHOLESKY
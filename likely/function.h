@@ -5,6 +5,9 @@
 
 #include "boost/function.hpp"
 #include "boost/smart_ptr.hpp"
+#include "boost/utility/enable_if.hpp"
+#include "boost/type_traits/is_same.hpp"
+#include "boost/type_traits/remove_const.hpp"
 
 namespace likely {
 
@@ -17,6 +20,100 @@ namespace likely {
     typedef boost::shared_ptr<GenericFunction> GenericFunctionPtr;
     template <class P> GenericFunctionPtr createFunctionPtr(boost::shared_ptr<P> pimpl);
 
+    namespace callable {
+        typedef char (&Yes)[1];
+        typedef char (&No)[2];
+        // Accepts any value that can be converted to R.
+        template <class R> struct Returns {
+            static Yes check(R);
+            static No check(...);
+        };
+        template <class T> T make();
+        // Defines value = true if an lvalue of type F can be called with the arguments of
+        // the specified signature and returns a value that can be converted to its return
+        // type, or else value = false. Calls with a void signature can return anything.
+        template <class F, class Signature> struct IsCallable;
+        template <class F, class R, class A1> struct IsCallable<F,R (A1)> {
+            template <class G> static char (&test(int))
+                [sizeof(Returns<R>::check((*static_cast<G*>(0))(make<A1>())))];
+            template <class G> static char (&test(...))[3];
+            enum { value = (sizeof(test<F>(0)) == sizeof(Yes)) };
+        };
+        template <class F, class A1> struct IsCallable<F,void (A1)> {
+            template <class G> static char (&test(int))
+                [sizeof(((*static_cast<G*>(0))(make<A1>()),make<Yes>()))];
+            template <class G> static char (&test(...))[3];
+            enum { value = (sizeof(test<F>(0)) == sizeof(Yes)) };
+        };
+        template <class F, class R, class A1, class A2> struct IsCallable<F,R (A1,A2)> {
+            template <class G> static char (&test(int))
+                [sizeof(Returns<R>::check((*static_cast<G*>(0))(make<A1>(),make<A2>())))];
+            template <class G> static char (&test(...))[3];
+            enum { value = (sizeof(test<F>(0)) == sizeof(Yes)) };
+        };
+        template <class F, class A1, class A2> struct IsCallable<F,void (A1,A2)> {
+            template <class G> static char (&test(int))
+                [sizeof(((*static_cast<G*>(0))(make<A1>(),make<A2>()),make<Yes>()))];
+            template <class G> static char (&test(...))[3];
+            enum { value = (sizeof(test<F>(0)) == sizeof(Yes)) };
+        };
+        // Defines type if an F can be referred to by the specified CallableRef class.
+        template <class F, class Signature, class Ref> struct EnableIfCallable
+        : boost::enable_if_c<IsCallable<F,Signature>::value &&
+            !boost::is_same<typename boost::remove_const<F>::type,Ref>::value> { };
+    } // callable
+
+    // Provides a lightweight non-owning reference to any callable object with the specified
+    // signature. A CallableRef never allocates or copies the object it refers to, and calls
+    // it via a single function pointer to a thunk that calls the object's own operator().
+    // Only objects that can be called with the signature's arguments, and whose result
+    // can be converted to its return type, are accepted. The referenced object must outlive
+    // the CallableRef, so these are intended for function arguments rather than for storage.
+    // Only one and two argument signatures are supported.
+    template <class Signature> class CallableRef;
+
+    template <class R, class A1> class CallableRef<R (A1)> {
+    public:
+        template <class F> CallableRef(F &f,
+            typename callable::EnableIfCallable<F,R (A1),CallableRef>::type* = 0)
+        : _object(const_cast<void*>(static_cast<void const*>(&f))), _thunk(&_call<F>) { }
+        CallableRef(R (*f)(A1))
+        : _object(reinterpret_cast<void*>(f)), _thunk(&_callFunction) { }
+        R operator()(A1 a1) const { return _thunk(_object,a1); }
+    private:
+        template <class F> static R _call(void *object, A1 a1) {
+            return (*static_cast<F*>(object))(a1);
+        }
+        static R _callFunction(void *object, A1 a1) {
+            return (*reinterpret_cast<R (*)(A1)>(object))(a1);
+        }
+        void *_object;
+        R (*_thunk)(void*,A1);
+    }; // CallableRef<R (A1)>
+
+    template <class R, class A1, class A2> class CallableRef<R (A1,A2)> {
+    public:
+        template <class F> CallableRef(F &f,
+            typename callable::EnableIfCallable<F,R (A1,A2),CallableRef>::type* = 0)
+        : _object(const_cast<void*>(static_cast<void const*>(&f))), _thunk(&_call<F>) { }
+        CallableRef(R (*f)(A1,A2))
+        : _object(reinterpret_cast<void*>(f)), _thunk(&_callFunction) { }
+        R operator()(A1 a1, A2 a2) const { return _thunk(_object,a1,a2); }
+    private:
+        template <class F> static R _call(void *object, A1 a1, A2 a2) {
+            return (*static_cast<F*>(object))(a1,a2);
+        }
+        static R _callFunction(void *object, A1 a1, A2 a2) {
+            return (*reinterpret_cast<R (*)(A1,A2)>(object))(a1,a2);
+        }
+        void *_object;
+        R (*_thunk)(void*,A1,A2);
+    }; // CallableRef<R (A1,A2)>
+
+    // Declares a non-owning reference to any callable object that can be used as a
+    // GenericFunction.
+    typedef CallableRef<double (double)> GenericFunctionRef;
+
 } // likely
 
 #endif // LIKELY_FUNCTION
@@ -2,9 +2,20 @@
 
 #include "likely/function.h"
 
-#include "boost/bind.hpp"
+namespace likely {
+namespace function {
+    // Calls a shared implementation object directly, so that its operator() can be
+    // inlined into the GenericFunction invoker.
+    template <class P> class SharedCaller {
+    public:
+        SharedCaller(boost::shared_ptr<P> pimpl) : _pimpl(pimpl) { }
+        double operator()(double x) const { return (*_pimpl)(x); }
+    private:
+        boost::shared_ptr<P> _pimpl;
+    }; // SharedCaller
+}} // likely::function
 
 template <class P> likely::GenericFunctionPtr likely::createFunctionPtr(boost::shared_ptr<P> pimpl) {
-    GenericFunctionPtr fptr(new GenericFunction(boost::bind(&P::operator(),pimpl,_1)));
+    GenericFunctionPtr fptr(new GenericFunction(function::SharedCaller<P>(pimpl)));
     return fptr;
 }
@@ -4,6 +4,8 @@
 #include "likely/function.h"
 
 #include "likely/RuntimeError.h"
+#include "likely/ThreadPool.h"
+#include "likely/TextWriter.h"
 
 #include "likely/Random.h"
 #include "likely/Integrator.h"
@@ -25,18 +27,31 @@
 #include "likely/UniformSampling.h"
 #include "likely/NonUniformSampling.h"
 
+#include "likely/AlignedAllocator.h"
 #include "likely/CovarianceMatrix.h"
+#include "likely/PackedKernels.h"
+#include "likely/TiledCholesky.h"
+#include "likely/OutOfCoreCovariance.h"
+#include "likely/ConjugateGradientCovariance.h"
 #include "likely/BinnedGrid.h"
 #include "likely/BinnedData.h"
 #include "likely/BinnedDataResampler.h"
+#include "likely/IncrementalChiSquare.h"
 
 #include "likely/FitParameter.h"
 #include "likely/FitModel.h"
+#include "likely/DualNumber.h"
 #include "likely/FitParameterStatistics.h"
 #include "likely/AbsEngine.h"
 #include "likely/FunctionMinimum.h"
+#include "likely/LikelihoodSurrogate.h"
+#include "likely/ChainReweighter.h"
+#include "likely/ProcessFarm.h"
+#include "likely/FisherMatrix.h"
 
 #include "likely/MarkovChainEngine.h"
+#include "likely/NestedSamplingEngine.h"
+#include "likely/LbfgsbEngine.h"
 // The following "engine" class are not included here since their availability
 // depends on how the package was built. Note that including them will indirectly
 // pull in some GSL and Minuit headers and so requires an appropriate include path.
@@ -5,6 +5,7 @@
 
 #include "boost/function.hpp"
 #include "boost/smart_ptr.hpp"
+#include "boost/cstdint.hpp"
 
 #include <vector>
 
@@ -16,6 +17,9 @@ namespace likely {
     // Represents a gradient vector of function partial derivatives.
     typedef std::vector<double> Gradient;
 
+    // Represents a 64-bit index into a binned grid or a packed symmetric matrix.
+    typedef boost::int64_t Index;
+
     // Represents a smart pointer to a random number generator.
     class Random;
     typedef boost::shared_ptr<Random> RandomPtr;
@@ -29,6 +33,11 @@ namespace likely {
     typedef boost::shared_ptr<CovarianceMatrix> CovarianceMatrixPtr;
     typedef boost::shared_ptr<const CovarianceMatrix> CovarianceMatrixCPtr;
     
+    // Declares a smart pointer to a (const) conjugate-gradient covariance.
+    class ConjugateGradientCovariance;
+    typedef boost::shared_ptr<ConjugateGradientCovariance> ConjugateGradientCovariancePtr;
+    typedef boost::shared_ptr<const ConjugateGradientCovariance> ConjugateGradientCovarianceCPtr;
+    
     // Declares a smart pointer to a (const) covariance matrix accumulator.
     class CovarianceAccumulator;
     typedef boost::shared_ptr<CovarianceAccumulator> CovarianceAccumulatorPtr;
@@ -56,6 +65,15 @@ namespace likely {
     // Declares a smart pointer to a gradient calculator.
     typedef boost::shared_ptr<GradientCalculator> GradientCalculatorPtr;
 
+    // Encapsulates a fused evaluation of a minimization objective function and its gradient
+    // at the same point, for models that calculate both from shared intermediate results.
+    // Returns the function value and fills gValues, which has one element per parameter.
+    typedef boost::function<double (Parameters const &pValues, Gradient &gValues)>
+        FunctionAndGradient;
+
+    // Declares a smart pointer to a fused function and gradient evaluator.
+    typedef boost::shared_ptr<FunctionAndGradient> FunctionAndGradientPtr;
+
     // Represents a smart pointer to a function minimum object.
     class FunctionMinimum;
     typedef boost::shared_ptr<FunctionMinimum> FunctionMinimumPtr;
@@ -64,11 +82,27 @@ namespace likely {
     // Represents a smart pointer to an interpolator object.
     class Interpolator;
     typedef boost::shared_ptr<Interpolator> InterpolatorPtr;
+
+    // Represents a smart pointer to a const table of interpolation control points.
+    class InterpolatorTable;
+    typedef boost::shared_ptr<const InterpolatorTable> InterpolatorTableCPtr;
     
     // Represents a smart pointer to a weighted accumulator object.
     class AbsAccumulator;
     typedef boost::shared_ptr<AbsAccumulator> AbsAccumulatorPtr;
     
+    // Represents a smart pointer to a likelihood surrogate object.
+    class LikelihoodSurrogate;
+    typedef boost::shared_ptr<LikelihoodSurrogate> LikelihoodSurrogatePtr;
+
+    // Represents a smart pointer to a chain reweighter object.
+    class ChainReweighter;
+    typedef boost::shared_ptr<ChainReweighter> ChainReweighterPtr;
+
+    // Represents a smart pointer to a thread pool object.
+    class ThreadPool;
+    typedef boost::shared_ptr<ThreadPool> ThreadPoolPtr;
+
     // Represents a smart pointer to a fit parameter statistics object.
     class FitParameterStatistics;
     typedef boost::shared_ptr<FitParameterStatistics> FitParameterStatisticsPtr;
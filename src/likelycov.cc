@@ -56,7 +56,7 @@ int main(int argc, char **argv) {
         lk::matrixSquare(eigenvectors,rsquare,true,size);
         for(int col = 0; col < size; ++col) {
             for(int row = 0; row <= col; ++row) {
-                int index = lk::symmetricMatrixIndex(row,col,size);
+                lk::Index index = lk::symmetricMatrixIndex(row,col,size);
                 std::cout << index << ' ' << row << ' ' << col << ' '
                     << cov->getCovariance(row,col) << ' '
                     << lsquare[index] << ' ' << rsquare[index] << std::endl;
@@ -33,12 +33,13 @@ int main(int argc, char **argv) {
 
     lk::BinnedGrid grid(axis1,axis2,axis3);
     lk::BinnedData data(grid);
-    int nAxes(grid.getNAxes()), nBins(grid.getNBinsTotal());
+    int nAxes(grid.getNAxes());
+    lk::Index nBins(grid.getNBinsTotal());
     std::cout << "naxes = " << nAxes << ", nbins = " << nBins << std::endl;
     std::vector<int> idx(nAxes);
     std::vector<double> centers(nAxes), widths(nAxes);
     for(lk::BinnedGrid::Iterator iter = grid.begin(); iter != grid.end(); ++iter) {
-        int index = *iter;
+        lk::Index index = *iter;
         std::cout << "[" << index << "] =>";
         grid.getBinIndices(index,idx);
         assert(grid.getIndex(idx) == index);
@@ -0,0 +1,79 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// Benchmarks the deterministic and fast modes of ThreadPool::parallelSum.
+
+#include "likely/ThreadPool.h"
+
+#include "boost/format.hpp"
+#include "boost/bind.hpp"
+#include "boost/lexical_cast.hpp"
+
+#include <sys/time.h>
+#include <cmath>
+#include <vector>
+#include <iostream>
+
+namespace lk = likely;
+
+// Returns the number of elapsed microseconds from before to after.
+double elapsed(struct timeval const &before, struct timeval const &after) {
+    return (after.tv_sec - before.tv_sec)*1e6 + (after.tv_usec - before.tv_usec);
+}
+
+// Returns the sum of a range of values.
+double sumRange(std::vector<double> const &values, int first, int last) {
+    double sum(0);
+    for(int index = first; index < last; ++index) sum += values[index];
+    return sum;
+}
+
+// Returns the sum of an expensive function of a range of values.
+double sumExpensive(std::vector<double> const &values, int first, int last) {
+    double sum(0);
+    for(int index = first; index < last; ++index) sum += std::exp(std::sin(values[index]));
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    int size(1<<24), repeat(10), maxThreads(argc > 1 ? boost::lexical_cast<int>(argv[1]) : 8);
+    std::vector<double> values(size);
+    for(int index = 0; index < size; ++index) values[index] = std::sin(index)*std::pow(10.,index % 17);
+    std::cout << "Summing " << size << " values with up to " << maxThreads << " threads." << std::endl;
+
+    struct timeval before,after;
+    boost::format results("%7s %8d %2d threads: %8.3f ms/sum  %.17g\n");
+    gettimeofday(&before,0);
+    double serial(0);
+    for(int trial = 0; trial < repeat; ++trial) serial = sumRange(values,0,size);
+    gettimeofday(&after,0);
+    std::cout << results % "serial" % "-" % 1 % (1e-3*elapsed(before,after)/repeat) % serial;
+
+    char const *names[2] = { "fast", "exact" };
+    lk::ThreadPool::RangeSum bodies[2] = {
+        boost::bind(sumRange,boost::cref(values),_1,_2),
+        boost::bind(sumExpensive,boost::cref(values),_1,_2)
+    };
+    for(int body = 0; body < 2; ++body) {
+        std::cout << (body ? "Expensive terms:" : "Cheap terms:") << std::endl;
+        for(int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+            lk::ThreadPool pool(nThreads);
+            for(int mode = 0; mode < 2; ++mode) {
+                pool.setDeterministic(1 == mode);
+                // Compare the default deterministic chunk size with a larger one.
+                int chunkSizes[2] = { 0, 4096 };
+                for(int k = 0; k < (mode ? 2 : 1); ++k) {
+                    double sum(0);
+                    gettimeofday(&before,0);
+                    for(int trial = 0; trial < repeat; ++trial) {
+                        sum = pool.parallelSum(0,size,bodies[body],chunkSizes[k]);
+                    }
+                    gettimeofday(&after,0);
+                    int chunkSize(chunkSizes[k] ? chunkSizes[k] :
+                        (mode ? 256 : (size + 4*nThreads - 1)/(4*nThreads)));
+                    std::cout << results % names[mode] % chunkSize % nThreads
+                        % (1e-3*elapsed(before,after)/repeat) % sum;
+                }
+            }
+        }
+    }
+    return 0;
+}
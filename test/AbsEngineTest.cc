@@ -0,0 +1,147 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// AbsEngine findMinimum unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+#include "likely/EngineRegistry.h"
+namespace lk = likely;
+
+#include "boost/functional/factory.hpp"
+#include "boost/bind.hpp"
+#include "boost/type_traits/is_convertible.hpp"
+
+namespace {
+    // Counts the calls to our function and fused evaluator.
+    int nFunction(0), nFused(0);
+    double parabola(lk::Parameters const &p) {
+        nFunction++;
+        return (p[0] - 1)*(p[0] - 1) + 2*p[1]*p[1];
+    }
+    double parabolaAndGradient(lk::Parameters const &p, lk::Gradient &g) {
+        nFused++;
+        g.resize(2);
+        g[0] = 2*(p[0] - 1);
+        g[1] = 4*p[1];
+        return (p[0] - 1)*(p[0] - 1) + 2*p[1]*p[1];
+    }
+    // An engine that records what findMinimum gives it and evaluates one gradient with
+    // its gradient calculator.
+    class RecordingEngine : public lk::AbsEngine {
+    public:
+        RecordingEngine(lk::FunctionPtr /*f*/, lk::GradientCalculatorPtr gc,
+        lk::FitParameters const &/*parameters*/, std::string const &/*algorithm*/) : _gc(gc) {
+            minimumFinder = boost::bind(&RecordingEngine::minimize,this,_1,_2,_3);
+        }
+        void minimize(lk::FunctionMinimumPtr fmin, double /*prec*/, long /*maxEvals*/) {
+            hadFused = (0 != functionAndGradient.get());
+            hadCalculator = (0 != _gc.get());
+            gradient.clear();
+            if(_gc) (*_gc)(fmin->getParameters(),gradient);
+        }
+        static bool hadFused, hadCalculator;
+        static lk::Gradient gradient;
+    private:
+        lk::GradientCalculatorPtr _gc;
+    };
+    bool RecordingEngine::hadFused = false, RecordingEngine::hadCalculator = false;
+    lk::Gradient RecordingEngine::gradient;
+    // Non-owning references to callables with the Function and GradientCalculator signatures.
+    typedef lk::CallableRef<double (lk::Parameters const &)> FunctionRef;
+    typedef lk::CallableRef<void (lk::Parameters const &, lk::Gradient &)> GradientCalculatorRef;
+    // A callable object that counts its own calls, so that tests can tell whether it
+    // was copied.
+    struct CountingParabola {
+        CountingParabola() : nCalls(0) { }
+        double operator()(lk::Parameters const &p) { nCalls++; return parabola(p); }
+        int nCalls;
+    };
+    // A const callable object.
+    struct ConstParabola {
+        double operator()(lk::Parameters const &p) const { return parabola(p); }
+    };
+    // A callable gradient calculator.
+    struct ParabolaGradient {
+        void operator()(lk::Parameters const &p, lk::Gradient &g) const { parabolaAndGradient(p,g); }
+    };
+    // A callable object with the wrong argument type.
+    struct WrongArgument {
+        double operator()(std::string const &name) const { return name.size(); }
+    };
+    void registerRecordingEngine() {
+        lk::getEngineRegistry()["recording"] =
+            boost::bind(boost::factory<RecordingEngine*>(),_1,_2,_3,_4);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( AbsEngine )
+
+BOOST_AUTO_TEST_CASE( shouldAdaptFusedEvaluatorToGradientCalculator ) {
+    registerRecordingEngine();
+    lk::FunctionPtr f(new lk::Function(parabola));
+    lk::FunctionAndGradientPtr fg(new lk::FunctionAndGradient(parabolaAndGradient));
+    lk::FitParameters params;
+    params.push_back(lk::FitParameter("x",3,1));
+    params.push_back(lk::FitParameter("y",-1,1));
+    nFused = 0;
+    lk::findMinimum(f,lk::GradientCalculatorPtr(),fg,params,"recording::any");
+    BOOST_CHECK(RecordingEngine::hadFused);
+    BOOST_CHECK(RecordingEngine::hadCalculator);
+    BOOST_CHECK_EQUAL(nFused, 1);
+    BOOST_REQUIRE_EQUAL(RecordingEngine::gradient.size(), 2);
+    BOOST_CHECK_EQUAL(RecordingEngine::gradient[0], 4);
+    BOOST_CHECK_EQUAL(RecordingEngine::gradient[1], -4);
+    // Without a fused evaluator, engines should see neither.
+    lk::findMinimum(f,params,"recording::any");
+    BOOST_CHECK(!RecordingEngine::hadFused);
+    BOOST_CHECK(!RecordingEngine::hadCalculator);
+}
+
+BOOST_AUTO_TEST_CASE( shouldMinimizeWithFusedEvaluator ) {
+    lk::FunctionPtr f(new lk::Function(parabola));
+    lk::FunctionAndGradientPtr fg(new lk::FunctionAndGradient(parabolaAndGradient));
+    lk::FitParameters params;
+    params.push_back(lk::FitParameter("x",3,1));
+    params.push_back(lk::FitParameter("y",-1,1));
+    nFunction = nFused = 0;
+    lk::FunctionMinimumPtr fmin(lk::findMinimum(f,lk::GradientCalculatorPtr(),fg,params,
+        "lbfgsb::m5",1e-8));
+    BOOST_CHECK_SMALL(fmin->getParameters()[0] - 1, 1e-4);
+    BOOST_CHECK_SMALL(fmin->getParameters()[1], 1e-4);
+    // The function is only used for the initial value, and gradients are all fused.
+    BOOST_CHECK_EQUAL(nFunction, 1);
+    BOOST_CHECK(nFused > 0);
+    BOOST_CHECK_EQUAL(fmin->getNGradCount(), nFused);
+}
+
+BOOST_AUTO_TEST_CASE( shouldReferToCallablesWithoutCopying ) {
+    // Only objects with a compatible signature should convert to a CallableRef.
+    BOOST_CHECK((boost::is_convertible<CountingParabola&,FunctionRef>::value));
+    BOOST_CHECK((boost::is_convertible<ConstParabola const&,FunctionRef>::value));
+    BOOST_CHECK((boost::is_convertible<ParabolaGradient&,GradientCalculatorRef>::value));
+    BOOST_CHECK((!boost::is_convertible<ParabolaGradient&,FunctionRef>::value));
+    BOOST_CHECK((!boost::is_convertible<WrongArgument&,FunctionRef>::value));
+    BOOST_CHECK((!boost::is_convertible<int&,FunctionRef>::value));
+    BOOST_CHECK((!boost::is_convertible<lk::FunctionPtr&,FunctionRef>::value));
+    lk::Parameters p(2);
+    p[0] = 3; p[1] = 1;
+    CountingParabola counting;
+    FunctionRef ref(counting), copy(ref);
+    BOOST_CHECK_EQUAL(ref(p), 6);
+    BOOST_CHECK_EQUAL(copy(p), 6);
+    BOOST_CHECK_EQUAL(counting.nCalls, 2);
+    ConstParabola const constant = ConstParabola();
+    BOOST_CHECK_EQUAL(FunctionRef(constant)(p), 6);
+    BOOST_CHECK_EQUAL(FunctionRef(parabola)(p), 6);
+    BOOST_CHECK_EQUAL(FunctionRef(&parabola)(p), 6);
+    lk::Gradient g;
+    ParabolaGradient gradient;
+    GradientCalculatorRef gradientRef(gradient);
+    gradientRef(p,g);
+    BOOST_REQUIRE_EQUAL(g.size(), 2);
+    BOOST_CHECK_EQUAL(g[0], 4);
+    BOOST_CHECK_EQUAL(g[1], 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // AbsEngine
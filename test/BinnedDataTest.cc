@@ -5,6 +5,14 @@
 #include <boost/test/unit_test.hpp>
 
 #include "likely/likely.h"
+
+#include "boost/lexical_cast.hpp"
+
+#include <cmath>
+#include <limits>
+#include <set>
+#include <sstream>
+
 namespace lk = likely;
 
 struct BinnedDataFixture
@@ -30,6 +38,190 @@ BOOST_AUTO_TEST_CASE( shouldThrowBinningErrorInConstructorWithInvalidParameters
 	BOOST_CHECK_EQUAL(1, 1);
 }
 
+BOOST_AUTO_TEST_CASE( shouldIndexGridWithMoreThan32BitBins ) {
+	lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,2000));
+	lk::BinnedGrid grid(axis,axis,axis);
+	BOOST_CHECK_EQUAL(grid.getNBinsTotal(), 8000000000L);
+	std::vector<int> binIndices(3,1999);
+	lk::Index index(grid.getIndex(binIndices));
+	BOOST_CHECK_EQUAL(index, 7999999999L);
+	std::vector<int> roundTrip;
+	grid.getBinIndices(index,roundTrip);
+	BOOST_CHECK_EQUAL_COLLECTIONS(roundTrip.begin(),roundTrip.end(),binIndices.begin(),binIndices.end());
+}
+
+BOOST_AUTO_TEST_CASE( shouldPruneWithIntOrLongIndices ) {
+	lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,5));
+	lk::BinnedData data((lk::BinnedGrid(axis)));
+	for(int k = 0; k < 5; ++k) data.setData(k,10*k);
+	for(int k = 0; k < 5; ++k) data.setCovariance(k,k,1+k);
+	lk::BinnedData copy(data);
+	std::set<int> keepInt;
+	keepInt.insert(3);
+	keepInt.insert(1);
+	data.prune(keepInt);
+	std::set<lk::Index> keepIndex(keepInt.begin(),keepInt.end());
+	copy.prune(keepIndex);
+	BOOST_REQUIRE_EQUAL(data.getNBinsWithData(), 2);
+	BOOST_REQUIRE_EQUAL(copy.getNBinsWithData(), 2);
+	for(int offset = 0; offset < 2; ++offset) {
+		lk::Index index(data.getIndexAtOffset(offset));
+		BOOST_CHECK_EQUAL(index, copy.getIndexAtOffset(offset));
+		BOOST_CHECK_EQUAL(data.getData(index), copy.getData(index));
+		BOOST_CHECK_EQUAL(data.getCovariance(index,index), 1+index);
+	}
+	keepInt.insert(7);
+	BOOST_CHECK_THROW(data.prune(keepInt), lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( shouldUseCovarianceOperator ) {
+	int n(20);
+	lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,n));
+	lk::BinnedDataPtr
+		dense(new lk::BinnedData(lk::BinnedGrid(axis))),
+		sparse(new lk::BinnedData(lk::BinnedGrid(axis)));
+	lk::ConjugateGradientCovariancePtr covariance(new lk::ConjugateGradientCovariance(n-1,false));
+	std::vector<double> pred(n);
+	for(int k = 0; k < n; ++k) {
+		// Leave the last bin empty.
+		if(k < n-1) {
+			dense->setData(k,std::sin(k));
+			sparse->setData(k,std::sin(k));
+		}
+		pred[k] = std::cos(k);
+	}
+	for(int k = 0; k < n-1; ++k) {
+		dense->setCovariance(k,k,1.5+std::sin(k));
+		covariance->setElement(k,k,1.5+std::sin(k));
+		if(k > 0) {
+			dense->setCovariance(k-1,k,0.3);
+			covariance->setElement(k-1,k,0.3);
+		}
+	}
+	pred.pop_back();
+	sparse->setCovarianceOperator(covariance);
+	BOOST_CHECK(sparse->hasCovarianceOperator());
+	BOOST_CHECK(!sparse->hasCovariance());
+	// Data with and without a covariance operator are not congruent.
+	BOOST_CHECK(!dense->isCongruent(*sparse));
+	BOOST_CHECK(!sparse->isCongruent(*dense));
+	BOOST_CHECK_THROW(sparse->setData(n-1,1), lk::RuntimeError);
+	// The operator and dense matrix have the same chi-square.
+	BOOST_CHECK_CLOSE(sparse->chiSquare(pred), dense->chiSquare(pred), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( shouldUpdateChiSquareIncrementally ) {
+	int n(20);
+	lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,n));
+	lk::BinnedDataPtr data(new lk::BinnedData(lk::BinnedGrid(axis)));
+	std::vector<double> pred(n);
+	for(int k = 0; k < n; ++k) {
+		data->setData(k,std::sin(k));
+		pred[k] = std::cos(k);
+	}
+	data->setCovarianceMatrix(lk::generateRandomCovariance(n));
+	lk::IncrementalChiSquare incremental(data);
+	BOOST_CHECK_CLOSE(incremental.reset(pred), data->chiSquare(pred), 1e-8);
+	std::vector<int> changed(2);
+	changed[0] = 3; changed[1] = 11;
+	pred[3] += 0.5;
+	pred[11] -= 0.25;
+	BOOST_CHECK_CLOSE(incremental.update(pred,changed), data->chiSquare(pred), 1e-8);
+	pred[7] *= 2;
+	BOOST_CHECK_CLOSE(incremental.update(pred), data->chiSquare(pred), 1e-8);
+	// An invalid offset should leave the previous prediction unchanged.
+	std::vector<double> previous(pred);
+	pred[5] += 1;
+	changed[0] = 5; changed[1] = n;
+	BOOST_CHECK_THROW(incremental.update(pred,changed), lk::RuntimeError);
+	BOOST_CHECK_CLOSE(incremental.update(previous), data->chiSquare(previous), 1e-8);
+	// Repeated offsets should only be counted once.
+	changed[1] = 5;
+	BOOST_CHECK_CLOSE(incremental.update(pred,changed), data->chiSquare(pred), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( shouldCalculateChiSquareGradient ) {
+	// Use a linear model pred = J.theta for 2 parameters, whose chi-square is quadratic,
+	// so that central differences are exact up to rounding.
+	int n(30), npar(2);
+	lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,n));
+	lk::BinnedData data((lk::BinnedGrid(axis)));
+	std::vector<double> jacobian(n*npar);
+	for(int k = 0; k < n; ++k) {
+		data.setData(k,std::sin(k));
+		jacobian[k] = 1;
+		jacobian[n+k] = std::cos(k);
+	}
+	data.setCovarianceMatrix(lk::generateRandomCovariance(n,2));
+	double theta[2] = { 0.3, -0.2 }, step(1e-3);
+	std::vector<double> pred(n), icovResidual, gradient(npar+1,0);
+	for(int k = 0; k < n; ++k) pred[k] = theta[0]*jacobian[k] + theta[1]*jacobian[n+k];
+	BOOST_CHECK_CLOSE(data.chiSquare(pred,icovResidual), data.chiSquare(pred), 1e-8);
+	lk::addChiSquareGradient(icovResidual,jacobian,gradient,1);
+	BOOST_CHECK_EQUAL(gradient[0], 0);
+	for(int par = 0; par < npar; ++par) {
+		std::vector<double> up(pred),down(pred);
+		for(int k = 0; k < n; ++k) {
+			up[k] += step*jacobian[par*n+k];
+			down[k] -= step*jacobian[par*n+k];
+		}
+		double numeric((data.chiSquare(up) - data.chiSquare(down))/(2*step));
+		BOOST_CHECK_CLOSE(gradient[par+1], numeric, 1e-6);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( shouldSaveInverseCovarianceWithFullPrecision ) {
+	double special[5] = { -0., 1e-310, 1./3, std::numeric_limits<double>::infinity(), -1e300 };
+	char buffer[lk::maxFormattedDoubleSize];
+	for(int k = 0; k < 5; ++k) {
+		std::string formatted(buffer,lk::formatDouble(special[k],buffer));
+		BOOST_CHECK_EQUAL(formatted, boost::lexical_cast<std::string>(special[k]));
+	}
+	int n(40);
+	lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,n));
+	lk::BinnedData data((lk::BinnedGrid(axis)));
+	for(int k = 0; k < n; ++k) data.setData(k,std::sin(k));
+	data.setCovarianceMatrix(lk::generateRandomCovariance(n));
+	std::ostringstream expected;
+	for(int k1 = 0; k1 < n; ++k1) {
+		for(int k2 = k1; k2 < n; ++k2) {
+			double value(2*data.getInverseCovariance(k1,k2));
+			if(k2 > k1 && 0 == value) continue;
+			expected << k1 << ' ' << k2 << ' ' << boost::lexical_cast<std::string>(value) << std::endl;
+		}
+	}
+	std::ostringstream serial,parallel;
+	data.saveInverseCovariance(serial,2);
+	BOOST_CHECK(serial.str() == expected.str());
+	lk::ThreadPoolPtr pool(new lk::ThreadPool(3));
+	data.saveInverseCovariance(parallel,2,pool);
+	BOOST_CHECK(parallel.str() == expected.str());
+	// Bins added out of order, with a block diagonal covariance, should be saved in the
+	// order they were added, skipping zero off-diagonal elements.
+	lk::BinnedData sparse((lk::BinnedGrid(axis)));
+	for(int k = n-1; k >= 0; k -= 3) sparse.setData(k,k);
+	int nBins(sparse.getNBinsWithData());
+	for(int offset = 0; offset < nBins; ++offset) {
+		lk::Index index(sparse.getIndexAtOffset(offset));
+		sparse.setCovariance(index,index,1+offset);
+		if(offset % 2) sparse.setCovariance(sparse.getIndexAtOffset(offset-1),index,0.5);
+	}
+	std::ostringstream sparseExpected,sparseSerial,sparseParallel;
+	for(int offset1 = 0; offset1 < nBins; ++offset1) {
+		lk::Index index1(sparse.getIndexAtOffset(offset1));
+		for(int offset2 = offset1; offset2 < nBins; ++offset2) {
+			lk::Index index2(sparse.getIndexAtOffset(offset2));
+			double value(sparse.getInverseCovariance(index1,index2));
+			if(offset2 > offset1 && 0 == value) continue;
+			sparseExpected << index1 << ' ' << index2 << ' ' << boost::lexical_cast<std::string>(value) << std::endl;
+		}
+	}
+	sparse.saveInverseCovariance(sparseSerial,1);
+	BOOST_CHECK(sparseSerial.str() == sparseExpected.str());
+	sparse.saveInverseCovariance(sparseParallel,1,pool);
+	BOOST_CHECK(sparseParallel.str() == sparseExpected.str());
+}
+
 // clone, =, swap
 // +=, add
 // isCongruent
@@ -0,0 +1,97 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// ChainReweighter class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include <cmath>
+#include <sstream>
+
+namespace {
+    // The -log(likelihood) of a unit Gaussian centered at 1 with an offset for x = p[0].
+    double shiftedNLL(lk::Parameters const &p) {
+        double dx(p[0] - 100 - 1);
+        return 0.5*dx*dx;
+    }
+    // The change in -log(likelihood) from a unit Gaussian centered at 0 to shiftedNLL.
+    double shiftNLL(lk::Parameters const &p) {
+        return 0.5 - (p[0] - 100);
+    }
+    // Adds samples x = 100 + [-8,8] with weights proportional to a unit Gaussian centered
+    // at 100, and a fixed second parameter.
+    void addGaussianSamples(lk::ChainReweighter &reweighter) {
+        lk::Parameters values(2,-3);
+        for(int k = -800; k <= 800; ++k) {
+            double x(0.01*k);
+            values[0] = 100 + x;
+            reweighter.addSample(values,0.5*x*x,std::exp(-0.5*x*x));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( ChainReweighter )
+
+BOOST_AUTO_TEST_CASE( shouldReweightSamples ) {
+    lk::FitParameters parameters;
+    parameters.push_back(lk::FitParameter("x",100,1));
+    parameters.push_back(lk::FitParameter("y",-3,0));
+    lk::ChainReweighter reweighter(parameters);
+    addGaussianSamples(reweighter);
+    BOOST_CHECK_EQUAL(reweighter.getNSamples(), 1601);
+    lk::WeightedAccumulator before;
+    reweighter.accumulate(0,before);
+    BOOST_CHECK_CLOSE(before.mean(), 100, 1e-8);
+    BOOST_CHECK_CLOSE(before.variance(), 1, 1e-4);
+    BOOST_CHECK_THROW(reweighter.accumulate(1,before), lk::RuntimeError);
+    // Reweighting with the new likelihood or its change should shift the mean by one.
+    lk::FunctionPtr newNLL(new lk::Function(shiftedNLL)), deltaNLL(new lk::Function(shiftNLL));
+    double ess(reweighter.reweight(newNLL,lk::ThreadPoolPtr(new lk::ThreadPool(3))));
+    BOOST_CHECK_CLOSE(ess, reweighter.getEffectiveSampleSize(), 1e-12);
+    BOOST_CHECK_EQUAL(reweighter.getWeight(900), 1);
+    lk::WeightedAccumulator after, change;
+    reweighter.accumulate(0,after);
+    BOOST_CHECK_CLOSE(after.mean(), 101, 1e-6);
+    BOOST_CHECK_CLOSE(after.variance(), 1, 1e-3);
+    reweighter.reweightByChange(deltaNLL);
+    reweighter.accumulate(0,change);
+    BOOST_CHECK_CLOSE(change.mean(), 101, 1e-6);
+    // Restoring the original weights should undo the reweighting.
+    reweighter.resetWeights();
+    lk::WeightedAccumulator reset;
+    reweighter.accumulate(0,reset);
+    BOOST_CHECK_CLOSE(reset.mean(), 100, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( shouldAccumulateFloatingValues ) {
+    lk::FitParameters parameters;
+    parameters.push_back(lk::FitParameter("y",-3,0));
+    parameters.push_back(lk::FitParameter("x",100,1));
+    lk::ChainReweighter reweighter(parameters);
+    // Samples from a chain callback use their current values with unit weight.
+    lk::Parameters current(2,-3), trial(2,-3);
+    for(int k = 0; k < 4; ++k) {
+        current[1] = 10*k;
+        trial[1] = 1000;
+        reweighter.addTrial(current,trial,k,1000,false);
+    }
+    BOOST_CHECK_EQUAL(reweighter.getNSamples(), 4);
+    BOOST_CHECK_EQUAL(reweighter.getEffectiveSampleSize(), 4);
+    // The accumulated mean and variance should use the raw values.
+    lk::CovarianceAccumulator accumulator(1);
+    reweighter.accumulate(accumulator);
+    BOOST_CHECK_EQUAL(accumulator.count(), 4);
+    std::ostringstream os;
+    accumulator.dump(os);
+    std::istringstream is(os.str());
+    int size, count, col, row;
+    double sumWeights, mean, variance;
+    is >> size >> count >> sumWeights >> col >> mean >> row >> col >> variance;
+    BOOST_CHECK_CLOSE(mean, 15, 1e-10);
+    BOOST_CHECK_CLOSE(variance, 125, 1e-10);
+    BOOST_CHECK_THROW(lk::ChainReweighter(lk::FitParameters(1,parameters[0])), lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // ChainReweighter
@@ -5,8 +5,22 @@
 #include <boost/test/unit_test.hpp>
 
 #include "likely/likely.h"
+
+#include "boost/bind.hpp"
+
+#include <cstdio>
+#include <cmath>
+
 namespace lk = likely;
 
+// Calculates result = C.vector or Cinv.vector using a dense covariance matrix.
+void denseMultiply(lk::CovarianceMatrix const &cov, bool inverse,
+std::vector<double> const &vector, std::vector<double> &result) {
+    result = vector;
+    if(inverse) cov.multiplyByInverseCovariance(result);
+    else cov.multiplyByCovariance(result);
+}
+
 struct CovarianceMatrixFixture
 {
     CovarianceMatrixFixture() {
@@ -54,10 +68,13 @@ BOOST_AUTO_TEST_CASE( shouldThrowErrorSettingInvalidMatrixElement ) {
 BOOST_AUTO_TEST_CASE( shouldConvertMatrixIndexToPackedArrayIndex ) {
 	BOOST_CHECK_EQUAL(lk::symmetricMatrixIndex(1,2,3), 4);
 	BOOST_CHECK_EQUAL(lk::symmetricMatrixIndex(2,1,3), 4);
+	BOOST_CHECK_EQUAL(lk::symmetricMatrixIndex(70000,70000,70001), 2450105000UL);
 }
 
 BOOST_AUTO_TEST_CASE( shouldCalculateSizeOfMatrixFromNumberOfElements ) {
 	BOOST_CHECK_EQUAL(lk::symmetricMatrixSize(15), 5);
+	BOOST_CHECK_EQUAL(lk::symmetricMatrixSize(2450105001UL), 70001);
+	BOOST_CHECK_EQUAL(lk::symmetricMatrixElements(70001), 2450105001UL);
 }
 
 BOOST_AUTO_TEST_CASE( shouldMultiplyVectorByCovaraianceMatrix ) {
@@ -70,4 +87,303 @@ BOOST_AUTO_TEST_CASE( shouldMultiplyVectorByCovaraianceMatrix ) {
 	
 }
 
+BOOST_AUTO_TEST_CASE( shouldCalculateChiSquareWithThreshold ) {
+	std::vector<double> delta(size);
+	delta[0] = 1; delta[1] = -2; delta[2] = 3;
+	double chi2 = cov->chiSquare(delta);
+	BOOST_CHECK_CLOSE(cov->chiSquareWithThreshold(delta,chi2+1), chi2, 1e-8);
+	BOOST_CHECK(cov->chiSquareWithThreshold(delta,0.5*chi2) > 0.5*chi2);
+}
+
+BOOST_AUTO_TEST_CASE( shouldProjectInverse ) {
+	std::vector<double> matrix(2*size), result;
+	matrix[0] = 1; matrix[1] = -2; matrix[2] = 3;
+	matrix[3] = 0.5; matrix[4] = 1; matrix[5] = -1;
+	cov->projectInverse(matrix,2,result);
+	BOOST_REQUIRE_EQUAL(result.size(),4);
+	std::vector<double> col0(matrix.begin(),matrix.begin()+size), col1(matrix.begin()+size,matrix.end());
+	cov->multiplyByInverseCovariance(col1);
+	double cross(0);
+	for(int k = 0; k < size; ++k) cross += col0[k]*col1[k];
+	BOOST_CHECK_CLOSE(result[0], cov->chiSquare(col0), 1e-8);
+	BOOST_CHECK_CLOSE(result[1], cross, 1e-8);
+	BOOST_CHECK_CLOSE(result[2], cross, 1e-8);
+}
+
+// Replaces a packed matrix with its inverse using the tiled routines and no explicit pool.
+void tiledInverse(std::vector<double> *matrix, int n) {
+	lk::tiledCholeskyDecompose(*matrix,n,lk::ThreadPoolPtr(),16);
+	lk::tiledInvertCholesky(*matrix,n,lk::ThreadPoolPtr(),16);
+}
+
+BOOST_AUTO_TEST_CASE( shouldMatchTiledCholesky ) {
+	int n(50);
+	lk::CovarianceMatrixPtr random = lk::generateRandomCovariance(n);
+	std::vector<double> packed;
+	for(int col = 0; col < n; ++col) {
+		for(int row = 0; row <= col; ++row) packed.push_back(random->getCovariance(row,col));
+	}
+	std::vector<double> tiled(packed), nested(packed);
+	lk::ThreadPoolPtr pool(new lk::ThreadPool(3));
+	double logdet = lk::choleskyDecompose(packed,n);
+	BOOST_CHECK_SMALL(lk::tiledCholeskyDecompose(tiled,n,pool,16) - logdet, 1e-8);
+	for(int k = 0; k < packed.size(); ++k) BOOST_CHECK_SMALL(tiled[k] - packed[k], 1e-10);
+	lk::invertCholesky(packed,n);
+	lk::tiledInvertCholesky(tiled,n,pool,16);
+	for(int k = 0; k < packed.size(); ++k) BOOST_CHECK_SMALL(tiled[k] - packed[k], 1e-8);
+	// Tiles should be processed in the calling thread when called from within a task.
+	lk::ThreadPool::TaskGroup group(*pool);
+	group.submit(boost::bind(tiledInverse,&nested,n));
+	group.wait();
+	for(int k = 0; k < packed.size(); ++k) BOOST_CHECK_SMALL(nested[k] - packed[k], 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( shouldMatchOutOfCoreCovariance ) {
+	int n(50);
+	lk::CovarianceMatrixPtr random = lk::generateRandomCovariance(n);
+	std::string filename("OutOfCoreCovarianceTest.dat");
+	std::remove(filename.c_str());
+	lk::OutOfCoreCovariance ooc(filename,n,16);
+	BOOST_REQUIRE_EQUAL(ooc.getNTiles(),4);
+	std::vector<double> packed;
+	for(int col = 0; col < n; ++col) {
+		for(int row = 0; row <= col; ++row) {
+			ooc.setCovariance(row,col,random->getCovariance(row,col));
+			packed.push_back(random->getCovariance(row,col));
+		}
+	}
+	BOOST_CHECK_SMALL(ooc.decompose() - lk::choleskyDecompose(packed,n), 1e-8);
+	std::vector<double> delta(n);
+	for(int k = 0; k < n; ++k) delta[k] = std::sin(k);
+	BOOST_CHECK_CLOSE(ooc.chiSquare(delta), random->chiSquare(delta), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( shouldMatchConjugateGradientCovariance ) {
+	// Build a banded covariance and its sparse conjugate gradient equivalent.
+	int n(100);
+	lk::CovarianceMatrix dense(n);
+	lk::ConjugateGradientCovariance sparse(n,false);
+	for(int k = 0; k < n; ++k) {
+		dense.setCovariance(k,k,2+std::cos(k));
+		sparse.setElement(k,k,2+std::cos(k));
+		if(k == 0) continue;
+		dense.setCovariance(k-1,k,-0.5);
+		sparse.setElement(k,k-1,-0.5);
+	}
+	std::vector<double> delta(n);
+	for(int k = 0; k < n; ++k) delta[k] = std::sin(k);
+	BOOST_CHECK_CLOSE(sparse.chiSquare(delta), dense.chiSquare(delta), 1e-6);
+	// A warm start with the same residuals should converge immediately.
+	BOOST_CHECK_CLOSE(sparse.chiSquare(delta), dense.chiSquare(delta), 1e-6);
+	BOOST_CHECK_EQUAL(sparse.getLastIterations(), 0);
+	std::vector<double> weighted(delta), expected(delta);
+	sparse.multiplyByInverseCovariance(weighted);
+	dense.multiplyByInverseCovariance(expected);
+	for(int k = 0; k < n; ++k) BOOST_CHECK_SMALL(weighted[k] - expected[k], 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( shouldMatchConjugateGradientMultiplyFunction ) {
+	int n(30);
+	lk::CovarianceMatrix dense(n);
+	std::vector<double> diagonal(n), inverseDiagonal(n), delta(n);
+	for(int k = 0; k < n; ++k) {
+		dense.setCovariance(k,k,2+std::cos(k));
+		if(k > 0) dense.setCovariance(k-1,k,-0.5);
+		if(k > 2) dense.setCovariance(k-3,k,0.25);
+		delta[k] = std::sin(k);
+	}
+	for(int k = 0; k < n; ++k) {
+		diagonal[k] = dense.getCovariance(k,k);
+		inverseDiagonal[k] = dense.getInverseCovariance(k,k);
+	}
+	double expected(dense.chiSquare(delta));
+	for(int inverse = 0; inverse < 2; ++inverse) {
+		lk::ConjugateGradientCovariance::MultiplyFunction
+			multiply(boost::bind(denseMultiply,boost::cref(dense),inverse,_1,_2));
+		// Without any preconditioner.
+		lk::ConjugateGradientCovariance plain(n,multiply,inverse);
+		BOOST_CHECK_THROW(plain.setPreconditioner(
+			lk::ConjugateGradientCovariance::DiagonalPreconditioner), lk::RuntimeError);
+		BOOST_CHECK_THROW(plain.setElement(0,0,1), lk::RuntimeError);
+		BOOST_CHECK_CLOSE(plain.chiSquare(delta), expected, 1e-6);
+		// With a diagonal (Jacobi) preconditioner.
+		lk::ConjugateGradientCovariance jacobi(n,multiply,inverse,inverse ? inverseDiagonal : diagonal);
+		BOOST_CHECK_THROW(jacobi.setPreconditioner(
+			lk::ConjugateGradientCovariance::IncompleteCholeskyPreconditioner), lk::RuntimeError);
+		BOOST_CHECK_CLOSE(jacobi.chiSquare(delta), expected, 1e-6);
+		std::vector<double> roundTrip(delta);
+		jacobi.multiplyByInverseCovariance(roundTrip);
+		jacobi.multiplyByCovariance(roundTrip);
+		for(int k = 0; k < n; ++k) BOOST_CHECK_SMALL(roundTrip[k] - delta[k], 1e-8);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( shouldMatchSparseInverseCovariance ) {
+	// Set the elements of a sparse Cinv and compare with its dense inverse.
+	int n(50);
+	lk::CovarianceMatrix dense(n);
+	lk::ConjugateGradientCovariance sparse(n,true);
+	BOOST_CHECK(sparse.isInverse());
+	std::vector<double> delta(n), weighted, expected;
+	for(int k = 0; k < n; ++k) {
+		dense.setInverseCovariance(k,k,3+std::sin(k));
+		sparse.setElement(k,k,3+std::sin(k));
+		if(k > 0) {
+			dense.setInverseCovariance(k-1,k,0.7);
+			sparse.setElement(k-1,k,0.7);
+		}
+		delta[k] = std::cos(k);
+	}
+	BOOST_CHECK_CLOSE(sparse.chiSquare(delta,weighted), dense.chiSquare(delta,expected), 1e-8);
+	for(int k = 0; k < n; ++k) BOOST_CHECK_CLOSE(weighted[k], expected[k], 1e-8);
+	// Multiplying by C requires a solve.
+	weighted = expected = delta;
+	sparse.multiplyByCovariance(weighted);
+	dense.multiplyByCovariance(expected);
+	for(int k = 0; k < n; ++k) BOOST_CHECK_SMALL(weighted[k] - expected[k], 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( shouldFallBackFromIncompleteCholesky ) {
+	// A positive definite matrix whose IC(0) decomposition has a negative pivot.
+	double elements[5][5] = {
+		{ 1.0, 0.0, 0.6, 0.4, 0.0 },
+		{ 0.0, 1.0,-0.3, 0.0, 0.3 },
+		{ 0.6,-0.3, 1.0,-0.4, 0.0 },
+		{ 0.4, 0.0,-0.4, 1.0,-0.3 },
+		{ 0.0, 0.3, 0.0,-0.3, 1.0 }};
+	int n(5);
+	lk::CovarianceMatrix dense(n);
+	lk::ConjugateGradientCovariance sparse(n,false);
+	std::vector<double> delta(n);
+	for(int row = 0; row < n; ++row) {
+		delta[row] = 1 - row;
+		for(int col = row; col < n; ++col) {
+			if(0 == elements[row][col]) continue;
+			dense.setCovariance(row,col,elements[row][col]);
+			// Leave out the last diagonal element for now.
+			if(row < n-1) sparse.setElement(row,col,elements[row][col]);
+		}
+	}
+	// A missing diagonal element should leave the matrix unchanged.
+	BOOST_CHECK_THROW(sparse.chiSquare(delta), lk::RuntimeError);
+	sparse.setElement(n-1,n-1,elements[n-1][n-1]);
+	BOOST_CHECK_CLOSE(sparse.chiSquare(delta), dense.chiSquare(delta), 1e-8);
+	BOOST_CHECK_THROW(sparse.setElement(0,0,1), lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( shouldMatchPackedKernels ) {
+	std::string automatic(lk::getPackedKernelsName());
+	BOOST_CHECK_THROW(lk::setPackedKernels("sse"), lk::RuntimeError);
+	// Test each kernel set supported by this CPU against the scalar kernels, using odd
+	// sizes to exercise the remainder of each SIMD loop.
+	char const *names[] = { "scalar", "blas", "avx2", "avx512" };
+	for(int size = 1; size < 40; size += 12) {
+		int n(size);
+		std::vector<double> packed, x(n), expected(n,0), result(n);
+		for(int col = 0; col < n; ++col) {
+			x[col] = std::sin(col);
+			for(int row = 0; row <= col; ++row) packed.push_back(std::cos(row + 3*col) + (row == col ? n : 0));
+		}
+		double quadratic(0);
+		for(int row = 0; row < n; ++row) {
+			for(int col = 0; col < n; ++col) {
+				expected[row] += packed[lk::symmetricMatrixIndex(row,col,n)]*x[col];
+			}
+			quadratic += x[row]*expected[row];
+		}
+		std::vector<double> scalar;
+		for(int kernels = 0; kernels < 4; ++kernels) {
+			try {
+				lk::setPackedKernels(names[kernels]);
+			}
+			catch(lk::RuntimeError const &e) {
+				// Only SIMD kernels can be unavailable.
+				BOOST_CHECK(kernels >= 2);
+				continue;
+			}
+			BOOST_CHECK_EQUAL(lk::getPackedKernelsName(), names[kernels]);
+			std::vector<double> results;
+			lk::packedSymmetricMultiply(&packed[0],&x[0],&result[0],n);
+			for(int k = 0; k < n; ++k) BOOST_CHECK_CLOSE(result[k], expected[k], 1e-10);
+			results.insert(results.end(),result.begin(),result.end());
+			BOOST_CHECK_CLOSE(lk::packedQuadraticForm(&packed[0],&x[0],n), quadratic, 1e-10);
+			BOOST_CHECK_CLOSE(lk::vectorDotProduct(&x[0],&expected[0],n), quadratic, 1e-10);
+			// Treat the same elements as an upper-triangular matrix U.
+			std::vector<double> triangular(n);
+			for(int transpose = 0; transpose < 2; ++transpose) {
+				std::fill(triangular.begin(),triangular.end(),0);
+				for(int row = 0; row < n; ++row) {
+					for(int col = row; col < n; ++col) {
+						double value(packed[lk::symmetricMatrixIndex(row,col,n)]);
+						if(transpose) triangular[col] += value*x[row];
+						else triangular[row] += value*x[col];
+					}
+				}
+				lk::packedTriangularMultiply(&packed[0],&x[0],&result[0],n,transpose);
+				for(int k = 0; k < n; ++k) BOOST_CHECK_CLOSE(result[k], triangular[k], 1e-10);
+				results.insert(results.end(),result.begin(),result.end());
+				lk::packedTriangularSolve(&packed[0],&result[0],n,transpose);
+				for(int k = 0; k < n; ++k) BOOST_CHECK_SMALL(result[k] - x[k], 1e-12);
+			}
+			// Compare with the scalar kernels, which are always tested first.
+			if(0 == kernels) scalar = results;
+			for(int k = 0; k < results.size(); ++k) BOOST_CHECK_CLOSE(results[k], scalar[k], 1e-10);
+		}
+	}
+	lk::setPackedKernels("");
+	BOOST_CHECK_EQUAL(lk::getPackedKernelsName(), automatic);
+}
+
+BOOST_AUTO_TEST_CASE( shouldAllocateAlignedStorage ) {
+	lk::AlignedVector small(3), large(lk::getHugePageThreshold()/sizeof(double));
+	BOOST_CHECK_EQUAL((std::size_t)&small[0] % lk::alignedMemoryAlignment, 0);
+	BOOST_CHECK_EQUAL((std::size_t)&large[0] % (2 << 20), 0);
+	boost::shared_array<double> array(lk::allocateAlignedDoubleArray(5));
+	BOOST_CHECK_EQUAL((std::size_t)array.get() % lk::alignedMemoryAlignment, 0);
+	// Packed matrix functions should give the same results for both vector types.
+	int n(20);
+	std::vector<double> packed;
+	for(int col = 0; col < n; ++col) {
+		for(int row = 0; row <= col; ++row) packed.push_back(std::cos(row + 3*col) + (row == col ? n : 0));
+	}
+	lk::AlignedVector aligned(packed.begin(),packed.end());
+	BOOST_CHECK_EQUAL(lk::choleskyDecompose(aligned,n), lk::choleskyDecompose(packed,n));
+	lk::invertCholesky(packed,n);
+	lk::invertCholesky(aligned,n);
+	for(std::size_t k = 0; k < packed.size(); ++k) BOOST_CHECK_EQUAL(aligned[k], packed[k]);
+}
+
+BOOST_AUTO_TEST_CASE( shouldReplicateInverseCovariance ) {
+	lk::ThreadPoolPtr pool(new lk::ThreadPool(2,true));
+	std::vector<double> delta(size,0.5);
+	double chi2(cov->chiSquare(delta));
+	BOOST_CHECK_THROW(cov->replicateInverseCovariance(lk::ThreadPoolPtr(new lk::ThreadPool(2))),
+		lk::RuntimeError);
+	cov->replicateInverseCovariance(pool);
+	BOOST_CHECK_EQUAL(cov->getNReplicas(), std::min(2,lk::getNumaNodeCount()));
+	BOOST_CHECK_EQUAL(cov->chiSquare(delta), chi2);
+	cov->setInverseCovariance(0,0,2);
+	BOOST_CHECK_EQUAL(cov->getNReplicas(), 0);
+	// Replacing the matrix with a triple product should also drop the replicas.
+	int n(12);
+	lk::CovarianceMatrixPtr product(lk::generateRandomCovariance(n)), other(lk::generateRandomCovariance(n));
+	lk::CovarianceMatrix expected(*product);
+	expected.replaceWithTripleProduct(*other);
+	product->replicateInverseCovariance(pool);
+	std::vector<double> x(n);
+	for(int k = 0; k < n; ++k) x[k] = std::sin(k);
+	BOOST_CHECK(product->chiSquare(x) != expected.chiSquare(x));
+	product->replaceWithTripleProduct(*other);
+	BOOST_CHECK_EQUAL(product->getNReplicas(), 0);
+	BOOST_CHECK_EQUAL(product->chiSquare(x), expected.chiSquare(x));
+	std::vector<double> icovX;
+	BOOST_CHECK_CLOSE(product->chiSquare(x,icovX), expected.chiSquare(x), 1e-10);
+	BOOST_CHECK_CLOSE(product->getLogDeterminant(), expected.getLogDeterminant(), 1e-10);
+	// Huge page allocations should be first touched by the pool.
+	lk::setFirstTouchPool(pool);
+	lk::AlignedVector large(lk::getHugePageThreshold()/sizeof(double) + 1,1);
+	lk::setFirstTouchPool(lk::ThreadPoolPtr());
+	BOOST_CHECK_EQUAL(large.back(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,96 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// DualNumber class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include <vector>
+#include <cmath>
+
+// A model written for a templated scalar type, with more parameters than one DualNumber<4>.
+struct DualNumberModel {
+    template <class T> T operator()(std::vector<T> const &p) const {
+        using std::exp; using std::sin; using std::sqrt; using std::log; using std::pow;
+        T result(0);
+        for(int k = 0; k < p.size(); ++k) {
+            T term(exp(-0.5*p[k]*p[k])*sin(p[k] + k) + sqrt(1 + p[k]*p[k])/(2 + k));
+            result += (k % 2 ? term*p[0] : log(2 + term)) - pow(p[k],3.);
+        }
+        if(p[1] > 0) result = result/p[1];
+        return result;
+    }
+};
+
+BOOST_AUTO_TEST_SUITE( DualNumber )
+
+BOOST_AUTO_TEST_CASE( shouldDifferentiateTemplatedModel ) {
+    boost::shared_ptr<DualNumberModel> model(new DualNumberModel());
+    lk::FunctionPtr f(lk::createDualFunction(model));
+    lk::FunctionAndGradientPtr fg(lk::createDualFunctionAndGradient<4>(model));
+    lk::GradientCalculatorPtr gc(lk::createDualGradientCalculator<8>(model));
+    int npar(10);
+    lk::Parameters params(npar);
+    for(int k = 0; k < npar; ++k) params[k] = 0.3 + 0.1*std::sin(k);
+    lk::Gradient fused, gradient;
+    BOOST_CHECK_EQUAL((*fg)(params,fused), (*f)(params));
+    (*gc)(params,gradient);
+    BOOST_REQUIRE_EQUAL(fused.size(), npar);
+    BOOST_REQUIRE_EQUAL(gradient.size(), npar);
+    double step(1e-5);
+    for(int k = 0; k < npar; ++k) {
+        lk::Parameters up(params), down(params);
+        up[k] += step;
+        down[k] -= step;
+        double numeric(((*f)(up) - (*f)(down))/(2*step));
+        BOOST_CHECK_CLOSE(fused[k], numeric, 1e-5);
+        BOOST_CHECK_CLOSE(gradient[k], fused[k], 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( shouldDifferentiateMathFunctions ) {
+    typedef lk::DualNumber<2> Dual;
+    double x(0.3), y(-0.7), step(1e-6);
+    Dual dx(x,0), dy(y,1);
+    Dual results[] = {
+        sinh(dx*dy), cosh(dx*dy), asin(dx*dy), acos(dx*dy), atan2(dy,dx), atan2(dy,2.),
+        atan2(2.,dx), pow(dx,-dy), pow(dx,y) };
+    for(int k = 0; k < 9; ++k) {
+        for(int index = 0; index < 2; ++index) {
+            double up[2] = { x, y }, down[2] = { x, y };
+            up[index] += step;
+            down[index] -= step;
+            double fup[] = {
+                std::sinh(up[0]*up[1]), std::cosh(up[0]*up[1]), std::asin(up[0]*up[1]),
+                std::acos(up[0]*up[1]), std::atan2(up[1],up[0]), std::atan2(up[1],2.),
+                std::atan2(2.,up[0]), std::pow(up[0],-up[1]), std::pow(up[0],y) };
+            double fdown[] = {
+                std::sinh(down[0]*down[1]), std::cosh(down[0]*down[1]), std::asin(down[0]*down[1]),
+                std::acos(down[0]*down[1]), std::atan2(down[1],down[0]), std::atan2(down[1],2.),
+                std::atan2(2.,down[0]), std::pow(down[0],-down[1]), std::pow(down[0],y) };
+            double numeric((fup[k] - fdown[k])/(2*step));
+            BOOST_CHECK_SMALL(results[k].getDerivative(index) - numeric, 1e-7);
+        }
+    }
+    BOOST_CHECK_EQUAL(atan2(dy,dx).getValue(), std::atan2(y,x));
+    BOOST_CHECK(Dual(1.5).isConstant());
+    BOOST_CHECK(!dy.isConstant());
+}
+
+BOOST_AUTO_TEST_CASE( shouldRaiseZeroToConstantPower ) {
+    typedef lk::DualNumber<1> Dual;
+    Dual zero(0,0);
+    // A constant exponent should not pick up the non-finite log(0).
+    Dual squared(pow(zero,Dual(2))), cubed(pow(zero,3.)), one(pow(zero,Dual(0)));
+    BOOST_CHECK_EQUAL(squared.getValue(), 0);
+    BOOST_CHECK_EQUAL(squared.getDerivative(0), 0);
+    BOOST_CHECK_EQUAL(cubed.getDerivative(0), 0);
+    BOOST_CHECK_EQUAL(one.getValue(), 1);
+    BOOST_CHECK_EQUAL(one.getDerivative(0), 0);
+    // The derivative at zero of x^1 is one.
+    BOOST_CHECK_EQUAL(pow(zero,Dual(1)).getDerivative(0), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // DualNumber
@@ -0,0 +1,109 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// FisherMatrix class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include "boost/bind.hpp"
+
+#include <cmath>
+
+namespace {
+    // Predicts a + b*x + c*x^2 at each bin center x = (k+0.5)/n.
+    void quadraticModel(lk::Parameters const &values, std::vector<double> &pred, int n) {
+        pred.resize(n);
+        for(int k = 0; k < n; ++k) {
+            double x((k + 0.5)/n);
+            pred[k] = values[0] + values[1]*x + values[2]*x*x;
+        }
+    }
+    // Fills the derivatives of the same model with respect to a and b, with c fixed.
+    void quadraticJacobian(lk::Parameters const &values, std::vector<double> &jacobian, int n) {
+        jacobian.resize(2*n);
+        for(int k = 0; k < n; ++k) {
+            jacobian[k] = 1;
+            jacobian[n+k] = (k + 0.5)/n;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( FisherMatrix )
+
+BOOST_AUTO_TEST_CASE( shouldForecastLinearModel ) {
+    int n(25);
+    lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,n));
+    lk::BinnedDataPtr data(new lk::BinnedData(lk::BinnedGrid(axis)));
+    lk::FitParameters parameters;
+    parameters.push_back(lk::FitParameter("a",1,0.1));
+    parameters.push_back(lk::FitParameter("b",-2,0.1));
+    parameters.push_back(lk::FitParameter("c",0.5,0.1));
+    parameters[2].fix();
+    lk::Parameters fiducial;
+    lk::getFitParameterValues(parameters,fiducial);
+    std::vector<double> pred;
+    quadraticModel(fiducial,pred,n);
+    // Calculate the expected Fisher matrix for a diagonal covariance.
+    double F00(0), F01(0), F11(0);
+    for(int k = 0; k < n; ++k) data->setData(k,pred[k]);
+    for(int k = 0; k < n; ++k) {
+        double x((k + 0.5)/n), sigma(0.1 + x);
+        data->setCovariance(k,k,sigma*sigma);
+        F00 += 1/(sigma*sigma);
+        F01 += x/(sigma*sigma);
+        F11 += x*x/(sigma*sigma);
+    }
+    double det(F00*F11 - F01*F01);
+    lk::FisherMatrix fisher(boost::bind(quadraticModel,_1,_2,n),data,parameters);
+    lk::FunctionMinimumPtr serial(fisher.forecast());
+    BOOST_CHECK_SMALL(serial->getMinValue(), 1e-12);
+    BOOST_REQUIRE_EQUAL(serial->getNParameters(true), 2);
+    lk::CovarianceMatrixCPtr covariance(serial->getCovariance());
+    BOOST_CHECK_CLOSE(covariance->getCovariance(0,0), F11/det, 1e-6);
+    BOOST_CHECK_CLOSE(covariance->getCovariance(0,1), -F01/det, 1e-6);
+    BOOST_CHECK_CLOSE(covariance->getCovariance(1,1), F00/det, 1e-6);
+    BOOST_CHECK_CLOSE(serial->getErrors(true)[1], std::sqrt(F00/det), 1e-6);
+    // Parallel finite differences and an analytic Jacobian should give the same result.
+    lk::FunctionMinimumPtr parallel(fisher.forecast(lk::ThreadPoolPtr(new lk::ThreadPool(3))));
+    fisher.setJacobianFunction(boost::bind(quadraticJacobian,_1,_2,n));
+    lk::FunctionMinimumPtr analytic(fisher.forecast());
+    for(int row = 0; row < 2; ++row) {
+        for(int col = 0; col < 2; ++col) {
+            double expected(covariance->getCovariance(row,col));
+            BOOST_CHECK_EQUAL(parallel->getCovariance()->getCovariance(row,col), expected);
+            BOOST_CHECK_CLOSE(analytic->getCovariance()->getCovariance(row,col), expected, 1e-6);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( shouldIncludeGaussianPriors ) {
+    int n(10);
+    lk::AbsBinningCPtr axis(new lk::UniformBinning(0.,1.,n));
+    lk::BinnedDataPtr data(new lk::BinnedData(lk::BinnedGrid(axis)));
+    for(int k = 0; k < n; ++k) data->setData(k,0);
+    lk::FitParameters parameters;
+    parameters.push_back(lk::FitParameter("a",0,0.1));
+    parameters.push_back(lk::FitParameter("b",0,0.1));
+    parameters.push_back(lk::FitParameter("c",0,0.1));
+    // Without any covariance, the data has unit weight.
+    lk::FisherMatrix fisher(boost::bind(quadraticModel,_1,_2,n),data,parameters);
+    lk::FunctionMinimumPtr fmin(fisher.forecast());
+    BOOST_CHECK_EQUAL(fmin->getNParameters(true), 3);
+    // A prior with sigma = 1 on c adds one to its Fisher matrix diagonal.
+    lk::Parameters values(3,0);
+    values[0] = 1;
+    parameters[2].setPrior(-2,2,0.5,lk::FitParameter::GaussPrior);
+    lk::FisherMatrix constrained(boost::bind(quadraticModel,_1,_2,n),data,parameters);
+    lk::FunctionMinimumPtr prior(constrained.forecast(values));
+    BOOST_CHECK_CLOSE(prior->getMinValue(), 0.5*n, 1e-8);
+    BOOST_CHECK_CLOSE(prior->getCovariance()->getInverseCovariance(2,2),
+        fmin->getCovariance()->getInverseCovariance(2,2) + 1, 1e-6);
+    // A parameter that does not change the prediction is unconstrained.
+    parameters.push_back(lk::FitParameter("d",0,0.1));
+    lk::FisherMatrix unconstrained(boost::bind(quadraticModel,_1,_2,n),data,parameters);
+    BOOST_CHECK_THROW(unconstrained.forecast(), lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // FisherMatrix
@@ -0,0 +1,264 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// Interpolator class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "config.h" // propagates HAVE_LIBGSL from configure
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include "boost/cstdint.hpp"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+// All interpolation algorithms need GSL.
+#ifdef HAVE_LIBGSL
+
+namespace {
+    // Writes n rows of x = k, y = scale*k*k to the named text file and sets its modification
+    // time, so that tests do not depend on the resolution of file times.
+    void writeTable(std::string const &filename, int n, double scale, time_t mtime) {
+        std::ofstream out(filename.c_str());
+        for(int k = 0; k < n; ++k) out << k << ' ' << scale*k*k << std::endl;
+        out.close();
+        struct utimbuf times;
+        times.actime = times.modtime = mtime;
+        utime(filename.c_str(),&times);
+    }
+    // Returns the size of the named file in bytes, or -1 if it does not exist.
+    off_t getFileSize(std::string const &filename) {
+        struct stat info;
+        return 0 == ::stat(filename.c_str(),&info) ? info.st_size : -1;
+    }
+    // Returns the number of values recorded in the header of a binary sidecar, which
+    // starts with an 8-byte magic string.
+    boost::uint64_t getSidecarNValues(std::string const &sidecarName) {
+        boost::uint64_t nValues(0);
+        std::ifstream in(sidecarName.c_str(),std::ios::binary);
+        in.seekg(8);
+        in.read(reinterpret_cast<char*>(&nValues),sizeof(nValues));
+        return nValues;
+    }
+    // Overwrites the number of values recorded in the header of a binary sidecar.
+    void setSidecarNValues(std::string const &sidecarName, boost::uint64_t nValues) {
+        std::fstream io(sidecarName.c_str(),std::ios::in|std::ios::out|std::ios::binary);
+        io.seekp(8);
+        io.write(reinterpret_cast<char const*>(&nValues),sizeof(nValues));
+    }
+    // Returns a smooth function to tabulate.
+    double smooth(double x) { return std::sin(x) + 0.1*x*x; }
+    // Checks that two interpolators agree, including their derivatives, over a range that
+    // extends beyond their control points.
+    void checkSame(lk::Interpolator const &a, lk::Interpolator const &b) {
+        for(double x = -1; x < 11; x += 0.37) {
+            BOOST_CHECK_CLOSE(a(x), b(x), 1e-8);
+            BOOST_CHECK_CLOSE(a.getDerivative(x), b.getDerivative(x), 1e-8);
+        }
+    }
+    // Checks that a table holds the values written by writeTable.
+    void checkTable(lk::InterpolatorTableCPtr table, int n, double scale) {
+        BOOST_REQUIRE_EQUAL(table->getNValues(), n);
+        for(int k = 0; k < n; ++k) {
+            BOOST_CHECK_EQUAL(table->getX()[k], k);
+            BOOST_CHECK_EQUAL(table->getY()[k], scale*k*k);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( Interpolator )
+
+BOOST_AUTO_TEST_CASE( shouldCacheInterpolatorTables ) {
+    std::string filename("InterpolatorCacheTest.dat");
+    time_t mtime(::time(0) - 100);
+    writeTable(filename,5,1,mtime);
+    lk::clearInterpolatorTableCache();
+    // Repeated requests for the same file and algorithm share one table.
+    lk::InterpolatorTableCPtr linear(lk::getInterpolatorTable(filename,"linear"));
+    checkTable(linear,5,1);
+    BOOST_CHECK(!linear->isMapped());
+    BOOST_CHECK(lk::getInterpolatorTable(filename,"linear") == linear);
+    BOOST_CHECK(lk::createInterpolator(filename,"linear")->getTable() == linear);
+    lk::InterpolatorTableCPtr cspline(lk::getInterpolatorTable(filename,"cspline"));
+    BOOST_CHECK(cspline != linear);
+    BOOST_CHECK_EQUAL(cspline->getAlgorithm(), "cspline");
+    BOOST_CHECK(lk::getInterpolatorTable(filename,"cspline") == cspline);
+    // A file with the same size and a new modification time is read again.
+    writeTable(filename,5,2,mtime + 10);
+    lk::InterpolatorTableCPtr modified(lk::getInterpolatorTable(filename,"linear"));
+    BOOST_CHECK(modified != linear);
+    checkTable(modified,5,2);
+    // Tables that are still in use are not changed.
+    checkTable(linear,5,1);
+    // A file with a new size and the same modification time is read again.
+    writeTable(filename,6,2,mtime + 10);
+    lk::InterpolatorTableCPtr resized(lk::getInterpolatorTable(filename,"linear"));
+    BOOST_CHECK(resized != modified);
+    checkTable(resized,6,2);
+    BOOST_CHECK(lk::getInterpolatorTable(filename,"linear") == resized);
+    // Clearing the cache forces the file to be read again.
+    lk::clearInterpolatorTableCache();
+    lk::InterpolatorTableCPtr reread(lk::getInterpolatorTable(filename,"linear"));
+    BOOST_CHECK(reread != resized);
+    checkTable(reread,6,2);
+    std::remove(filename.c_str());
+    BOOST_CHECK_THROW(lk::getInterpolatorTable(filename,"linear"),lk::RuntimeError);
+    lk::clearInterpolatorTableCache();
+}
+
+BOOST_AUTO_TEST_CASE( shouldUseBinarySidecar ) {
+    std::string filename("InterpolatorSidecarTest.dat"), sidecarName(filename + ".bin");
+    int n(7);
+    off_t sidecarSize(16 + 2*n*sizeof(double));
+    time_t mtime(::time(0) - 100);
+    writeTable(filename,n,3,mtime);
+    std::remove(sidecarName.c_str());
+    lk::clearInterpolatorTableCache();
+    // A missing sidecar is written and then mapped.
+    lk::InterpolatorTableCPtr written(lk::getInterpolatorTable(filename,"linear",true));
+    BOOST_CHECK(written->isMapped());
+    checkTable(written,n,3);
+    BOOST_CHECK_EQUAL(getFileSize(sidecarName), sidecarSize);
+    BOOST_CHECK_EQUAL(getSidecarNValues(sidecarName), (boost::uint64_t)n);
+    // An existing sidecar is mapped without reading the text file.
+    lk::clearInterpolatorTableCache();
+    lk::InterpolatorTableCPtr mapped(lk::getInterpolatorTable(filename,"linear",true));
+    BOOST_CHECK(mapped->isMapped());
+    checkTable(mapped,n,3);
+    // Interpolators using a mapped table make a private copy before changing it.
+    lk::Interpolator interpolator(mapped);
+    BOOST_CHECK_CLOSE(interpolator(2.5), 3*6.5, 1e-12);
+    std::vector<double> y(n,1);
+    interpolator.setYValues(y);
+    BOOST_CHECK(interpolator.getTable() != mapped);
+    BOOST_CHECK_CLOSE(interpolator(2.5), 1, 1e-12);
+    checkTable(mapped,n,3);
+    // A sidecar that is older than the text file is replaced.
+    writeTable(filename,n,4,mtime + 10);
+    struct utimbuf times;
+    times.actime = times.modtime = mtime + 5;
+    utime(sidecarName.c_str(),&times);
+    lk::InterpolatorTableCPtr updated(lk::getInterpolatorTable(filename,"linear",true));
+    BOOST_CHECK(updated->isMapped());
+    checkTable(updated,n,4);
+    checkTable(mapped,n,3);
+    // A truncated sidecar is ignored and replaced.
+    lk::clearInterpolatorTableCache();
+    BOOST_REQUIRE_EQUAL(truncate(sidecarName.c_str(),sidecarSize - 8), 0);
+    updated = lk::getInterpolatorTable(filename,"linear",true);
+    BOOST_CHECK(updated->isMapped());
+    checkTable(updated,n,4);
+    BOOST_CHECK_EQUAL(getFileSize(sidecarName), sidecarSize);
+    // A sidecar shorter than its header is ignored and replaced.
+    lk::clearInterpolatorTableCache();
+    BOOST_REQUIRE_EQUAL(truncate(sidecarName.c_str(),4), 0);
+    updated = lk::getInterpolatorTable(filename,"linear",true);
+    checkTable(updated,n,4);
+    BOOST_CHECK_EQUAL(getFileSize(sidecarName), sidecarSize);
+    // A sidecar whose header does not match its length is ignored and replaced.
+    lk::clearInterpolatorTableCache();
+    setSidecarNValues(sidecarName,n + 1);
+    updated = lk::getInterpolatorTable(filename,"linear",true);
+    checkTable(updated,n,4);
+    BOOST_CHECK_EQUAL(getSidecarNValues(sidecarName), (boost::uint64_t)n);
+    // A header whose size calculation overflows to the sidecar length is also rejected.
+    lk::clearInterpolatorTableCache();
+    boost::uint64_t wrapped((boost::uint64_t)1 << 60);
+    setSidecarNValues(sidecarName,wrapped + n);
+    updated = lk::getInterpolatorTable(filename,"linear",true);
+    checkTable(updated,n,4);
+    BOOST_CHECK_EQUAL(getSidecarNValues(sidecarName), (boost::uint64_t)n);
+    // A sidecar with the wrong magic string is ignored and replaced.
+    lk::clearInterpolatorTableCache();
+    {
+        std::fstream io(sidecarName.c_str(),std::ios::in|std::ios::out|std::ios::binary);
+        io.write("XXXXXXXX",8);
+    }
+    updated = lk::getInterpolatorTable(filename,"linear",true);
+    BOOST_CHECK(updated->isMapped());
+    checkTable(updated,n,4);
+    char magic[8];
+    std::ifstream in(sidecarName.c_str(),std::ios::binary);
+    in.read(magic,sizeof(magic));
+    BOOST_CHECK(0 == std::memcmp(magic,"LIKELYT1",sizeof(magic)));
+    lk::clearInterpolatorTableCache();
+    std::remove(filename.c_str());
+    std::remove(sidecarName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( shouldCopyTableBeforeSettingYValues ) {
+    std::vector<double> x, y, y2;
+    for(int k = 0; k < 11; ++k) {
+        x.push_back(k + 0.05*k*k);
+        y.push_back(smooth(x.back()));
+        y2.push_back(std::cos(x.back()));
+    }
+    lk::Interpolator original(x,y,"cspline"), reference(x,y,"cspline"), expected(x,y2,"cspline");
+    // Another interpolator sharing our table must not see our new y values.
+    lk::InterpolatorTable const *before(original.getTable().get());
+    lk::Interpolator shared(original.getTable());
+    original.setYValues(y2);
+    BOOST_CHECK(original.getTable().get() != before);
+    checkSame(original,expected);
+    BOOST_CHECK(shared.getTable().get() == before);
+    BOOST_CHECK(shared.getYGrid() == y);
+    checkSame(shared,reference);
+    // Once the table is no longer shared, it is updated in place.
+    before = original.getTable().get();
+    original.setYValues(y);
+    BOOST_CHECK(original.getTable().get() == before);
+    checkSame(original,reference);
+    // Any other holder of our table must not see our new y values either.
+    lk::InterpolatorTableCPtr table(original.getTable());
+    original.setYValues(y2);
+    BOOST_CHECK(original.getTable() != table);
+    checkSame(original,expected);
+    for(int k = 0; k < 11; ++k) BOOST_CHECK_EQUAL(table->getY()[k], y[k]);
+    // An interpolator that never owned its table copies it too.
+    table = shared.getTable();
+    shared.setYValues(&smooth);
+    BOOST_CHECK(shared.getTable() != table);
+    checkSame(shared,reference);
+    BOOST_CHECK(shared.getXGrid() == x);
+    BOOST_CHECK_EQUAL(table.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( shouldTransformYValuesLazily ) {
+    std::vector<double> x, y, transformed;
+    for(int k = 0; k < 11; ++k) {
+        x.push_back(k + 0.05*k*k);
+        y.push_back(smooth(x.back()));
+        transformed.push_back(3*(2*y.back() + 1) - 4);
+    }
+    char const *algorithms[] = { "linear", "cspline", "cspline_akima" };
+    for(int index = 0; index < 3; ++index) {
+        lk::Interpolator interpolator(x,y,algorithms[index]), expected(x,transformed,algorithms[index]);
+        lk::InterpolatorTableCPtr table(interpolator.getTable());
+        // Transforms accumulate without changing the shared table.
+        interpolator.transformYValues(2,1);
+        interpolator.transformYValues(3,-4);
+        BOOST_CHECK(interpolator.getTable() == table);
+        for(int k = 0; k < 11; ++k) BOOST_CHECK_EQUAL(table->getY()[k], y[k]);
+        checkSame(interpolator,expected);
+        std::vector<double> grid(interpolator.getYGrid());
+        for(int k = 0; k < 11; ++k) BOOST_CHECK_CLOSE(grid[k], transformed[k], 1e-10);
+        // Setting new y values discards any transform.
+        interpolator.setYValues(transformed);
+        checkSame(interpolator,expected);
+        BOOST_CHECK(interpolator.getYGrid() == transformed);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Interpolator
+
+#endif // HAVE_LIBGSL
@@ -0,0 +1,124 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// LbfgsbEngine class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include "boost/bind.hpp"
+#include "boost/lexical_cast.hpp"
+
+#include <cmath>
+
+namespace {
+    // A correlated quadratic with its minimum at (1,2,3,...) that throws if it is ever
+    // evaluated below the specified lower bound for its first parameter.
+    double quadratic(lk::Parameters const &p, double lower) {
+        if(p[0] < lower) throw lk::RuntimeError("quadratic: evaluated outside bounds.");
+        double result(0);
+        for(int k = 0; k < p.size(); ++k) {
+            double dk(p[k] - (k + 1));
+            result += (k + 1)*dk*dk;
+            if(k > 0) result += 0.5*dk*(p[k-1] - k);
+        }
+        return result;
+    }
+    void quadraticGradient(lk::Parameters const &p, lk::Gradient &g) {
+        g.assign(p.size(),0);
+        for(int k = 0; k < p.size(); ++k) {
+            double dk(p[k] - (k + 1));
+            g[k] += 2*(k + 1)*dk;
+            if(k > 0) {
+                g[k] += 0.5*(p[k-1] - k);
+                g[k-1] += 0.5*dk;
+            }
+        }
+    }
+    // A separable quadratic with its minimum at (-1,0.5), below the lower bound of its first
+    // parameter, that throws if it is ever evaluated below that bound. Counts its calls.
+    double const boxLower = 0.057;
+    int nFunction(0), nFused(0);
+    double shifted(lk::Parameters const &p) {
+        if(p[0] < boxLower) throw lk::RuntimeError("shifted: evaluated outside bounds.");
+        nFunction++;
+        return (p[0] + 1)*(p[0] + 1) + 3*(p[1] - 0.5)*(p[1] - 0.5);
+    }
+    double shiftedAndGradient(lk::Parameters const &p, lk::Gradient &g) {
+        if(p[0] < boxLower) throw lk::RuntimeError("shifted: evaluated outside bounds.");
+        nFused++;
+        g.resize(2);
+        g[0] = 2*(p[0] + 1);
+        g[1] = 6*(p[1] - 0.5);
+        return (p[0] + 1)*(p[0] + 1) + 3*(p[1] - 0.5)*(p[1] - 0.5);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( LbfgsbEngine )
+
+BOOST_AUTO_TEST_CASE( shouldFindUnboundedMinimum ) {
+    int npar(6);
+    lk::FunctionPtr f(new lk::Function(boost::bind(quadratic,_1,-1e30)));
+    lk::GradientCalculatorPtr gc(new lk::GradientCalculator(quadraticGradient));
+    lk::FitParameters params;
+    for(int k = 0; k < npar; ++k) {
+        params.push_back(lk::FitParameter("p" + boost::lexical_cast<std::string>(k),0,0.5));
+    }
+    lk::FunctionMinimumPtr fmin(lk::findMinimum(f,gc,params,"lbfgsb::m5",1e-8));
+    BOOST_CHECK_EQUAL(fmin->getStatus(), lk::FunctionMinimum::OK);
+    lk::Parameters best(fmin->getParameters());
+    for(int k = 0; k < npar; ++k) BOOST_CHECK_CLOSE(best[k], k + 1., 1e-3);
+    // Finite differences should also find the minimum, less precisely.
+    fmin = lk::findMinimum(f,params,"lbfgsb::m3",1e-6);
+    best = fmin->getParameters();
+    for(int k = 0; k < npar; ++k) BOOST_CHECK_CLOSE(best[k], k + 1., 1e-2);
+}
+
+BOOST_AUTO_TEST_CASE( shouldStopAtBoxPrior ) {
+    int npar(4);
+    double lower(1.5);
+    lk::FunctionPtr f(new lk::Function(boost::bind(quadratic,_1,lower)));
+    lk::GradientCalculatorPtr gc(new lk::GradientCalculator(quadraticGradient));
+    lk::FitParameters params;
+    for(int k = 0; k < npar; ++k) {
+        params.push_back(lk::FitParameter("p" + boost::lexical_cast<std::string>(k),3,0.5));
+    }
+    params[0].setPrior(lower,10,1,lk::FitParameter::BoxPrior);
+    // Fix the last parameter at its true value.
+    params[npar-1] = lk::FitParameter("p3",npar,0);
+    lk::FunctionMinimumPtr fmin(lk::findMinimum(f,gc,params,"lbfgsb::m5",1e-8));
+    lk::Parameters best(fmin->getParameters());
+    BOOST_CHECK_EQUAL(best[0], lower);
+    BOOST_CHECK_EQUAL(best[npar-1], npar);
+    // The remaining floating parameters should minimize the function with p0 = lower.
+    lk::Gradient g;
+    quadraticGradient(best,g);
+    BOOST_CHECK(g[0] > 0);
+    for(int k = 1; k < npar-1; ++k) BOOST_CHECK_SMALL(g[k], 1e-6);
+    BOOST_CHECK_THROW(lk::findMinimum(f,gc,params,"lbfgsb::mx"), lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( shouldStayInsideBoxPriorWithAnyError ) {
+    // An error of 0.3 does not scale and unscale the bound exactly.
+    lk::FitParameters params;
+    params.push_back(lk::FitParameter("a",1,0.3));
+    params.push_back(lk::FitParameter("b",0,0.7));
+    params[0].setPrior(boxLower,2,1,lk::FitParameter::BoxPrior);
+    lk::FunctionPtr f(new lk::Function(shifted));
+    lk::FunctionAndGradientPtr fg(new lk::FunctionAndGradient(shiftedAndGradient));
+    // Use finite differences, then the fused evaluator.
+    lk::FunctionMinimumPtr fmin(lk::findMinimum(f,params,"lbfgsb::m4",1e-6));
+    BOOST_CHECK_EQUAL(fmin->getParameters()[0], boxLower);
+    BOOST_CHECK_CLOSE(fmin->getParameters()[1], 0.5, 1e-3);
+    nFunction = nFused = 0;
+    fmin = lk::findMinimum(f,lk::GradientCalculatorPtr(),fg,params,"lbfgsb::m4",1e-6);
+    BOOST_CHECK_EQUAL(fmin->getParameters()[0], boxLower);
+    BOOST_CHECK_CLOSE(fmin->getParameters()[1], 0.5, 1e-3);
+    BOOST_CHECK(nFused > 0);
+    BOOST_CHECK_EQUAL(fmin->getNGradCount(), nFused);
+    // Only the initial point and rejected line search trials use the function alone.
+    BOOST_CHECK_EQUAL(fmin->getNEvalCount(), nFunction + nFused);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // LbfgsbEngine
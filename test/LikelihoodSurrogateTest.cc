@@ -0,0 +1,83 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// LikelihoodSurrogate class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+struct LikelihoodSurrogateFixture
+{
+    LikelihoodSurrogateFixture() {
+        parameters.push_back(lk::FitParameter("x",1,0.5));
+        parameters.push_back(lk::FitParameter("fixed",3,0));
+        parameters.push_back(lk::FitParameter("y",-2,0.1));
+        surrogate.reset(new lk::LikelihoodSurrogate(parameters));
+        random = lk::Random::instance();
+        random->setSeed(123);
+    }
+    ~LikelihoodSurrogateFixture() { }
+    // An exactly quadratic function of the floating parameters.
+    static double quadratic(lk::Parameters const &p) {
+        double dx(p[0]-1), dy(p[2]+2);
+        return 4*dx*dx + 10*dx*dy + 100*dy*dy + 0.5*dx + 7;
+    }
+    lk::Parameters randomPoint() {
+        lk::Parameters p(3);
+        p[0] = 1 + 0.5*random->getNormal();
+        p[1] = 3;
+        p[2] = -2 + 0.1*random->getNormal();
+        return p;
+    }
+    lk::FitParameters parameters;
+    lk::LikelihoodSurrogatePtr surrogate;
+    lk::RandomPtr random;
+};
+
+// Counts the number of times a quadratic function is evaluated.
+struct CountedQuadratic {
+    CountedQuadratic(int &n) : count(n) { }
+    double operator()(lk::Parameters const &p) const {
+        count++;
+        return LikelihoodSurrogateFixture::quadratic(p);
+    }
+    int &count;
+};
+
+BOOST_FIXTURE_TEST_SUITE( LikelihoodSurrogate, LikelihoodSurrogateFixture )
+
+BOOST_AUTO_TEST_CASE( shouldBeUncertainWithoutEnoughSamples ) {
+    double error;
+    for(int i = 1; i < surrogate->getMinSamples(); ++i) {
+        lk::Parameters p(randomPoint());
+        surrogate->addSample(p,quadratic(p));
+    }
+    surrogate->evaluate(randomPoint(),error);
+    BOOST_CHECK(error > 1e300);
+}
+
+BOOST_AUTO_TEST_CASE( shouldReproduceQuadratic ) {
+    for(int i = 0; i < 50; ++i) {
+        lk::Parameters p(randomPoint());
+        surrogate->addSample(p,quadratic(p));
+    }
+    for(int i = 0; i < 5; ++i) {
+        double error;
+        lk::Parameters p(randomPoint());
+        double value = surrogate->evaluate(p,error);
+        BOOST_CHECK_CLOSE(value,quadratic(p),1e-4);
+        BOOST_CHECK(error < 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( shouldOnlyCallTrueFunctionWhenUncertain ) {
+    int nCalls(0);
+    lk::FunctionPtr f(new lk::Function(CountedQuadratic(nCalls)));
+    lk::FunctionPtr screened = lk::createScreenedFunction(surrogate,f,1e-3);
+    for(int i = 0; i < 100; ++i) (*screened)(randomPoint());
+    BOOST_CHECK(nCalls < 100);
+    BOOST_CHECK_EQUAL(nCalls,surrogate->getNSamples());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // LikelihoodSurrogate
@@ -0,0 +1,158 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// MarkovChainEngine class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include "boost/bind.hpp"
+
+#include <vector>
+
+namespace {
+    // Returns -log(L) for a correlated Gaussian likelihood using the chi-square of data
+    // whose predictions are the parameter values.
+    double dataNLL(lk::Parameters const &p, lk::BinnedDataCPtr data) {
+        return 0.5*data->chiSquare(p);
+    }
+    double dataNLLWithThreshold(lk::Parameters const &p, double threshold, lk::BinnedDataCPtr data) {
+        return 0.5*data->chiSquareWithThreshold(p,2*threshold);
+    }
+    // Accumulates the sums needed for the means and covariance of the current values.
+    struct ChainMoments {
+        ChainMoments() : count(0), sums(5,0) { }
+        void operator()(lk::Parameters const &current, lk::Parameters const &/*trial*/,
+        double /*currentNLL*/, double /*trialNLL*/, bool /*accepted*/) {
+            count++;
+            sums[0] += current[0];
+            sums[1] += current[1];
+            sums[2] += current[0]*current[0];
+            sums[3] += current[0]*current[1];
+            sums[4] += current[1]*current[1];
+        }
+        double mean(int k) const { return sums[k]/count; }
+        double covariance(int j, int k) const {
+            return sums[2+j+k]/count - mean(j)*mean(k);
+        }
+        int count;
+        std::vector<double> sums;
+    };
+    // Holds the data and starting point for sampling the same Gaussian posterior, with
+    // means (1,-1), errors (1,2) and correlation 0.5.
+    struct Posterior {
+        Posterior() : data(new lk::BinnedData(lk::BinnedGrid(lk::AbsBinningCPtr(
+            new lk::UniformBinning(0.,2.,2))))) {
+            data->setData(0,1);
+            data->setData(1,-1);
+            covariance.reset(new lk::CovarianceMatrix(2));
+            covariance->setCovariance(0,0,1);
+            covariance->setCovariance(0,1,1);
+            covariance->setCovariance(1,1,4);
+            data->setCovariance(0,0,1);
+            data->setCovariance(0,1,1);
+            data->setCovariance(1,1,4);
+            parameters.push_back(lk::FitParameter("x",1,1));
+            parameters.push_back(lk::FitParameter("y",-1,2));
+            f.reset(new lk::Function(boost::bind(dataNLL,_1,lk::BinnedDataCPtr(data))));
+        }
+        lk::FunctionMinimumPtr createMinimum() const {
+            return lk::FunctionMinimumPtr(new lk::FunctionMinimum(0,parameters,covariance));
+        }
+        lk::BinnedDataPtr data;
+        lk::CovarianceMatrixPtr covariance;
+        lk::FitParameters parameters;
+        lk::FunctionPtr f;
+    };
+    // Checks that the moments of a chain match the posterior.
+    void checkMoments(ChainMoments const &moments) {
+        BOOST_CHECK_SMALL(moments.mean(0) - 1, 0.1);
+        BOOST_CHECK_SMALL(moments.mean(1) + 1, 0.2);
+        BOOST_CHECK_CLOSE(moments.covariance(0,0), 1, 10);
+        BOOST_CHECK_CLOSE(moments.covariance(0,1), 1, 10);
+        BOOST_CHECK_CLOSE(moments.covariance(1,1), 4, 10);
+    }
+    // Generates a seeded chain and returns its moments.
+    ChainMoments generate(lk::MarkovChainEngine &engine, Posterior const &posterior,
+    int nAccepts, int &nTrials) {
+        ChainMoments moments;
+        nTrials = engine.generate(posterior.createMinimum(),nAccepts,0,boost::ref(moments));
+        return moments;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( MarkovChainEngine )
+
+BOOST_AUTO_TEST_CASE( shouldSampleWithDelayedAcceptance ) {
+    Posterior posterior;
+    lk::Random::instance()->setSeed(123);
+    lk::RandomPtr random(new lk::Random());
+    random->setSeed(456);
+    int nAccepts(50000), plainTrials, exactTrials, wrongTrials;
+    lk::MarkovChainEngine plain(posterior.f,lk::GradientCalculatorPtr(),posterior.parameters,
+        "saunter",random);
+    ChainMoments plainMoments(generate(plain,posterior,nAccepts,plainTrials));
+    checkMoments(plainMoments);
+    BOOST_CHECK_EQUAL(plain.getEvalCount(), plainTrials);
+    // An exact approximation only evaluates the true function for accepted trials, with
+    // the same acceptance rate as plain Metropolis.
+    lk::MarkovChainEngine exact(posterior.f,lk::GradientCalculatorPtr(),posterior.parameters,
+        "saunter",random);
+    exact.setApproximateFunction(lk::createGaussianApproximation(posterior.createMinimum()));
+    ChainMoments exactMoments(generate(exact,posterior,nAccepts,exactTrials));
+    checkMoments(exactMoments);
+    BOOST_CHECK_EQUAL(exact.getEvalCount(), nAccepts);
+    BOOST_CHECK_CLOSE((double)exactTrials, (double)plainTrials, 5);
+    // An approximation with the wrong shape and center should still sample the true
+    // posterior, with the second stage rejecting some screened trials.
+    lk::CovarianceMatrixPtr wrong(new lk::CovarianceMatrix(2));
+    wrong->setCovariance(0,0,2);
+    wrong->setCovariance(1,1,3);
+    lk::Parameters center(2);
+    center[0] = 1.3;
+    center[1] = -0.5;
+    lk::FunctionMinimumPtr shifted(new lk::FunctionMinimum(0,posterior.parameters,wrong));
+    shifted->updateParameterValues(0,center);
+    lk::MarkovChainEngine screened(posterior.f,lk::GradientCalculatorPtr(),posterior.parameters,
+        "saunter",random);
+    screened.setApproximateFunction(lk::createGaussianApproximation(shifted));
+    ChainMoments wrongMoments(generate(screened,posterior,nAccepts,wrongTrials));
+    checkMoments(wrongMoments);
+    BOOST_CHECK(screened.getEvalCount() > nAccepts);
+    BOOST_CHECK(screened.getEvalCount() < wrongTrials);
+    BOOST_CHECK_SMALL(wrongMoments.mean(0) - plainMoments.mean(0), 0.1);
+    BOOST_CHECK_CLOSE(wrongMoments.covariance(1,1), plainMoments.covariance(1,1), 10);
+}
+
+BOOST_AUTO_TEST_CASE( shouldSampleWithThreshold ) {
+    Posterior posterior;
+    lk::Random::instance()->setSeed(321);
+    lk::RandomPtr random(new lk::Random());
+    random->setSeed(654);
+    int nAccepts(50000), plainTrials, thresholdTrials, screenedTrials;
+    lk::MarkovChainEngine plain(posterior.f,lk::GradientCalculatorPtr(),posterior.parameters,
+        "saunter",random);
+    ChainMoments plainMoments(generate(plain,posterior,nAccepts,plainTrials));
+    // The threshold function makes the same decisions, so the acceptance rate and
+    // posterior should match plain Metropolis.
+    lk::MarkovChainEngine threshold(posterior.f,lk::GradientCalculatorPtr(),posterior.parameters,
+        "saunter",random);
+    threshold.setThresholdFunction(boost::bind(dataNLLWithThreshold,_1,_2,
+        lk::BinnedDataCPtr(posterior.data)));
+    ChainMoments thresholdMoments(generate(threshold,posterior,nAccepts,thresholdTrials));
+    checkMoments(thresholdMoments);
+    BOOST_CHECK_EQUAL(threshold.getEvalCount(), thresholdTrials);
+    BOOST_CHECK_CLOSE((double)thresholdTrials, (double)plainTrials, 5);
+    BOOST_CHECK_SMALL(thresholdMoments.mean(1) - plainMoments.mean(1), 0.2);
+    BOOST_CHECK_CLOSE(thresholdMoments.covariance(0,1), plainMoments.covariance(0,1), 10);
+    // Combined with an exact approximation, only screened trials are evaluated.
+    threshold.setApproximateFunction(lk::createGaussianApproximation(posterior.createMinimum()));
+    long evals(threshold.getEvalCount());
+    ChainMoments screenedMoments(generate(threshold,posterior,nAccepts,screenedTrials));
+    checkMoments(screenedMoments);
+    BOOST_CHECK(threshold.getEvalCount() - evals < screenedTrials);
+    BOOST_CHECK_CLOSE((double)screenedTrials, (double)plainTrials, 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // MarkovChainEngine
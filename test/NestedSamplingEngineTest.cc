@@ -0,0 +1,67 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// NestedSamplingEngine class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include <cmath>
+
+namespace {
+    // Returns -log(L) for an unnormalized Gaussian likelihood with sigma = 0.5 in each of
+    // the floating parameters p[0] and p[2].
+    double gaussianNLL(lk::Parameters const &p) {
+        return 2*(p[0]*p[0] + p[2]*p[2]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( NestedSamplingEngine )
+
+BOOST_AUTO_TEST_CASE( shouldEstimateAnalyticEvidence ) {
+    lk::FitParameters parameters;
+    parameters.push_back(lk::FitParameter("x",0.1,0.1));
+    parameters.push_back(lk::FitParameter("fixed",3,0));
+    parameters.push_back(lk::FitParameter("y",-0.1,0.1));
+    // A uniform prior on x with width 10 and a unit Gaussian prior on y.
+    parameters[0].setPrior(-5,5,1,lk::FitParameter::BoxPrior);
+    parameters[2].setPrior(-1,1,1,lk::FitParameter::GaussPrior);
+    // The evidence is the likelihood integral over x divided by the prior width times
+    // the overlap of the likelihood and prior for y.
+    double sigma(0.5), pi(4*std::atan(1.0));
+    double logZ(std::log(std::sqrt(2*pi)*sigma/10) + std::log(sigma/std::sqrt(1 + sigma*sigma)));
+    lk::RandomPtr random(new lk::Random());
+    random->setSeed(1234);
+    lk::FunctionPtr f(new lk::Function(gaussianNLL));
+    lk::NestedSamplingEngine engine(f,lk::GradientCalculatorPtr(),parameters,"live200",random);
+    BOOST_CHECK_EQUAL(engine.getNLive(), 200);
+    lk::FunctionMinimumPtr fmin(new lk::FunctionMinimum(gaussianNLL(lk::Parameters(3,0.1)),parameters));
+    engine.sample(fmin,1e-3,0);
+    double error(engine.getLogEvidenceError());
+    BOOST_CHECK(error > 0 && error < 0.5);
+    BOOST_CHECK_SMALL(engine.getLogEvidence() - logZ, error);
+    // The posterior has the product of the likelihood and prior for y.
+    lk::Parameters errors(fmin->getErrors(true));
+    BOOST_REQUIRE_EQUAL(errors.size(), 2);
+    BOOST_CHECK_CLOSE(errors[0], sigma, 15);
+    BOOST_CHECK_CLOSE(errors[1], sigma/std::sqrt(1 + sigma*sigma), 15);
+    BOOST_CHECK_EQUAL(fmin->getParameters()[1], 3);
+    BOOST_CHECK(engine.getPosterior()->getNSamples() > 200);
+    BOOST_CHECK(engine.getInformation() > 0);
+}
+
+BOOST_AUTO_TEST_CASE( shouldRequirePriors ) {
+    lk::FitParameters parameters;
+    parameters.push_back(lk::FitParameter("x",0,1));
+    lk::FunctionPtr f(new lk::Function(gaussianNLL));
+    BOOST_CHECK_THROW(lk::NestedSamplingEngine(f,lk::GradientCalculatorPtr(),parameters,"live200"),
+        lk::RuntimeError);
+    parameters[0].setPrior(-1,1,1,lk::FitParameter::BoxPrior);
+    BOOST_CHECK_THROW(lk::NestedSamplingEngine(f,lk::GradientCalculatorPtr(),parameters,"live2"),
+        lk::RuntimeError);
+    BOOST_CHECK_THROW(lk::NestedSamplingEngine(f,lk::GradientCalculatorPtr(),parameters,"walk20"),
+        lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // NestedSamplingEngine
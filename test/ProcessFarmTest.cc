@@ -0,0 +1,113 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// ProcessFarm class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include "boost/bind.hpp"
+
+#include <string>
+#include <vector>
+
+// Returns the sum of index values over a range.
+double sumIndices(int first, int last) {
+    double sum(0);
+    for(int index = first; index < last; ++index) sum += index;
+    return sum;
+}
+
+// Returns a function minimum whose value depends on the task index, calculated with the
+// default thread pool. Fails for task index 3.
+lk::FunctionMinimumPtr fitTask(int index) {
+    if(3 == index) throw lk::RuntimeError("task 3 failed.");
+    double sum(lk::getDefaultThreadPool()->parallelSum(0,1000,sumIndices));
+    lk::FitParameters params;
+    params.push_back(lk::FitParameter("x",index,0.5));
+    lk::FunctionMinimumPtr fmin(new lk::FunctionMinimum(sum + index,params));
+    fmin->setCounts(index,2*index);
+    return fmin;
+}
+
+BOOST_AUTO_TEST_SUITE( ProcessFarm )
+
+BOOST_AUTO_TEST_CASE( shouldSerializeFunctionMinimum ) {
+    lk::FitParameters params;
+    params.push_back(lk::FitParameter("a",1.5,0.1));
+    params.push_back(lk::FitParameter("b",-2,0.3));
+    params.push_back(lk::FitParameter("c",0.25));
+    params.push_back(lk::FitParameter("d",7,2));
+    params[1].setPrior(-3,1,0.5,lk::FitParameter::BoxPrior);
+    params[3].setPrior(5,9,1,lk::FitParameter::GaussPrior);
+    params[3].fix();
+    lk::CovarianceMatrixPtr cov(new lk::CovarianceMatrix(2));
+    cov->setCovariance(0,0,0.01);
+    cov->setCovariance(1,1,0.09);
+    cov->setCovariance(0,1,0.003);
+    lk::FunctionMinimumPtr fmin(new lk::FunctionMinimum(12.5,params,cov));
+    fmin->setCounts(123,45);
+    fmin->setStatus(lk::FunctionMinimum::WARNING,"close to a limit");
+    std::string buffer(lk::serializeFunctionMinimum(fmin));
+    lk::FunctionMinimumPtr copy(lk::deserializeFunctionMinimum(buffer));
+    BOOST_CHECK_EQUAL(copy->getMinValue(), 12.5);
+    BOOST_CHECK_EQUAL(copy->getNEvalCount(), 123);
+    BOOST_CHECK_EQUAL(copy->getNGradCount(), 45);
+    BOOST_CHECK_EQUAL(copy->getStatus(), lk::FunctionMinimum::WARNING);
+    BOOST_CHECK_EQUAL(copy->getStatusMessage(), "close to a limit");
+    lk::FitParameters copied(copy->getFitParameters());
+    BOOST_REQUIRE_EQUAL(copied.size(), params.size());
+    for(int k = 0; k < params.size(); ++k) {
+        BOOST_CHECK_EQUAL(copied[k].getName(), params[k].getName());
+        BOOST_CHECK_EQUAL(copied[k].getValue(), params[k].getValue());
+        BOOST_CHECK_EQUAL(copied[k].getError(), params[k].getError());
+        BOOST_CHECK_EQUAL(copied[k].isFloating(), params[k].isFloating());
+        BOOST_CHECK_EQUAL(copied[k].getPriorType(), params[k].getPriorType());
+        BOOST_CHECK_EQUAL(copied[k].getPriorMin(), params[k].getPriorMin());
+        BOOST_CHECK_EQUAL(copied[k].getPriorMax(), params[k].getPriorMax());
+        BOOST_CHECK_EQUAL(copied[k].getPriorScale(), params[k].getPriorScale());
+    }
+    // A temporarily fixed parameter should keep its error.
+    copied[3].release();
+    BOOST_CHECK_EQUAL(copied[3].getError(), 2);
+    BOOST_REQUIRE(copy->hasCovariance());
+    for(int row = 0; row < 2; ++row) {
+        for(int col = 0; col < 2; ++col) {
+            BOOST_CHECK_EQUAL(copy->getCovariance()->getCovariance(row,col), cov->getCovariance(row,col));
+        }
+    }
+    BOOST_CHECK(!lk::deserializeFunctionMinimum(lk::serializeFunctionMinimum(
+        lk::FunctionMinimumPtr(new lk::FunctionMinimum(1,params))))->hasCovariance());
+    BOOST_CHECK_THROW(lk::deserializeFunctionMinimum(buffer.substr(0,buffer.size()-1)),
+        lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( shouldRunTasksInWorkers ) {
+    BOOST_CHECK_THROW(lk::ProcessFarm(-1), lk::RuntimeError);
+    // Create the default pool before forking, so that workers inherit it.
+    double sum(lk::getDefaultThreadPool()->parallelSum(0,1000,sumIndices));
+    lk::ProcessFarm farm(3);
+    BOOST_CHECK_EQUAL(farm.getNWorkers(), 3);
+    int nTasks(8);
+    std::vector<lk::FunctionMinimumPtr> results(farm.run(fitTask,nTasks));
+    BOOST_REQUIRE_EQUAL(results.size(), nTasks);
+    for(int index = 0; index < nTasks; ++index) {
+        if(3 == index) {
+            BOOST_CHECK(!results[index]);
+            BOOST_CHECK_EQUAL(farm.getFailure(index), "task 3 failed.");
+            continue;
+        }
+        BOOST_REQUIRE(results[index]);
+        BOOST_CHECK_EQUAL(farm.getFailure(index), "");
+        BOOST_CHECK_EQUAL(results[index]->getMinValue(), sum + index);
+        BOOST_CHECK_EQUAL(results[index]->getParameters()[0], index);
+        BOOST_CHECK_EQUAL(results[index]->getNGradCount(), 2*index);
+    }
+    BOOST_CHECK_THROW(farm.getFailure(nTasks), lk::RuntimeError);
+    BOOST_CHECK_EQUAL(farm.run(fitTask,0).size(), 0);
+    // The default pool should still work in this process.
+    BOOST_CHECK_EQUAL(lk::getDefaultThreadPool()->parallelSum(0,1000,sumIndices), sum);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // ProcessFarm
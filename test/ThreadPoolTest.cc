@@ -0,0 +1,146 @@
+// Created 19-Oct-2026 by agent (University of California, Irvine) <agent@local>
+// ThreadPool class unit tests.
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "likely/likely.h"
+namespace lk = likely;
+
+#include "boost/bind.hpp"
+
+#include <vector>
+#include <cmath>
+
+#include <pthread.h>
+
+// Fills a range of a vector with the squares of its indices.
+void fillSquares(std::vector<int> &values, int first, int last) {
+    for(int index = first; index < last; ++index) values[index] = index*index;
+}
+
+// Throws a RuntimeError for any range that includes the specified index.
+void failAt(int bad, int first, int last) {
+    if(bad >= first && bad < last) throw lk::RuntimeError("bad index");
+}
+
+// Records the calling thread for each index in a range.
+void recordThread(std::vector<pthread_t> &threads, int first, int last) {
+    for(int index = first; index < last; ++index) threads[index] = pthread_self();
+}
+
+// Records the NUMA node running the calling thread for each index in a range.
+void recordNode(std::vector<int> &nodes, int first, int last) {
+    for(int index = first; index < last; ++index) nodes[index] = lk::getCurrentNumaNode();
+}
+
+// Returns the sum of terms with very different magnitudes over a range of indices.
+double sumTerms(int first, int last) {
+    double sum(0);
+    for(int index = first; index < last; ++index) sum += std::sin(index)*std::pow(10.,index % 17);
+    return sum;
+}
+
+// Runs parallelFor repeatedly on a shared pool from a separate thread, and counts the
+// batches that throw.
+struct SharedPoolCaller {
+    lk::ThreadPool *pool;
+    int bad, nFailed;
+    static void *run(void *arg) {
+        SharedPoolCaller *self(static_cast<SharedPoolCaller*>(arg));
+        for(int trial = 0; trial < 200; ++trial) {
+            try {
+                self->pool->parallelFor(0,100,boost::bind(failAt,self->bad,_1,_2),5);
+            }
+            catch(lk::RuntimeError const &e) {
+                self->nFailed++;
+            }
+        }
+        return 0;
+    }
+};
+
+BOOST_AUTO_TEST_SUITE( ThreadPool )
+
+BOOST_AUTO_TEST_CASE( shouldProcessEveryIndexInRange ) {
+    lk::ThreadPool pool(3);
+    BOOST_CHECK_EQUAL(pool.getNThreads(), 3);
+    std::vector<int> values(1000,-1);
+    pool.parallelFor(0,values.size(),boost::bind(fillSquares,boost::ref(values),_1,_2));
+    for(int index = 0; index < values.size(); ++index) BOOST_CHECK_EQUAL(values[index], index*index);
+}
+
+BOOST_AUTO_TEST_CASE( shouldReportTaskErrorsAfterWaiting ) {
+    lk::ThreadPool pool(2);
+    BOOST_CHECK_THROW(pool.parallelFor(0,100,boost::bind(failAt,42,_1,_2),10), lk::RuntimeError);
+    // The pool should still be usable after a failed task.
+    std::vector<int> values(10,-1);
+    pool.parallelFor(0,values.size(),boost::bind(fillSquares,boost::ref(values),_1,_2));
+    BOOST_CHECK_EQUAL(values[9], 81);
+}
+
+BOOST_AUTO_TEST_CASE( shouldTrackEachTaskGroupSeparately ) {
+    lk::ThreadPool pool(4);
+    std::vector<int> values(100,-1);
+    {
+        lk::ThreadPool::TaskGroup group(pool), failing(pool);
+        for(int first = 0; first < 100; first += 10) {
+            group.submit(boost::bind(fillSquares,boost::ref(values),first,first+10));
+            failing.submit(boost::bind(failAt,first,first,first+10));
+        }
+        group.wait();
+        BOOST_CHECK_THROW(failing.wait(), lk::RuntimeError);
+        // Errors are only reported once.
+        failing.wait();
+    }
+    for(int index = 0; index < values.size(); ++index) BOOST_CHECK_EQUAL(values[index], index*index);
+    // Concurrent callers of the same pool should only see their own errors.
+    SharedPoolCaller good = { &pool, -1, 0 }, bad = { &pool, 42, 0 };
+    pthread_t goodThread, badThread;
+    pthread_create(&goodThread,0,&SharedPoolCaller::run,&good);
+    pthread_create(&badThread,0,&SharedPoolCaller::run,&bad);
+    pthread_join(goodThread,0);
+    pthread_join(badThread,0);
+    BOOST_CHECK_EQUAL(good.nFailed, 0);
+    BOOST_CHECK_EQUAL(bad.nFailed, 200);
+}
+
+BOOST_AUTO_TEST_CASE( shouldSumIdenticallyForAnyThreadCount ) {
+    int n(100000);
+    lk::ThreadPool single(1);
+    BOOST_CHECK(single.isDeterministic());
+    double expected(single.parallelSum(0,n,sumTerms));
+    BOOST_CHECK_CLOSE(expected, sumTerms(0,n), 1e-6);
+    for(int nThreads = 2; nThreads <= 7; ++nThreads) {
+        lk::ThreadPool pool(nThreads);
+        // Compare bits, not just values.
+        BOOST_CHECK_EQUAL(pool.parallelSum(0,n,sumTerms), expected);
+        pool.setDeterministic(false);
+        BOOST_CHECK_CLOSE(pool.parallelSum(0,n,sumTerms), expected, 1e-6);
+    }
+    BOOST_CHECK_EQUAL(single.parallelSum(5,5,sumTerms), 0);
+    BOOST_CHECK_THROW(single.parallelSum(0,n,sumTerms,-1), lk::RuntimeError);
+}
+
+BOOST_AUTO_TEST_CASE( shouldRunPartitionsOnPinnedWorkers ) {
+    lk::ThreadPool pool(3,true);
+    BOOST_CHECK(pool.isPinned());
+    for(int worker = 0; worker < 3; ++worker) {
+        BOOST_CHECK_EQUAL(pool.getWorkerNode(worker), worker % lk::getNumaNodeCount());
+    }
+    BOOST_CHECK_EQUAL(lk::ThreadPool(1).getWorkerNode(0), -1);
+    // Each partition should be processed by the same worker every time.
+    std::vector<pthread_t> first(100), second(100);
+    pool.parallelForPartitioned(0,100,boost::bind(recordThread,boost::ref(first),_1,_2));
+    for(int trial = 0; trial < 10; ++trial) {
+        pool.parallelForPartitioned(0,100,boost::bind(recordThread,boost::ref(second),_1,_2));
+        for(int index = 0; index < 100; ++index) BOOST_CHECK(pthread_equal(first[index],second[index]));
+    }
+    BOOST_CHECK(!pthread_equal(first[0],first[99]));
+    // Each pinned worker should run on its own node.
+    std::vector<int> nodes(99);
+    pool.parallelForPartitioned(0,99,boost::bind(recordNode,boost::ref(nodes),_1,_2));
+    for(int index = 0; index < 99; ++index) BOOST_CHECK_EQUAL(nodes[index], pool.getWorkerNode(index/33));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // ThreadPool